@@ -0,0 +1,186 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// ChunkedArray<T>
+// -----------------------------------------------------------------------------
+// 作用：
+// - 只追加的分块数组，供搜索层各层在多个快照之间共享存储：
+//   元素按 kChunk 个一组存放在定长块中，块指针挂在两级目录（顶层定长数组 →
+//   目录页 → 块）上；目录与块一经分配永不移动，因此扩容不需要复制已有元素。
+// - 快照只需记录“发布时的长度”，读者只访问 [0, 发布长度) 内的元素。
+// 并发语义：
+// - 单写者（索引线程）：push_back 原地写入尾块中尚未发布的位置，
+//   读者不会访问这些位置，发布（快照指针的原子存储）之后才可见；
+// - 已发布元素的修改必须走 replace()/update()：复制整个块、在副本上修改、再以
+//   release 语义替换块指针；旧块交还调用方，待可能读到它的读者退出后释放；
+// - 读者通过 acquire 读取目录页与块指针，可与写者并发。
+// 容量：kTopSlots × kPageSlots × kChunk 个元素（默认 2^30）。
+// 对齐：每块按缓存行（kAlign）对齐，元素大小整除缓存行时，块内按
+//       缓存行键数对齐的下标区间恰好落在整条缓存行上（搜索层节点依赖此性质）。
+// -----------------------------------------------------------------------------
+template <class T>
+class ChunkedArray
+{
+public:
+    static constexpr std::size_t kChunkBits = 10;
+    static constexpr std::size_t kChunk = std::size_t(1) << kChunkBits; // 每块元素数
+    static constexpr std::size_t kPageBits = 10;
+    static constexpr std::size_t kPageSlots = std::size_t(1) << kPageBits; // 每页块数
+    static constexpr std::size_t kTopSlots = 1024;                          // 顶层目录页数
+    static constexpr std::size_t kAlign = 64;                               // 块对齐（缓存行）
+
+    static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+                  "ChunkedArray elements are copied and released as raw memory");
+
+    struct ChunkDeleter
+    {
+        void operator()(T *p) const noexcept { free_chunk_(p); }
+    };
+    using Chunk = std::unique_ptr<T[], ChunkDeleter>; // 被替换下来的旧块（所有权交给调用方）
+
+    ChunkedArray()
+    {
+        for (auto &p : top_)
+            p.store(nullptr, std::memory_order_relaxed);
+    }
+    ~ChunkedArray() { clear(); }
+
+    ChunkedArray(const ChunkedArray &) = delete;
+    ChunkedArray &operator=(const ChunkedArray &) = delete;
+
+    // ========================= 写者接口（单线程） =========================
+    std::size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    void push_back(const T &v)
+    {
+        const std::size_t i = size_;
+        if ((i & (kChunk - 1)) == 0)
+            install_chunk_(i);
+        chunk_of_(i)[i & (kChunk - 1)] = v;
+        ++size_;
+    }
+
+    const T &back() const { return (*this)[size_ - 1]; }
+
+    // 写时复制修改第 i 个元素，返回被替换下来的旧块。
+    Chunk replace(std::size_t i, const T &v)
+    {
+        assert(i < size_);
+        std::atomic<T *> &slot = slot_(i);
+        T *old = slot.load(std::memory_order_relaxed);
+        T *copy = alloc_chunk_();
+        const std::size_t base = i & ~(kChunk - 1);
+        const std::size_t n = std::min(kChunk, size_ - base);
+        std::copy(old, old + n, copy);
+        copy[i & (kChunk - 1)] = v;
+        slot.store(copy, std::memory_order_release);
+        return Chunk(old);
+    }
+
+    // 写时复制对 [lo, hi) 的每个元素调用 fn（区间须落在同一块内），返回旧块。
+    template <class Fn>
+    Chunk update(std::size_t lo, std::size_t hi, Fn fn)
+    {
+        assert(lo < hi && hi <= size_ && (lo >> kChunkBits) == ((hi - 1) >> kChunkBits));
+        std::atomic<T *> &slot = slot_(lo);
+        T *old = slot.load(std::memory_order_relaxed);
+        T *copy = alloc_chunk_();
+        const std::size_t base = lo & ~(kChunk - 1);
+        std::copy(old, old + std::min(kChunk, size_ - base), copy);
+        for (std::size_t i = lo; i < hi; ++i)
+            fn(copy[i & (kChunk - 1)]);
+        slot.store(copy, std::memory_order_release);
+        return Chunk(old);
+    }
+
+    // 清空并释放全部块与目录页（调用方保证此时没有读者）。
+    void clear()
+    {
+        for (auto &p : top_)
+        {
+            Page *page = p.load(std::memory_order_relaxed);
+            if (!page)
+                continue;
+            for (auto &c : page->chunks)
+                free_chunk_(c.load(std::memory_order_relaxed));
+            delete page;
+            p.store(nullptr, std::memory_order_relaxed);
+        }
+        size_ = 0;
+    }
+
+    // ========================= 读者接口（任意线程） =========================
+    // 调用方保证 i 小于其快照记录的长度。
+    const T &operator[](std::size_t i) const noexcept
+    {
+        return chunk_of_(i)[i & (kChunk - 1)];
+    }
+
+    // 若 [lo, hi) 落在同一块内，返回指向 lo 的连续指针，否则返回 nullptr。
+    const T *contiguous(std::size_t lo, std::size_t hi) const noexcept
+    {
+        if (lo >= hi || (lo >> kChunkBits) != ((hi - 1) >> kChunkBits))
+            return nullptr;
+        return chunk_of_(lo) + (lo & (kChunk - 1));
+    }
+
+private:
+    struct Page
+    {
+        std::atomic<T *> chunks[kPageSlots];
+        Page()
+        {
+            for (auto &c : chunks)
+                c.store(nullptr, std::memory_order_relaxed);
+        }
+    };
+
+    static T *alloc_chunk_()
+    {
+        return static_cast<T *>(::operator new(sizeof(T) * kChunk, std::align_val_t(kAlign)));
+    }
+    static void free_chunk_(T *p) noexcept
+    {
+        if (p)
+            ::operator delete(p, std::align_val_t(kAlign));
+    }
+
+    std::atomic<T *> &slot_(std::size_t i) const noexcept
+    {
+        const std::size_t c = i >> kChunkBits;
+        Page *page = top_[c >> kPageBits].load(std::memory_order_acquire);
+        return page->chunks[c & (kPageSlots - 1)];
+    }
+
+    T *chunk_of_(std::size_t i) const noexcept
+    {
+        return slot_(i).load(std::memory_order_acquire);
+    }
+
+    // 为下标 i（块首）分配新块，必要时分配目录页
+    void install_chunk_(std::size_t i)
+    {
+        const std::size_t c = i >> kChunkBits;
+        assert((c >> kPageBits) < kTopSlots && "ChunkedArray capacity exceeded");
+        std::atomic<Page *> &pslot = top_[c >> kPageBits];
+        Page *page = pslot.load(std::memory_order_relaxed);
+        if (!page)
+        {
+            page = new Page();
+            pslot.store(page, std::memory_order_release);
+        }
+        page->chunks[c & (kPageSlots - 1)].store(alloc_chunk_(), std::memory_order_release);
+    }
+
+    std::atomic<Page *> top_[kTopSlots]; // 顶层目录（定长，永不移动）
+    std::size_t size_ = 0;               // 写者视角的元素数
+};
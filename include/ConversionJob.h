@@ -0,0 +1,135 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "KVPair.h"
+
+class DataBlock; // 前向声明
+
+// -----------------------------------------------------------------------------
+// KVRun
+// -----------------------------------------------------------------------------
+// 作用：描述一段只读的 KV 连续区间（通常为某个 PTB 的已写入部分）。
+// -----------------------------------------------------------------------------
+struct KVRun
+{
+    const KVPair *data; // 首地址
+    std::size_t n;      // 条目数
+};
+
+// -----------------------------------------------------------------------------
+// ConversionJob
+// -----------------------------------------------------------------------------
+// 作用：
+// - 把一次段转换拆成若干互不相交的小任务，供多个线程协作完成：
+//   1) SORT_RUNS   ：每个 run 一个任务；有序 run 原地复用，无序 run 复制后
+//                    做 LSD 基数排序；
+//   2) BUILD_RANGES：按全局秩把输出切成若干不相交区间，每个任务用败者树
+//                    归并自己区间内的切片，直接流式写入 DataBlock。
+// - 全部任务完成后由发起者按区间顺序拼接（take_blocks）并发布。
+// 并发语义：
+// - 同一阶段内的任务彼此独立，可由任意线程以任意顺序执行；
+// - 阶段切换（begin_phase）只由发起者在上一阶段全部完成后调用。
+// 不变式：
+// - 区间 j 覆盖全局秩 [j*range_entries_, (j+1)*range_entries_)，
+//   range_entries_ 为 DataBlock 容量的整数倍，因此拼接结果与串行构建一致。
+// -----------------------------------------------------------------------------
+class ConversionJob
+{
+public:
+    enum class Phase : uint8_t
+    {
+        SORT_RUNS,
+        BUILD_RANGES,
+        DONE
+    };
+
+    explicit ConversionJob(std::vector<KVRun> runs);
+    ~ConversionJob(); // 释放未被取走的 DataBlock
+
+    ConversionJob(const ConversionJob &) = delete;
+    ConversionJob &operator=(const ConversionJob &) = delete;
+
+    // ========================= 阶段控制（仅发起者） =========================
+    // 进入阶段 p，返回该阶段的任务数。
+    std::size_t begin_phase(Phase p);
+    Phase phase() const noexcept { return phase_; }
+
+    // ========================= 任务执行（任意线程） =========================
+    void run_task(std::size_t idx);
+    // 在当前线程依次执行全部阶段（无协作者时使用，不涉及任何同步）。
+    void run_all();
+
+    // ========================= 结果 =========================
+    std::size_t total_entries() const noexcept { return total_; }
+    // 按 key 顺序拼接并链接所有区间产出的 DataBlock，所有权转交调用方。
+    std::vector<DataBlock *> take_blocks();
+
+private:
+    static constexpr std::size_t kBlocksPerRange = 16; // 每个区间任务产出的块数
+
+    void sort_run_(std::size_t i);
+    void build_range_(std::size_t j);
+    // 计算全局秩 rank 在各 run 中的切分位置（左侧元素均 <= 右侧元素）。
+    void split_at_rank_(std::size_t rank, std::vector<std::size_t> &pos) const;
+
+    std::vector<KVRun> runs_;
+    std::vector<std::vector<KVPair>> owned_; // 无序 run 的排序副本
+    std::size_t total_ = 0;
+    std::size_t range_entries_ = 0;
+    std::size_t num_ranges_ = 0;
+    std::vector<std::vector<DataBlock *>> out_; // 每个区间的产出
+    Phase phase_ = Phase::SORT_RUNS;
+};
+
+// -----------------------------------------------------------------------------
+// ConversionCoordinator
+// -----------------------------------------------------------------------------
+// 作用：
+// - 发布当前正在进行的 ConversionJob 阶段，让其他写线程在 insert 时顺手
+//   领取并执行任务（help），使转换耗时随核数下降。
+// 并发语义：
+// - 同一时刻只发布一个协作任务；其余并发转换由各自发起者串行完成；
+// - 领取通过对打包字 [gen:32 | next:16 | total:16] 的 CAS 完成，
+//   成功领取后 job_ 在该任务完成前保持有效（发起者会等待 done_ 计满）。
+// -----------------------------------------------------------------------------
+class ConversionCoordinator
+{
+public:
+    ConversionCoordinator() = default;
+    ConversionCoordinator(const ConversionCoordinator &) = delete;
+    ConversionCoordinator &operator=(const ConversionCoordinator &) = delete;
+
+    // 发起者：按阶段执行 job，直到 DONE（可能有其他线程协助）。
+    void run(ConversionJob &job);
+
+    // 协助者：若有已发布且未领取的任务，执行一个并返回 true。
+    bool help();
+
+    // 快速判断是否有待领取任务（单次原子读）。
+    bool has_work() const noexcept
+    {
+        const uint64_t w = claim_.load(std::memory_order_relaxed);
+        return next_of_(w) < total_of_(w);
+    }
+
+private:
+    static constexpr uint64_t pack_(uint32_t gen, uint32_t next, uint32_t total) noexcept
+    {
+        return (uint64_t(gen) << 32) | (uint64_t(next & 0xFFFF) << 16) | uint64_t(total & 0xFFFF);
+    }
+    static constexpr uint32_t next_of_(uint64_t w) noexcept { return uint32_t(w >> 16) & 0xFFFF; }
+    static constexpr uint32_t total_of_(uint64_t w) noexcept { return uint32_t(w) & 0xFFFF; }
+
+    static constexpr std::size_t kMaxTasks = 0xFFFF; // 单阶段可发布的最大任务数
+
+    // 尝试领取一个任务；成功返回 true 并写出任务下标。
+    bool claim_one_(uint32_t &idx);
+
+    std::atomic<uint64_t> claim_{0};  // 已发布阶段的领取状态
+    std::atomic<uint32_t> done_{0};   // 已完成任务数
+    std::atomic<bool> busy_{false};   // 是否已有协作任务在发布
+    ConversionJob *job_ = nullptr;    // 当前发布的任务（经 claim_ 的 release 可见）
+    uint32_t gen_ = 0;                // 阶段代数（仅发起者修改）
+};
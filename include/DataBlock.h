@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
 #include <cstddef>
 #include <vector>
@@ -16,7 +17,12 @@
 // 并发语义：
 //   - DataBlock 一旦构建完成即不可变（immutable）；
 //   - 并发写入通过 PerThreadBlock 和 SegmentedBlock 完成，
-//     以追加新 DataBlock 的方式表现，不会修改已有 DataBlock。
+//     以追加新 DataBlock 的方式表现，不会修改已有 DataBlock；
+//   - 迟到数据以写时复制方式并入：用新块替换链上旧块，旧块标记为 RETIRED，
+//     由 EpochManager 在仍可能访问它的读者退出后释放（status_ 为原子量，
+//     读者可据此判断手中的块是否仍在链上；replacement_ 指向接替它的块，
+//     从滞后的目录/搜索层拿到旧块的读者据此转到在链块）；
+//   - next_ 以 release/acquire 发布，读者沿链遍历时总能看到完整构建的后继。
 // 不变式：
 //   - keys_[0..count_-1] 严格非降序；
 //   - vals_ 与 keys_ 下标一一对应；
@@ -31,18 +37,34 @@ public:
     enum class Status : uint8_t
     {
         READY,
-        SPLITTING
+        SPLITTING,
+        RETIRED // 已被写时复制替换，不再位于数据链上
     };
 
     // --- 构造与构建 ---
     DataBlock(); // 默认构造：初始化元数据
     // 从“已排序”的 KV 数组构建本块；返回实际写入条数（<= kCapacity）。
     size_t build_from_sorted(const KVPair *src, size_t n);
+    // 增量构建：按 key 非降逐条写入 keys_/vals_（块满返回 false），
+    // 全部写完后调用 finish_build() 生成 min_key 与 N-ary 表。
+    bool push_sorted(Key k, Value v)
+    {
+        if (count_ >= kCapacity)
+            return false;
+        keys_[count_] = k;
+        vals_[count_] = v;
+        ++count_;
+        return true;
+    }
+    void finish_build();
 
     // --- 点查（Point Lookup） ---
     // 先用 N-ary 表定位桶，再在桶内线性扫描；命中返回 true 并写 out。
     bool find(Key k, Value &out) const;
 
+    // 返回第一个 key >= k 的下标（无则返回 size()）。
+    size_t lower_bound(Key k) const;
+
     // --- 扫描（Scan） ---
     // 从 startKey（含）起，最多取 count 个，结果追加到 out；返回实际条数。
     size_t scan_from(Key startKey, size_t count, std::vector<Value> &out) const;
@@ -51,9 +73,52 @@ public:
 
     // --- 访问器与链表链接 ---
     size_t size() const { return count_; }     // 当前条目数
+    bool full() const { return count_ >= kCapacity; } // 是否已写满
     Key min_key() const { return min_key_; }   // 本块最小 key
-    DataBlock *next() const { return next_; }  // 后继数据块
-    void set_next(DataBlock *p) { next_ = p; } // 设置后继数据块
+    // 块内值的最小/最大值（finish_build 时统计；空块为 max/0），过滤扫描据此整块跳过
+    Value value_min() const { return vmin_; }
+    Value value_max() const { return vmax_; }
+    DataBlock *next() const { return next_.load(std::memory_order_acquire); } // 后继数据块
+    void set_next(DataBlock *p) { next_.store(p, std::memory_order_release); } // 设置后继数据块
+    // 块状态：在数据层锁内修改；读者可无锁读取（例如判断缓存的块是否已被替换）
+    Status status() const { return status_.load(std::memory_order_acquire); }
+    void set_status(Status s) { status_.store(s, std::memory_order_release); }
+    // 接替本块的新链首块（未被替换时为空）：在标记 RETIRED 之前发布，读者看到
+    // RETIRED 时必能读到它
+    DataBlock *replacement() const { return replacement_.load(std::memory_order_acquire); }
+    void set_replacement(DataBlock *p) { replacement_.store(p, std::memory_order_release); }
+    static constexpr size_t capacity() { return kCapacity; } // 单块最大条目数
+
+    // 块内键/值数组（各 size() 个，按 key 非降；块不可变，可直接作为只读视图）
+    const Key *keys() const { return keys_; }
+    const Value *values() const { return vals_; }
+
+    // 软件预取：头部与键/值数组各自开头的若干缓存行。扫描时对前方的块提前发出，
+    // 掩盖跨块跳转的冷缺失（块间不相邻，硬件预取器无法预测）；数组其余部分
+    // 由硬件顺序预取接续（整块预取会占满填充缓冲，短区间反而变慢）
+    void prefetch() const noexcept
+    {
+        prefetch_header();
+        const char *k = reinterpret_cast<const char *>(keys_);
+        const char *v = reinterpret_cast<const char *>(vals_);
+        for (size_t off = 0; off < kPrefetchLines * kCacheLine; off += kCacheLine)
+        {
+            __builtin_prefetch(k + off, 0, 3);
+            __builtin_prefetch(v + off, 0, 3);
+        }
+    }
+
+    // 预取头部与 N-ary 表（点查的第一步）
+    void prefetch_header() const noexcept
+    {
+        const char *p = reinterpret_cast<const char *>(this);
+        __builtin_prefetch(p, 0, 3);
+        __builtin_prefetch(reinterpret_cast<const char *>(nary_ + kBuckets) - 1, 0, 3);
+    }
+    // 预取点查 k 将访问的桶内键与值（需读 N-ary 表，宜在 prefetch_header 之后稍晚调用）
+    void prefetch_find(Key k) const noexcept;
+    // 逆序扫描：预取键/值数组末尾的若干缓存行（需读条目数，宜在 prefetch_header 之后稍晚调用）
+    void prefetch_tail() const noexcept;
 
     // --- 测试辅助（可选） ---
     // 直接按索引读取键值（无边界检查；测试/校验用）。
@@ -62,13 +127,15 @@ public:
 private:
     // ========================= 常量与布局（仅内部） =========================
     static constexpr size_t kBlockSize = 4096; // 整块大小：4KB
+    static constexpr size_t kCacheLine = 64;   // 预取粒度
+    static constexpr size_t kPrefetchLines = 4; // prefetch() 在键/值数组上各预取的行数
     static constexpr size_t kBuckets = 8;      // N-ary 桶数（固定）
     using LockWord = uint32_t;                 // 轻量锁位（预留）
 
     // 头部开销（仅用于估算容量，不要求紧凑内存布局）
     static constexpr size_t kHeaderSize =
-        sizeof(Status) + sizeof(Key) + sizeof(void *) +
-        sizeof(LockWord) + sizeof(uint32_t);
+        sizeof(Status) + sizeof(Key) + 2 * sizeof(void *) +
+        sizeof(LockWord) + sizeof(uint32_t) + 2 * sizeof(Value);
 
     // N-ary 表占用字节数
     static constexpr size_t kNarySize = kBuckets * sizeof(Key);
@@ -89,11 +156,14 @@ private:
     std::pair<size_t, size_t> bucket_range_(Key k) const; // 计算 key 所在桶的 [l,r)
 
     // ========================= 元数据字段 =========================
-    Status status_ = Status::READY;                 // 块状态（预留）
+    std::atomic<Status> status_{Status::READY};     // 块状态
     Key min_key_ = std::numeric_limits<Key>::max(); // 块内最小 key
-    DataBlock *next_ = nullptr;                     // 指向后继 DataBlock
+    std::atomic<DataBlock *> next_{nullptr};        // 指向后继 DataBlock
+    std::atomic<DataBlock *> replacement_{nullptr}; // 写时复制替换后接替本块的块
     LockWord lock_ = 0;                             // 轻量锁（预留）
     uint32_t count_ = 0;                            // 实际填充条目数
+    Value vmin_ = std::numeric_limits<Value>::max(); // 块内值的最小值
+    Value vmax_ = 0;                                 // 块内值的最大值
 
     // ========================= 数据区 =========================
     Key nary_[kBuckets] = {};    // N-ary 搜索表（每桶的最小 key）
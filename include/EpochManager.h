@@ -0,0 +1,155 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// EpochManager
+// -----------------------------------------------------------------------------
+// 作用：
+// - 基于纪元（epoch）的内存回收：读者进入临界区时在线程私有槽位中登记
+//   当前全局纪元，写者把不再可达的对象连同当时的纪元放入回收列表；
+//   当全局纪元比对象的退役纪元前进两步后，再无读者可能持有它，即可释放。
+// - 取代 std::atomic_load(shared_ptr)：读者只需一次线程私有槽位写入，
+//   不再争用全局自旋锁池与共享引用计数。
+// 并发语义：
+// - 全进程一个域（instance()），各线程首次使用时领取一个按缓存行对齐的槽位，
+//   线程退出时归还，槽位对象本身永不释放（可被后续线程复用）；
+// - 读者：EpochGuard 构造时以 seq_cst 写入槽位，析构时清零；支持嵌套；
+// - 写者：retire() 加锁追加回收项，并尝试推进纪元、释放已过宽限期的对象；
+// - 跨调用持有指针的对象（游标等）用 EpochPin 独占一个槽位，可在线程间移交。
+// 注意：
+// - 受保护的指针须以 seq_cst 发布/读取（x86 上读取即普通 load），
+//   与槽位写入构成全序，保证读者要么已登记、要么读到新指针。
+// -----------------------------------------------------------------------------
+class EpochManager
+{
+public:
+    static EpochManager &instance();
+
+    // ========================= 读者（内联快路径） =========================
+    // 最外层进入：一次线程私有槽位写入；首次使用时才登记槽位。
+    static void enter()
+    {
+        if (tl_depth_++ > 0)
+            return;
+        if (!tl_slot_)
+            tl_slot_ = register_thread_();
+        tl_slot_->epoch.store(global_.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+    }
+    static void exit()
+    {
+        if (--tl_depth_ > 0)
+            return;
+        tl_slot_->epoch.store(0, std::memory_order_release);
+    }
+
+    // ========================= 写者 =========================
+    // 退役对象：在所有可能持有它的读者退出后调用 deleter(p)。
+    template <class T>
+    void retire(T *p)
+    {
+        retire_raw_(p, [](void *q)
+                    { delete static_cast<T *>(q); });
+    }
+
+    // 阻塞直到当前所有读者退出，并释放此前退役的全部对象（测试/析构用）。
+    // 调用线程自身不得处于 EpochGuard 内或持有 EpochPin，否则永不返回。
+    void synchronize();
+
+    static uint64_t epoch() noexcept { return global_.load(std::memory_order_acquire); }
+    size_t pending() const; // 尚未释放的回收项数（诊断用）
+
+    ~EpochManager();
+
+private:
+    friend class EpochPin;
+    EpochManager() = default;
+    EpochManager(const EpochManager &) = delete;
+    EpochManager &operator=(const EpochManager &) = delete;
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint64_t> epoch{0}; // 0 表示不在临界区
+        std::atomic<bool> in_use{false};
+        Slot *next = nullptr;
+    };
+    struct Retired
+    {
+        uint64_t epoch;
+        void *p;
+        void (*deleter)(void *);
+    };
+    struct SlotOwner; // 线程退出时归还槽位
+
+    static Slot *register_thread_(); // 为当前线程领取槽位（慢路径）
+    static Slot *pin_();             // 领取独占槽位并登记（见 EpochPin）
+    static Slot *acquire_slot_();
+    static void release_slot_(Slot *s);
+    void retire_raw_(void *p, void (*deleter)(void *));
+    bool try_advance_locked_();    // 所有活跃读者都已观察到当前纪元时推进一步
+    void reclaim_locked_(std::vector<Retired> &out); // 取出已过宽限期的回收项
+
+    // 全局纪元（从 1 开始，0 保留给“空闲”）与槽位链表（只增不删）：
+    // 静态常量初始化，读者快路径无需经过 instance()
+    static inline std::atomic<uint64_t> global_{1};
+    static inline std::atomic<Slot *> slots_{nullptr};
+    static inline thread_local Slot *tl_slot_ = nullptr; // 当前线程的槽位
+    static inline thread_local unsigned tl_depth_ = 0;   // 嵌套深度：仅最外层登记/清除
+
+    mutable std::mutex mu_;        // 保护回收列表
+    std::vector<Retired> retired_; // 回收列表（按纪元非降）
+};
+
+// -----------------------------------------------------------------------------
+// EpochGuard：读者临界区（RAII）
+// -----------------------------------------------------------------------------
+class EpochGuard
+{
+public:
+    EpochGuard() { EpochManager::enter(); }
+    ~EpochGuard() { EpochManager::exit(); }
+    EpochGuard(const EpochGuard &) = delete;
+    EpochGuard &operator=(const EpochGuard &) = delete;
+};
+
+// -----------------------------------------------------------------------------
+// EpochPin：跨调用持有的读者登记（RAII，可移动）
+// -----------------------------------------------------------------------------
+// 游标等对象在两次调用之间仍持有受保护的指针，且可能被移动到别处、由其他
+// 线程析构，不能借用线程私有槽位：每个 EpochPin 独占一个槽位。
+// 构造时若当前线程已在 EpochGuard 内，沿用该临界区的纪元（其中取得的指针
+// 因而在离开临界区后继续受保护），否则登记当前全局纪元。
+// 持有期间纪元至多再推进一步，全进程的回收随之推迟，不宜长期闲置。
+// -----------------------------------------------------------------------------
+class EpochPin
+{
+public:
+    EpochPin() : slot_(EpochManager::pin_()) {}
+    ~EpochPin() { reset(); }
+    EpochPin(EpochPin &&o) noexcept : slot_(o.slot_) { o.slot_ = nullptr; }
+    EpochPin &operator=(EpochPin &&o) noexcept
+    {
+        if (this != &o)
+        {
+            reset();
+            slot_ = o.slot_;
+            o.slot_ = nullptr;
+        }
+        return *this;
+    }
+    EpochPin(const EpochPin &) = delete;
+    EpochPin &operator=(const EpochPin &) = delete;
+
+    // 提前解除登记（之后不得再访问受保护的指针）
+    void reset() noexcept
+    {
+        if (slot_)
+            EpochManager::release_slot_(slot_);
+        slot_ = nullptr;
+    }
+
+private:
+    EpochManager::Slot *slot_;
+};
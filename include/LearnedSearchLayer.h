@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "KVPair.h"
+#include "ChunkedArray.h"
+#include "PrefixCounts.h"
+
+class DataBlock; // 前向声明
+
+// -----------------------------------------------------------------------------
+// LearnedSearchLayer
+// -----------------------------------------------------------------------------
+// 作用：
+// - SearchLayer 的替代实现（PGM 风格的学习型索引），面向 min_key 随时间
+//   近似线性增长的时间戳负载：
+//   - 叶层与 SearchLayer 相同（键数组 + DataBlock* 数组）；
+//   - 叶层之上不再建多层节点，而是一串误差有界的线性段：
+//     段 s 覆盖叶层 [pos_s, pos_{s+1})，预测 pos(k) = pos_s + slope_s*(k - key_s)，
+//     对段内每个叶子都有 |pos(min_key) - 下标| <= epsilon；
+//   - find_candidate = 定位所在段 + 一次模型计算 + 在叶层 ±(epsilon+2)
+//     窗口内 SIMD 计数，索引内存为 O(段数)。
+// - 段随 append_run 增量构建（收缩锥贪心）：维护当前开放段的可行斜率区间，
+//   新叶子使区间为空时封闭该段并以此叶子开启新段。
+// - 叶子条目计数与 SearchLayer 相同（PrefixCounts，扇出 64），支持按 key 求
+//   前缀计数与按名次定位叶子。
+// 并发语义：
+// - 与 SearchLayer 相同：单写者（索引线程）追加/替换，读者并发读取；
+//   叶层与已封闭段存放在只追加的 ChunkedArray 中，快照只记录长度与开放段
+//   参数（按值复制），发布时经 EpochManager 退役旧快照。
+// 注意：
+// - 段的定位对已封闭段做二分（段数远小于叶子数，近似规则的键通常只有
+//   少数几段）；模型预测出界或浮点误差时回退到段内二分，结果始终精确。
+// -----------------------------------------------------------------------------
+class LearnedSearchLayer
+{
+public:
+    using KeyArray = ChunkedArray<Key>;
+    using PtrArray = ChunkedArray<DataBlock *>;
+
+    // 一个线性段：覆盖叶层 [pos, 下一段 pos)
+    struct Segment
+    {
+        Key key;         // 段首叶子的 min_key
+        std::size_t pos; // 段首叶子下标
+        double slope;    // 每单位 key 的下标增量
+    };
+
+    struct Snapshot
+    {
+        std::size_t l0_size = 0; // 发布时叶层长度
+        std::size_t closed = 0;  // 已封闭段数
+        Segment open{0, 0, 0.0}; // 开放段（l0_size > 0 时有效）
+
+        // 本快照期间被写时复制替换下来的叶块/计数块（随快照一起退役，读者不访问）
+        std::vector<PtrArray::Chunk> garbage;
+        std::vector<PrefixCounts::CountArray::Chunk> count_garbage;
+    };
+
+    explicit LearnedSearchLayer(std::size_t epsilon = 32);
+    ~LearnedSearchLayer();
+
+    LearnedSearchLayer(const LearnedSearchLayer &) = delete;
+    LearnedSearchLayer &operator=(const LearnedSearchLayer &) = delete;
+
+    // ----------------------------- 写侧（索引线程） ---------------------------
+    // 接口语义与 SearchLayer 的同名函数一致
+    void append_run(const std::vector<DataBlock *> &blocks);
+    void append_run(const std::vector<DataBlock *> &blocks, const std::vector<std::uint64_t> &counts);
+    bool replace_leaf(DataBlock *old, DataBlock *repl, std::uint64_t added = 0,
+                      std::size_t *pos = nullptr);
+    void add_count(std::size_t leaf, std::uint64_t added);
+    void publish();
+
+    // ----------------------------- 查询接口 ---------------------------------
+    // 返回“最后一个 min_key <= k”的 DataBlock*，否则 nullptr
+    DataBlock *find_candidate(Key k) const noexcept;
+    DataBlock *find_candidate_near(Key k, std::size_t *leaf) const noexcept;
+    void find_candidates(const Key *keys, std::size_t n, DataBlock **out) const noexcept;
+    DataBlock *find_candidate(Key k, std::uint64_t *before) const noexcept;
+    DataBlock *select_leaf(std::uint64_t r, std::uint64_t *offset) const noexcept;
+    void split_keys(Key l, Key r, std::size_t parts, std::size_t min_leaves,
+                    std::vector<Key> &out) const;
+    std::size_t copy_leaves(std::size_t from, Key hi, DataBlock **out, std::size_t n) const noexcept;
+
+    // ----------------------------- 工具/状态 --------------------------------
+    bool empty() const noexcept { return keys_.empty(); }
+    std::size_t leaf_size() const noexcept { return keys_.size(); }
+    std::size_t epsilon() const noexcept { return eps_; }
+    std::size_t segments() const noexcept { return keys_.empty() ? 0 : seg_keys_.size() + 1; }
+    std::size_t levels_snapshot() const noexcept; // 0（空）或 2（叶层 + 段）
+
+private:
+    void add_leaf_(Key k);      // 把第 keys_.size()-1 个叶子加入开放段（必要时封闭）
+    double open_slope_() const; // 当前可行区间内选取的斜率
+    void publish_snapshot_();
+    bool replace_at_(std::size_t i, DataBlock *repl, std::uint64_t added, std::size_t *pos);
+
+    // 快照内“最后一个 <= k”的叶层下标（无则 npos）
+    std::size_t floor_index_(const Snapshot &snap, Key k) const noexcept;
+
+    // floor_index_ 的两步：先由段模型得到候选窗口（k 小于全部叶子时返回 false），
+    // 再在窗口内求解；批量查询在两步之间预取窗口
+    struct Window
+    {
+        std::size_t lo, hi;       // 预测窗口 [lo, hi)
+        std::size_t seg_pos, end; // 所在段的叶层范围（窗口失效时在其中二分）
+    };
+    bool predict_(const Snapshot &snap, Key k, Window *w) const noexcept;
+    std::size_t resolve_(const Window &w, Key k) const noexcept;
+
+    // 在叶层 [lo, hi) 内求“最后一个 <= k”的下标（调用方保证 keys[lo] <= k）
+    std::size_t floor_in_(std::size_t lo, std::size_t hi, Key k) const noexcept;
+
+    const std::size_t eps_;
+
+    KeyArray keys_;              // 叶层键
+    PtrArray leaves_;            // 叶层 DataBlock*
+    KeyArray seg_keys_;          // 已封闭段的首键（供二分定位）
+    ChunkedArray<Segment> segs_; // 已封闭段
+    PrefixCounts counts_;        // 叶子条目计数
+
+    // 开放段（仅写线程访问）：首点与可行斜率区间 [slope_lo_, slope_hi_]
+    Key open_key_ = 0;
+    std::size_t open_pos_ = 0;
+    double slope_lo_ = 0.0, slope_hi_ = 0.0;
+    bool slope_bounded_ = false; // 是否已有 key 不同于首点的叶子（否则上界为 +∞）
+
+    std::vector<PtrArray::Chunk> pending_garbage_; // 自上次发布以来被替换下来的叶块
+    std::vector<PrefixCounts::CountArray::Chunk> pending_count_garbage_; // 同上（计数块）
+    std::atomic<Snapshot *> snapshot_{nullptr};   // 快照指针（读者在纪元临界区内读取）
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <utility>
+
+// -----------------------------------------------------------------------------
+// MpscQueue<T>
+// -----------------------------------------------------------------------------
+// 作用：
+// - 无锁多生产者/单消费者 FIFO 队列（Vyukov 链式队列，带哑节点）：
+//   push 为一次原子交换 + 一次 release 存储，不加锁、不唤醒；
+//   try_pop 只由唯一的消费者线程调用。
+// 并发语义：
+// - 生产者之间按 tail_ 交换的顺序排队（即 FIFO 顺序）；
+// - 生产者交换 tail_ 后、链接 next 之前，消费者可能暂时看不到该元素：
+//   try_pop 发现 tail_ 已前移时短暂自旋等待链接完成，不会误报为空；
+// - empty() 只应由消费者调用；tail_ 的交换与读取均为 seq_cst，
+//   便于调用方与“消费者休眠”标志组成 Dekker 式握手（见 SBTreeBase）。
+// -----------------------------------------------------------------------------
+template <class T>
+class MpscQueue
+{
+public:
+    MpscQueue()
+        : head_(new Node()), tail_(head_)
+    {
+    }
+    ~MpscQueue()
+    {
+        T tmp;
+        while (try_pop(tmp))
+        {
+        }
+        delete head_;
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    // ========================= 生产者（任意线程） =========================
+    void push(T v)
+    {
+        Node *n = new Node(std::move(v));
+        Node *prev = tail_.exchange(n, std::memory_order_seq_cst);
+        prev->next.store(n, std::memory_order_release);
+    }
+
+    // ========================= 消费者（单线程） =========================
+    bool try_pop(T &out)
+    {
+        Node *next = head_->next.load(std::memory_order_acquire);
+        if (!next)
+        {
+            if (tail_.load(std::memory_order_seq_cst) == head_)
+                return false;
+            // 生产者已入队但尚未链接：等待其完成
+            while (!(next = head_->next.load(std::memory_order_acquire)))
+                std::this_thread::yield();
+        }
+        out = std::move(next->value);
+        delete head_;
+        head_ = next; // next 成为新的哑节点
+        return true;
+    }
+
+    bool empty() const noexcept { return tail_.load(std::memory_order_seq_cst) == head_; }
+
+private:
+    struct Node
+    {
+        Node() = default;
+        explicit Node(T v) : value(std::move(v)) {}
+        std::atomic<Node *> next{nullptr};
+        T value{};
+    };
+
+    Node *head_;                           // 消费者私有：当前哑节点
+    alignas(64) std::atomic<Node *> tail_; // 最近入队的节点（与消费者侧分处不同缓存行）
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "KVPair.h"
+
+// -----------------------------------------------------------------------------
+// OverflowStore
+// -----------------------------------------------------------------------------
+// 作用：
+// - 保存“过于迟到”的点：其 key 落后于数据层水位超过乱序窗口，
+//   不再以写时复制方式并入 DataBlock，而是单独存放，由查询额外合并。
+// - 读侧提供按 key 有序的 SoA 只读快照（Run），供点查与区间游标归并。
+// 并发语义：
+// - 写入与快照重建由内部互斥保护；快照一旦生成即不可变，可被多个读者共享；
+// - empty() 为单次原子读，供查询快速跳过（常态下溢出区为空）。
+// 注意：
+// - 迟到点预期很少，写入为 O(log m)，快照在首次读取时按需重建（O(m)）。
+// -----------------------------------------------------------------------------
+class OverflowStore
+{
+public:
+    // 有序只读快照：keys[i] 非降，vals[i] 与之对齐
+    struct Run
+    {
+        std::vector<Key> keys;
+        std::vector<Value> vals;
+
+        std::size_t size() const noexcept { return keys.size(); }
+        std::size_t lower_bound(Key k) const noexcept; // 第一个 >= k 的下标
+        std::size_t upper_bound(Key k) const noexcept; // 第一个 > k 的下标
+    };
+
+    void insert(Key k, Value v);
+    bool lookup(Key k, Value *out) const;
+
+    bool empty() const noexcept { return size_.load(std::memory_order_acquire) == 0; }
+    std::size_t size() const noexcept { return size_.load(std::memory_order_acquire); }
+
+    // 返回当前内容的有序快照（内容有变化时重建）。
+    std::shared_ptr<const Run> snapshot() const;
+
+private:
+    mutable std::mutex mu_;
+    std::multimap<Key, Value> map_;           // 写侧：有序多重映射
+    mutable std::shared_ptr<const Run> snap_; // 读侧：缓存的只读快照
+    mutable bool dirty_ = false;              // 自上次快照后是否有写入
+    std::atomic<std::size_t> size_{0};        // 条目数（快速判空）
+};
@@ -1,6 +1,8 @@
 #pragma once
+#include <atomic>
 #include <cstdint>
 #include <cstddef>
+#include <vector>
 #include "KVPair.h"
 
 // -----------------------------------------------------------------------------
@@ -13,9 +15,12 @@
 // 并发语义：
 // - 按“每线程独占”使用，不做内部并发控制；不同线程各持有各自实例。
 // - 段转换时，由上层协调停止追加并只读访问本块数据。
+// - 新鲜读：num_entries_ 以 release 发布，读者 acquire 读到 n 后，前 n 条即可
+//   与写入并发地只读访问（写线程只写 [n, kCapacity)）。
 // 不变式（约定）：
 // - num_entries_ ∈ [0, kCapacity]；
-// - 当工作负载单调递增写入时，data_[i].key 非降序（便于后续合并/切片）。
+// - 当工作负载单调递增写入时，data_[i].key 非降序（便于后续合并/切片）；
+//   出现逆序写入时置位 num_entries_ 的最高位，读者据此放弃二分改为顺序查找。
 // - max_key_ 记录到目前为止写入的最大 key（可用于范围估计/断言）。
 // 注意：
 // - 不负责内存回收/复用，由上层管理生命周期。
@@ -31,6 +36,8 @@ public:
     bool Insert(Key key, Value value);
     // 是否已满（num_entries_ == kCapacity）。
     bool IsFull() const;
+    // 单块最大条目数。
+    static constexpr size_t Capacity() { return kCapacity; }
 
     // ========================= 转换阶段只读视图 =========================
     // 当前已写入的条目数（用于收集/合并）。
@@ -38,6 +45,12 @@ public:
     // 只读数据指针（首地址）。注意：仅在外部确保“写入已停止”前提下使用。
     const KVPair *GetData() const;
 
+    // ========================= 新鲜读（与写入并发） =========================
+    // 把 key ∈ [l, r] 的已发布条目追加到 out（有序时二分定位两端，否则顺序过滤）。
+    void CopyRange(Key l, Key r, std::vector<KVPair> &out) const;
+    // 查找 key，命中时写 *value。
+    bool Find(Key key, Value *value) const;
+
 private:
     // ========================= 常量与容量计算 =========================
     static constexpr size_t kBlockSize = 16384; // 固定块大小（字节）
@@ -47,10 +60,15 @@ private:
     // 可存放的 KV 条目数（整除截断）
     static constexpr size_t kCapacity = (kBlockSize - kMetadataSize) / sizeof(KVPair);
 
+    static constexpr size_t kUnsorted = size_t(1) << (sizeof(size_t) * 8 - 1); // num_entries_ 最高位
+
+    // 读者视角的已发布前缀：条目数与是否有序（acquire 读，与 Insert 的 release 配对）
+    size_t published_(bool *sorted) const;
+
     // ========================= 元数据 =========================
-    size_t num_entries_ = 0; // 已写入的条目数
-    Key max_key_ = Key{};    // 到目前为止的最大 key（用于断言/范围估计）
+    std::atomic<size_t> num_entries_{0}; // 已写入的条目数（最高位：出现过逆序写入）
+    Key max_key_ = Key{};                // 到目前为止的最大 key（用于断言/范围估计）
 
     // ========================= 实际数据区 =========================
     KVPair data_[kCapacity]; // 顺序追加的 KV 存储
-};
\ No newline at end of file
+};
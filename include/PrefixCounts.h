@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "ChunkedArray.h"
+
+// -----------------------------------------------------------------------------
+// PrefixCounts
+// -----------------------------------------------------------------------------
+// 作用：
+// - 为搜索层叶子维护条目计数，支持 O(层数) 的前缀和（rank）与
+//   O(层数 × 节点) 的按名次定位（select）。
+// - 分层方式与 SearchLayer 的键层完全一致：第 lv 层第 j 项汇总
+//   第 lv-1 层 [j*F, (j+1)*F) 这一组（凑满 F 个才晋升），因此第 lv 层
+//   长度恒为 n / F^lv（n 为叶子数），读者只凭快照中的叶子数即可推出各层长度。
+// - 每项存的是“组内累计值”（从所在组首项累加到本项），于是：
+//   - prefix(i)：把 i 按 F 进制分解，每层至多读一项；
+//   - select(r)：逐层在一组（F 个非降累计值）内计数 <= r 的项，沿用 Simd.h
+//     的节点比较内核。
+// 并发语义：
+// - 单写者（索引线程）：push_back 只写尚未发布的位置；add 走 ChunkedArray::update
+//   写时复制，旧块交给调用方随快照退役；
+// - 读者传入其快照中的叶子数 n，只访问各层 [0, n / F^lv) 内的元素。
+// 注意：
+// - 并发的 add 可能让读者在不同层分别读到新旧值（结果偏差至多为该次增量），
+//   与叶子指针的写时复制替换同样属于“索引滞后”范畴。
+// -----------------------------------------------------------------------------
+class PrefixCounts
+{
+public:
+    using CountArray = ChunkedArray<std::uint64_t>;
+    static constexpr std::size_t kMaxLevels = 64;
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // fanout 须为 2 的幂且不超过块长（一组不跨块）
+    explicit PrefixCounts(std::size_t fanout = 64);
+
+    PrefixCounts(const PrefixCounts &) = delete;
+    PrefixCounts &operator=(const PrefixCounts &) = delete;
+
+    // ----------------------------- 写侧（单线程） ---------------------------
+    void push_back(std::uint64_t count); // 追加一个叶子的计数
+    // 第 i 个叶子的计数增加 delta；被替换下来的旧块追加到 garbage
+    void add(std::size_t i, std::uint64_t delta, std::vector<CountArray::Chunk> &garbage);
+    void clear(); // 调用方保证此时没有读者
+    std::size_t size() const noexcept { return levels_[0]->size(); }
+
+    // ----------------------------- 读侧（n 为快照叶子数） --------------------
+    // 叶子 [0, i) 的计数之和（调用方保证 i 不超过其快照叶子数）
+    std::uint64_t prefix(std::size_t i) const noexcept;
+    // 名次 r（0 起）所在的叶子，*rem 为其在该叶子内的偏移；
+    // r 不小于总数时返回最后一个叶子（*rem 不小于其计数），n == 0 时返回 npos
+    std::size_t select(std::size_t n, std::uint64_t r, std::uint64_t *rem) const noexcept;
+
+private:
+    std::size_t fanout_;
+    std::size_t shift_; // log2(fanout_)
+    std::array<std::unique_ptr<CountArray>, kMaxLevels> levels_; // 按需创建，地址稳定
+};
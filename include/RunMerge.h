@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "KVPair.h"
+#include "ConversionJob.h" // KVRun
+
+// -----------------------------------------------------------------------------
+// LoserTree
+// -----------------------------------------------------------------------------
+// 作用：
+// - k 路有序 run 的败者树归并，每次 pop 只需沿叶到根比较 log2(k) 次；
+// - 供段转换直接把归并结果流式写入 DataBlock，省去中间 vector 与全量排序。
+// 不变式：
+// - 各输入 run 按 key 非降；
+// - tree_[0] 为当前胜者（最小 key，key 相同时 run 下标小者优先），
+//   tree_[1..P-1] 为各内部节点记录的败者；已耗尽的 run 视为 +∞。
+// 注意：
+// - 只持有输入区间的指针，不复制数据；输入须在归并期间保持有效。
+// -----------------------------------------------------------------------------
+class LoserTree
+{
+public:
+    explicit LoserTree(const std::vector<KVRun> &runs);
+
+    bool empty() const noexcept { return cur_[tree_[0]] == end_[tree_[0]]; }
+    const KVPair &top() const noexcept { return *cur_[tree_[0]]; }
+    void pop(); // 弹出当前最小元素并重赛
+
+private:
+    // a 是否胜过 b（更小的 key；相同 key 时 run 下标小者胜）
+    bool beats_(uint32_t a, uint32_t b) const noexcept
+    {
+        if (cur_[a] == end_[a])
+            return false;
+        if (cur_[b] == end_[b])
+            return true;
+        const Key ka = cur_[a]->key, kb = cur_[b]->key;
+        return ka < kb || (ka == kb && a < b);
+    }
+
+    std::size_t leaves_ = 1;              // 叶子数（补齐到 2 的幂）
+    std::vector<const KVPair *> cur_;     // 各 run 当前位置
+    std::vector<const KVPair *> end_;     // 各 run 末尾
+    std::vector<uint32_t> tree_;          // [0]=胜者，[1..leaves_-1]=败者
+};
+
+// -----------------------------------------------------------------------------
+// radix_sort_by_key
+// -----------------------------------------------------------------------------
+// LSD 基数排序（8 位一趟，稳定）：把 src[0..n) 按 key 排好写入 dst。
+// - tmp 为同样大小的临时缓冲；一次遍历统计 8 个字节的直方图，
+//   所有元素在某字节上相同的趟次直接跳过；
+// - 用于段转换中被检测为无序的 PTB（单调负载下极少出现）。
+// -----------------------------------------------------------------------------
+void radix_sort_by_key(const KVPair *src, std::size_t n, KVPair *dst, KVPair *tmp);
@@ -1,101 +1,95 @@
 #pragma once
 #include <atomic>
 #include <mutex>
-#include <shared_mutex>
-#include <condition_variable>
-#include <thread>
-#include <deque>
+#include <vector>
 #include "KVPair.h"
+#include "SBTreeBase.h"
 #include "SegmentedBlock.h"
-#include "DataBlock.h"
-#include "PerThreadDataBlock.h"
-#include "SearchLayer.h"
+#include "ConversionJob.h"
 
 // -----------------------------------------------------------------------------
-// SBTree
+// 写入并发策略（编译期选择）
+// -----------------------------------------------------------------------------
+// - MultiWriter ：任意多个线程并发 insert（分段块 + 每线程 PTB + 协作转换）；
+// - SingleWriter：同一时刻只有一个线程 insert（单缓冲，写路径无原子读改写），
+//                 见 SingleWriterSBTree.h。
+// 两种策略的查询接口与数据层/搜索层完全一致（继承自 SBTreeBase）。
+// -----------------------------------------------------------------------------
+struct MultiWriter
+{
+};
+struct SingleWriter
+{
+};
+
+template <class WriterPolicy>
+class BasicSBTree;
+
+// -----------------------------------------------------------------------------
+// BasicSBTree<MultiWriter>（即 SBTree）
 // -----------------------------------------------------------------------------
 // 作用：
-//   - SB-Tree 主体类，管理搜索层与数据层的整体逻辑。
-//   - 提供插入、查找、扫描等外部接口。
-//   - 内部使用后台索引线程维护搜索层（SearchLayer），保证并发环境下的正确性。
+//   - SB-Tree 主体类的多写线程版本：热写入落在活跃分段块的每线程 PTB 中，
+//     封印后转换为 DataBlock run 发布到数据层，由后台索引线程追加到搜索层。
 // 并发语义：
 //   - 数据层（SegmentedBlock + PTB）支持多线程并发插入；
-//   - 搜索层由单独后台线程批量更新，读线程可并发访问；
-//   - 数据层链表需互斥保护，搜索层通过 shared_mutex 读写锁保护。
+//   - 段转换被拆成 ConversionJob 任务，其他写线程在 insert 时协助执行；
+//   - 已转换的段回收到复用池而非释放，持有旧指针的写线程不会访问已释放内存。
+// 封印策略：
+//   - 条目/字节阈值在写入路径上由段自身检测（复用 should_seal 标志）；
+//   - 时间阈值由索引线程周期性检查，超时即替换并转换活跃段，
+//     从而为低写入速率下的查询可见性提供上界。
+// 新鲜读（SBTreeOptions::fresh_reads）：
+//   - 查询另读取活跃与转换中分段块内各 PTB 已发布的前缀（单调负载下 PTB 有序，二分定位）；
+//   - 段先发布到数据层、标记为已转换，之后才回收，条目在转移期间始终可读；
+//     挂链到标记之间由发布序号包围，读者发现快照期间有发布即重试，不会重复或遗漏。
 // -----------------------------------------------------------------------------
-class SBTree
+template <>
+class BasicSBTree<MultiWriter> : public SBTreeBase
 {
 public:
     // ========================= 构造/析构 =========================
-    SBTree();
-    ~SBTree(); // 负责释放 DataBlock 链表
+    explicit BasicSBTree(const SBTreeOptions &opts = SBTreeOptions{});
+    ~BasicSBTree() override;
 
     // ========================= 基本操作接口 =========================
-    void insert(Key key, Value value);                        // 顺序插入（假设 key 单调递增）
-    bool lookup(Key k, Value *out) const;                     // 查找
-    size_t scan(Key l, Key r, std::vector<Value> &out) const; // 范围扫描
-
-    // ========================= 测试/诊断接口 =========================
-    bool verify_data_layer(size_t expected_total_keys) const; // 遍历数据层验证正确性
-    void flush();                                             // 刷新段 → 数据块（立即转换）
-
-    // ========================= 区间游标 =========================
-    class RangeCursor
-    {
-    public:
-        bool next(KVPair *out);                                    // 取下一个元素
-        size_t next_batch(std::vector<KVPair> &out, size_t limit); // 批量取元素
-        inline bool valid() const noexcept { return blk_ != nullptr; }
-
-    private:
-        friend class SBTree;
-        RangeCursor(const SBTree *owner, Key l, Key r, DataBlock *start);
-        void seek_first_pos_(); // 在当前块内定位到第一个 >= l 的元素
+    void insert(Key key, Value value); // 插入（单调 key 走快路径，迟到 key 按乱序窗口处理）
+    void flush();                      // 刷新段 → 数据块（立即转换）
 
-        const SBTree *owner_; // 指向宿主树
-        Key l_, r_;
-        DataBlock *blk_;  // 当前数据块
-        std::size_t idx_; // 当前块内索引
-    };
-    RangeCursor open_range_cursor(Key l, Key r) const; // 打开区间游标
-
-    // ========================= 索引控制接口 =========================
-    void flush_index();                               // 阻塞，等待索引同步完成
-    uint64_t index_batches_enqueued() const noexcept; // 诊断统计：入队批次数
-    uint64_t index_batches_applied() const noexcept;  // 诊断统计：应用批次数
-    uint64_t index_items_enqueued() const noexcept;   // 诊断统计：入队数据块数
-    uint64_t index_items_applied() const noexcept;    // 诊断统计：已应用数据块数
-    std::size_t index_levels() const;                 // 搜索层层数（加锁读取）
+protected:
+    void on_index_tick_() override; // 时间阈值：检查活跃段的首写时长
+    bool lookup_fresh_(Key k, Value *out) const override;
+    std::shared_ptr<const OverflowStore::Run> fresh_overlay_(Key l, Key r, Key *data_end,
+                                                             std::vector<Key> *skip) const override;
 
 private:
     // ========================= 内部辅助 =========================
-    void convert_and_append(SegmentedBlock *seg_to_convert);     // 段转换 + 追加数据块
-    void index_worker_();                                        // 后台索引线程主循环
-    void enqueue_index_task_(std::vector<DataBlock *> &&blocks); // 入队索引任务
-    DataBlock *find_candidate_(Key k) const;                     // 在搜索层中查找候选块
-
-    // ========================= 并发控制 =========================
-    mutable std::shared_mutex search_mu_;          // 搜索层读写锁
-    std::thread index_thread_;                     // 专用索引维护线程
-    std::deque<std::vector<DataBlock *>> index_q_; // 索引任务队列
-    std::mutex q_mu_;                              // 队列锁
-    std::condition_variable q_cv_;                 // 队列条件变量
-    std::atomic<bool> index_stop_{false};          // 线程停止标志
-    std::atomic<size_t> index_in_flight_{0};       // 正在处理中的批次数
+    void convert_and_append(SegmentedBlock *seg_to_convert); // 段转换 + 追加数据块
+    SegmentedBlock *acquire_segment_();                      // 取一个已启用的段（优先复用）
+    SegmentedBlock *new_segment_();                          // 按封印策略新建段（并登记）
+    void release_segment_(SegmentedBlock *seg);              // 回收已转换的段到复用池
+    void discard_segment_(SegmentedBlock *seg);              // 处理未能发布的段
+    void seal_if_stale_();                                   // 活跃段超过最长等待时间则封印
+    uint64_t stable_pub_seq_() const;                        // 等到没有进行中的发布，返回发布序号
 
-    // ========================= 统计指标 =========================
-    std::atomic<uint64_t> idx_batches_enqueued_{0};
-    std::atomic<uint64_t> idx_batches_applied_{0};
-    std::atomic<uint64_t> idx_items_enqueued_{0};
-    std::atomic<uint64_t> idx_items_applied_{0};
-
-    // ========================= 数据层 =========================
-    Key max_key_{0};
+    // ========================= 写入前端 =========================
     std::atomic<SegmentedBlock *> shortcut_; // 当前活跃分段块
-    mutable std::mutex data_layer_lock_;     // 数据层链表锁
-    DataBlock *data_head_;                   // 数据链表头
-    DataBlock *data_tail_;                   // 数据链表尾
+    // 段复用池：段对象在树析构前不释放，仅回收复用。写线程从 shortcut_ 读到
+    // 指针后，该段可能已被转换回收；类型稳定的内存保证其只会看到状态/编号变化。
+    std::mutex seg_pool_mu_;
+    std::vector<SegmentedBlock *> seg_pool_;
+    ConversionCoordinator conv_; // 协作转换调度（写线程可协助）
+
+    // ========================= 新鲜读 =========================
+    // 全部段对象的登记表（只增不删）：新鲜读遍历它找出活跃与转换中的段
+    struct SegNode
+    {
+        SegmentedBlock *seg;
+        SegNode *next;
+    };
+    std::atomic<SegNode *> all_segs_{nullptr};
+    // 快照期间连续遇到发布的次数上限，超过后在数据层锁内读取（持续转换时读者仍能完成）
+    static constexpr int kFreshRetries = 4;
+};
 
-    // ========================= 搜索层 =========================
-    SearchLayer search_; // 搜索层实例
-};
\ No newline at end of file
+using SBTree = BasicSBTree<MultiWriter>;
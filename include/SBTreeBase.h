@@ -0,0 +1,520 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <limits>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include "KVPair.h"
+#include "DataBlock.h"
+#include "EpochManager.h"
+#include "PerThreadDataBlock.h"
+#include "SearchLayer.h"
+#include "LearnedSearchLayer.h"
+#include "OverflowStore.h"
+#include "TailDirectory.h"
+#include "MpscQueue.h"
+
+class SegmentedBlock;
+
+// 搜索层实现：B+ 树式多层节点（默认），或误差有界的分段线性模型
+enum class SearchLayerKind : uint8_t
+{
+    BTREE,
+    LEARNED
+};
+
+// -----------------------------------------------------------------------------
+// SBTreeOptions
+// -----------------------------------------------------------------------------
+// 作用：SB-Tree 的可调参数（构造时指定，之后不可变）。
+// -----------------------------------------------------------------------------
+struct SBTreeOptions
+{
+    // 乱序窗口：key 低于水位（数据层已转换的最大 key）但差距不超过该值的
+    // 迟到点进入侧缓冲，在下一次转换时以写时复制方式并入对应 DataBlock；
+    // 差距更大的点进入溢出区，由查询额外合并。默认不限（全部并入）。
+    Key disorder_window = std::numeric_limits<Key>::max();
+    // 侧缓冲上限：积累到该数目时由写入线程立即并入，不等下一次转换
+    //（水位远超当前写入时可能长时间没有转换）。0 表示不限。
+    // 另外启用 seal_max_age 时，侧缓冲中最早的点等待超过该时长也会由索引线程并入。
+    size_t late_max_entries = 65536;
+
+    // 封印策略：活跃段满足任一条件即封印并转换（0 表示不启用该条件）。
+    // 任一 PTB 写满总会触发封印，与这些阈值无关。
+    size_t seal_max_entries = 0;               // 段内条目总数上限
+    size_t seal_max_bytes = 0;                 // 段内 PTB 占用字节上限（按 PTB 粒度计）
+    std::chrono::milliseconds seal_max_age{0}; // 首条写入后的最长等待时间（由索引线程检查）
+
+    // 尾部目录：记录链尾最新的若干 DataBlock，key 落在其范围内的查询
+    // 直接定位，不经搜索层（0 表示禁用）。
+    size_t tail_directory_blocks = 64;
+
+    // 搜索层实现；LEARNED 适合 min_key 随时间近似线性增长的负载，
+    // learned_epsilon 为模型预测下标的最大误差（叶层窗口半径）。
+    SearchLayerKind search_layer = SearchLayerKind::BTREE;
+    size_t learned_epsilon = 32;
+
+    // 扫描预取深度：区间游标跨过首个块边界后，按搜索层叶层指针提前预取
+    // 其后若干个 DataBlock（0 表示禁用，仅依赖硬件预取）。
+    size_t scan_prefetch_blocks = 4;
+
+    // 新鲜读：lookup 与 open_range_cursor（及基于它的 scan 等）同时读取写入前端
+    // 尚未发布的条目（多写版本的活跃/转换中分段块），无需频繁 flush 即可读到
+    // 刚写入的数据。单写版本的缓冲为写线程私有，不受此选项影响；侧缓冲中的
+    // 迟到点、分页游标、逆序游标与 as-of 等其余查询仍只读已发布数据。
+    bool fresh_reads = false;
+};
+
+// -----------------------------------------------------------------------------
+// SBTreeBase
+// -----------------------------------------------------------------------------
+// 作用：
+//   - SB-Tree 中与写入并发策略无关的部分：数据层链表、搜索层与后台索引线程、
+//     迟到点处理以及全部查询接口（lookup/scan/RangeCursor）。
+//   - 写入前端（热缓冲、封印与转换）由 BasicSBTree<WriterPolicy> 提供，
+//     转换产出的 run 统一经 publish_run_ 发布给读者。
+// 并发语义：
+//   - 搜索层由单独后台线程批量更新，读线程可并发访问；
+//   - 索引任务经无锁 MPSC 队列交给后台线程，入队不加锁，仅在后台线程
+//     休眠时才唤醒；后台线程一次取走全部积压任务，连续的追加任务合并为
+//     一个 run、只发布一次快照；
+//   - 数据层链表需互斥保护，搜索层通过 shared_mutex 读写锁保护。
+// 乱序写入：
+//   - key >= 水位的写入走写入前端的追加快路径（仅多一次原子读）；
+//   - 低于水位的迟到点按 SBTreeOptions::disorder_window 分流到侧缓冲或溢出区；
+//   - 侧缓冲中的点在下一次转换（或 flush）后才对查询可见；侧缓冲达到
+//     late_max_entries 或等待超过 seal_max_age 时不等转换，自行并入；
+//   - 并入以写时复制替换数据块，旧块在搜索层改指后交给 EpochManager：
+//     单次查询在 EpochGuard 内执行，游标与 Finger 持有 EpochPin。
+// 最近数据：
+//   - 挂链时同步登记到尾部目录（TailDirectory），lookup/open_range_cursor
+//     对不小于目录首块 min_key 的 key 先查目录，尚未进入搜索层的块同样可达。
+//   - 开启 SBTreeOptions::fresh_reads 时，lookup/open_range_cursor 另经钩子读取
+//     写入前端尚未发布的条目（见 lookup_fresh_/fresh_overlay_）。
+// 生命周期：
+//   - 派生类在构造完成后调用 start_index_thread_()，在析构开始时先刷新
+//     自身缓冲再调用 stop_index_thread_()，保证后台线程只在派生对象完整时回调。
+// -----------------------------------------------------------------------------
+class SBTreeBase
+{
+public:
+    SBTreeBase(const SBTreeBase &) = delete;
+    SBTreeBase &operator=(const SBTreeBase &) = delete;
+
+    // ========================= 查询接口 =========================
+    // 一段连续的只读键/值（零拷贝）：来自某个 DataBlock 或溢出区快照，
+    // 已裁剪到查询区间内，在产出它的游标（或 scan_spans 的本次回调）存续
+    // 期间有效（数据块被迟到点替换后，游标持有的纪元登记使旧块延后释放）。
+    struct Span
+    {
+        const Key *keys;
+        const Value *values;
+        size_t n;
+    };
+
+    bool lookup(Key k, Value *out) const;                     // 查找（含新鲜读，见 SBTreeOptions::fresh_reads）
+    // 批量点查：found[i] 与 values[i] 同 lookup(keys[i], &values[i])（未命中时 values[i] 不变；
+    // found 可为空），返回命中数。搜索层分组交错下降（升序相邻、落在同块或近邻
+    // 块的 key 共享定位），块内查找按流水线提前预取，使多个缓存缺失同时在途。
+    // 适合连接等一次发出大量独立点查的场景；key 顺序任意。
+    size_t lookup_batch(const Key *keys, size_t n, Value *values, bool *found) const;
+    // as-of 查询：key <= k 的最大条目（含其实际 key）写入 *out，不存在时返回 false。
+    // 数据层与溢出区同 key 时取数据层（与 lookup 一致），同层多条时取其中最后一条
+    bool lookup_floor(Key k, KVPair *out) const;
+    // 按固定步长批量 as-of：out[i] 同 lookup_floor(start + i * step)（未命中时不变；
+    // found 可为空；超出 Key 范围的采样点按最大值计），返回命中数。一次前向遍历：
+    // 沿当前块至多前进 Finger::kMaxHops 块，块内与溢出区自上次位置起指数搜索，
+    // 跨得更远时才经尾部目录或叶层提示（指数搜索）重新定位，不逐点完整下降。
+    size_t sample_asof(Key start, Key step, size_t count, KVPair *out, bool *found) const;
+    size_t scan(Key l, Key r, std::vector<Value> &out) const; // 范围扫描
+    // 逐段扫描：按 key 顺序对 [l, r] 内每段连续元素调用 fn（零拷贝），返回条目总数
+    size_t scan_spans(Key l, Key r, const std::function<void(const Span &)> &fn) const;
+    // 值过滤扫描：[l, r] 内值在 [lo, hi] 内的条目按 key 顺序追加到 keys/values，返回命中数
+    // （“超过阈值 x”即 [x + 1, 最大值]）。块内值的最小/最大值与 [lo, hi] 不相交的块
+    // 整块跳过、不读其值数组；其余按段用 SIMD 比较并紧凑写出（见 Simd.h），只复制命中项。
+    size_t scan_filtered(Key l, Key r, Value lo, Value hi, std::vector<Key> &keys,
+                         std::vector<Value> &values) const;
+    // 步长采样：[l, r] 按宽度 width 划分窗口，每个非空窗口的首个条目按序追加到 out，
+    // 返回条数（见 RangeCursor::next_stride；每步 O(log 跨度)，不读取窗口内的其余条目）
+    size_t scan_stride(Key l, Key r, Key width, std::vector<KVPair> &out) const;
+
+    // ========================= 降采样 =========================
+    // [l, r] 按宽度 width 划分为定长桶（第 i 个桶为 [l + i*width, l + (i+1)*width) 与
+    // [l, r] 之交），逐段直接在块内键/值数组上归约：块内以指数搜索找到桶边界，
+    // 每个桶的一段值用 SIMD 内核一次求出最小值、最大值与和（见 Simd.h）。
+    enum Agg : unsigned
+    {
+        AGG_MIN = 1u << 0,
+        AGG_MAX = 1u << 1,
+        AGG_SUM = 1u << 2, // 和（按 2^64 取模），平均值由 Bucket::avg() 给出
+        AGG_LAST = 1u << 3,
+        AGG_ALL = AGG_MIN | AGG_MAX | AGG_SUM | AGG_LAST
+    };
+    struct Bucket
+    {
+        Key start;      // 桶起点
+        uint64_t count; // 条目数（总是计算）
+        Value min, max, sum;
+        Key last_key;   // 桶内最后一个条目（按 key 顺序）
+        Value last;
+        double avg() const noexcept { return count ? static_cast<double>(sum) / count : 0.0; }
+    };
+    // 写出前 min(cap, 桶数) 个桶（不分配内存；空桶与 aggs 未选中的字段为 0），
+    // 返回桶总数 (r - l) / width + 1（l > r 或 width == 0 时为 0；超出 size_t 时饱和为其上限），
+    // 调用方可据此分配缓冲
+    size_t downsample(Key l, Key r, Key width, unsigned aggs, Bucket *out, size_t cap) const;
+
+    // ========================= 计数与名次 =========================
+    // 基于搜索层叶子计数，O(log n)（外加候选叶子所在的一两个块）；
+    // 结果覆盖数据层与溢出区，与 scan 一致；侧缓冲与尚未转换的写入不计入。
+    // 索引滞后期间（flush_index 之前）新近并入的迟到点可能暂未计入。
+    size_t rank(Key k) const;                  // key < k 的条目数
+    size_t count(Key l, Key r) const;          // [l, r] 内的条目数（选择率估计/分页总数）
+    bool select(size_t i, KVPair *out) const;  // 按 key 顺序的第 i 个条目（0 起）
+
+    // ========================= 并行扫描 =========================
+    // [l, r] 按搜索层叶层切成块对齐的分区（分区边界为叶子 min_key），多个线程
+    // （含调用线程）从共享计数器领取分区，空闲线程随时取走剩余分区，快慢不均时
+    // 自动平衡。分区按 key 递增编号；同一分区内按 key 顺序，不同分区并发执行。
+    // threads == 0 表示使用全部硬件线程；区间过短时只用调用线程。
+    // 回调抛出的异常在全部线程结束后由调用线程重新抛出（其余分区不再领取）。
+    struct KeyRange
+    {
+        Key lo, hi; // 闭区间
+    };
+    // 分区：至多 max_parts 个、首尾分别为 l 与 r、相邻分区首尾相接
+    std::vector<KeyRange> scan_partitions(Key l, Key r, size_t max_parts) const;
+    // 对每段连续元素调用 fn(part, span)，fn 须能被多个线程同时调用；
+    // 调用方可按分区暂存结果再按分区顺序合并。返回条目总数。
+    size_t parallel_scan(Key l, Key r, const std::function<void(size_t part, const Span &)> &fn,
+                         size_t threads = 0) const;
+    // 并行聚合：每个分区从 init 起以 acc = fold(acc, span) 累积，分区结果再按 key 顺序
+    // 以 acc = combine(acc, part) 合并；init 须为 combine 的单位元（如求和时为 0），
+    // combine 只需满足结合律
+    template <class T, class Fold, class Combine>
+    T parallel_reduce(Key l, Key r, T init, Fold fold, Combine combine, size_t threads = 0) const
+    {
+        const auto parts = scan_partitions(l, r, partition_target_(threads));
+        std::vector<T> partial(parts.size(), init);
+        run_partitions_(parts, [&](size_t p, RangeCursor &cur)
+                        {
+                            T acc = init;
+                            Span sp;
+                            while (cur.next_span(&sp))
+                                acc = fold(std::move(acc), sp);
+                            partial[p] = std::move(acc); },
+                        threads);
+        T out = init;
+        for (auto &v : partial)
+            out = combine(std::move(out), std::move(v));
+        return out;
+    }
+
+    // ========================= 批量装载 =========================
+    // 按 key 非降的输入自底向上装载：多线程按块边界切分输入、直接填满
+    // DataBlock，链接后作为一个 run 发布，搜索层一次追加、一次发布快照；
+    // 返回前等待索引完成。threads == 0 表示使用全部硬件线程。
+    // key 低于水位的前缀按迟到点处理（写时复制并入）；写入前端尚未封印的
+    // 缓冲不受影响，其后封印时照常按水位处理。
+    void bulk_load(const KVPair *data, size_t n, size_t threads = 0);
+    // 流式批量装载：反复调用 fill(buf, cap) 取下一段有序数据（返回 0 表示结束），
+    // 每段按 bulk_load 的方式装载发布；段间须整体有序。返回装载条目总数。
+    size_t bulk_load_stream(const std::function<size_t(KVPair *, size_t)> &fill,
+                            size_t threads = 0);
+
+    // ========================= 测试/诊断接口 =========================
+    bool verify_data_layer(size_t expected_total_keys) const; // 遍历数据层验证正确性
+
+    // ========================= 区间游标 =========================
+    class RangeCursor
+    {
+    public:
+        bool next(KVPair *out);                                    // 取下一个元素
+        size_t next_batch(std::vector<KVPair> &out, size_t limit); // 批量取元素
+        // 取下一段连续元素（通常为一个块内的剩余部分）；与溢出区交错时按归并顺序切段
+        bool next_span(Span *out);
+        // 批量复制到调用方缓冲（各至少 cap 个），返回写入条数，0 表示结束
+        size_t next_batch(Key *keys, Value *values, size_t cap);
+        // 值过滤：只把值在 [lo, hi] 内的条目复制到调用方缓冲（见 scan_filtered），
+        // 返回写入条数，0 表示结束（cap 为 0 或 lo > hi 时同样返回 0）。
+        // 为保证整段 SIMD 写出不越界，剩余空间不足一段（kFilterChunk 与 cap 的较小者）
+        // 时即返回，写入条数可能小于 cap
+        size_t next_filtered(Value lo, Value hi, Key *keys, Value *values, size_t cap);
+        static constexpr size_t kFilterChunk = 256; // 一次交给过滤内核的最大条目数
+        // 跳到第一个 key >= k 的元素（只前进；k 不超过当前位置时不动），返回是否仍有元素。
+        // 目标仍在当前块内时块内二分；否则先沿链试探近邻块，再查尾部目录或自叶层提示
+        // 指数搜索，代价为 O(log 跨度)，不逐条经过中间元素。归并连接、跳到较晚时刻时使用
+        bool seek(Key k);
+        // 步长采样：按 [l + i*width, l + (i+1)*width) 划分窗口（l 为游标区间左端），
+        // 取下一个非空窗口的首个元素，随后 seek 到下一窗口起点；空窗口直接越过
+        bool next_stride(Key width, KVPair *out);
+        inline bool valid() const noexcept { return blk_ != nullptr || ov_pos_ < ov_end_; }
+
+    private:
+        friend class SBTreeBase;
+        // leaf 为 start 的叶层下标（未知时为 npos，预取在首次跨块时再定位）
+        RangeCursor(const SBTreeBase *owner, Key l, Key r, DataBlock *start,
+                    std::size_t leaf = static_cast<std::size_t>(-1));
+        void seek_first_pos_(); // 在当前块内定位到第一个 >= l 的元素
+        bool settle_();         // 跳过已耗尽的块；返回当前块位置是否仍在区间内
+        bool peek_span_(Span *out, bool *from_ov); // 当前可连续产出的一段（不前进）
+        void prefetch_ahead_(); // 进入新块时预取前方的块（见 SBTreeOptions::scan_prefetch_blocks）
+
+        const SBTreeBase *owner_; // 指向宿主树
+        EpochPin pin_;            // 游标存续期间，经过的数据块即使被替换也不会释放
+        Key l_, r_;       // r_ 为数据层的读取右端
+        Key hi_;          // 区间右端；新鲜读时数据层只读到 r_，其上由快照 run 提供
+        DataBlock *blk_;  // 当前数据块
+        std::size_t idx_; // 当前块内索引
+
+        // 溢出区归并（溢出区为空时不持有快照；新鲜读时为合成的快照 run）
+        std::shared_ptr<const OverflowStore::Run> ov_;
+        std::size_t ov_pos_ = 0, ov_end_ = 0;
+        // 新鲜读：数据层中跳过的 key（升序，由快照 run 提供），skip_pos_ 之前的已越过
+        std::vector<Key> skip_;
+        std::size_t skip_pos_ = 0;
+
+        // 预取流水线：叶层指针按批从搜索层取出，hint_ 对应叶层 [hint_base_, hint_base_ + hint_len_)
+        static constexpr std::size_t kHintBatch = 16;
+        DataBlock *hint_[kHintBatch];
+        std::size_t hint_base_ = 0, hint_len_ = 0;
+        std::size_t pf_next_ = static_cast<std::size_t>(-1); // 下一个待预取的叶层下标（尚未定位时为 npos）
+        bool pf_done_ = false; // 禁用、未被索引或已越过区间右端时停止预取
+        // seek 的叶层提示：最近一次定位到的叶层下标（沿链前进时不更新，仅作指数搜索起点）
+        std::size_t seek_leaf_ = static_cast<std::size_t>(-1);
+    };
+    RangeCursor open_range_cursor(Key l, Key r) const; // 打开区间游标
+    // 分页：跳过 [l, r] 内前 offset 个条目，直接定位到目标块（LIMIT/OFFSET）；只读已发布数据
+    RangeCursor open_range_cursor(Key l, Key r, size_t offset) const;
+
+    // ========================= 逆序游标 =========================
+    // 自 r 起按 key 降序遍历 [l, r]（同 key 的条目与 RangeCursor 的顺序相反），
+    // 用于“r 之前最新的若干条”。数据块只有后继指针：起点经尾部目录或搜索层
+    // 定位 floor(r) 所在块；此后按叶层下标逐个取前一个叶子，从它沿 next() 走到
+    // 已产出的块之前为一组（通常只有该叶子本身，另含写时复制拆分出的后继块），
+    // 组内逆序产出。每组 O(1)，仅在叶层下标未知（起点来自尾部目录）时再下降
+    // 一次搜索层，不读取区间之外的块。
+    class ReverseCursor
+    {
+    public:
+        bool next(KVPair *out);                                    // 取下一个（更小的）元素
+        size_t next_batch(std::vector<KVPair> &out, size_t limit); // 批量取元素（按降序追加）
+        // 取下一段连续元素：段内仍按 key 升序存放、整段位于此前产出的元素之前，
+        // 逆序消费时自 keys[n - 1] 向前
+        bool next_span(Span *out);
+        inline bool valid() const noexcept { return blk_ != nullptr || ov_lo_ < ov_pos_; }
+
+    private:
+        friend class SBTreeBase;
+        // start 为 floor(r) 的候选块，leaf 为其叶层下标（未知时为 npos）
+        ReverseCursor(const SBTreeBase *owner, Key l, Key r, DataBlock *start, size_t leaf);
+        bool load_group_(DataBlock *from, DataBlock *stop, Key bound); // 自 from 沿链收集到 stop 之前
+        bool prev_group_();         // 载入当前组之前的一组；返回是否还有
+        void enter_(DataBlock *b);  // 进入块 b，定位其在区间内的下标范围
+        bool settle_();             // 跳过已耗尽的块；返回当前块是否仍有元素
+        DataBlock *leaf_at_(size_t i); // 叶层第 i 个指针（按批从搜索层取出）
+        void prefetch_behind_();       // 进入新组时预取前方（更早）的块
+        bool peek_span_(Span *out, bool *from_ov); // 当前可连续产出的一段（不前进）
+
+        const SBTreeBase *owner_;
+        EpochPin pin_; // 游标存续期间，经过的数据块即使被替换也不会释放
+        Key l_, r_;
+        std::vector<DataBlock *> group_; // 当前组（链上顺序），自尾向头产出
+        size_t gi_ = 0;                  // 当前块在 group_ 中的下标
+        size_t leaf_;                    // group_.front() 的叶层下标（未知时为 npos）
+        DataBlock *blk_ = nullptr;       // 当前数据块
+        size_t lo_ = 0, end_ = 0;        // 当前块内尚未产出的区间内元素为 [lo_, end_)
+
+        // 溢出区尚未产出的为 [ov_lo_, ov_pos_)
+        std::shared_ptr<const OverflowStore::Run> ov_;
+        size_t ov_lo_ = 0, ov_pos_ = 0;
+
+        // 叶层指针按批取出，back_ 对应叶层 [back_base_, back_base_ + back_len_)
+        static constexpr size_t kLeafBatch = 16;
+        DataBlock *back_[kLeafBatch];
+        size_t back_base_ = 0, back_len_ = 0;
+    };
+    ReverseCursor open_reverse_cursor(Key l, Key r) const; // 打开逆序游标
+    // key <= r 的最新 n 个条目，按 key 升序追加到 out，返回条数；O(log N + n)
+    size_t latest_n(Key r, size_t n, std::vector<KVPair> &out) const;
+
+    // ========================= 指针提示（Finger） =========================
+    // 面向 key 大体单调递增的连续点查（回放、有序 join）：记住上次定位到的
+    // 数据块与叶层下标，下一次先沿 next() 前进至多 kMaxHops 块，其次查尾部目录，
+    // 再在叶层自上次下标起指数搜索，距离过远才完整下降搜索层。
+    // 结果与 lookup 相同；句柄仅供单线程使用，且不得长于所属的树
+    // （句柄持有纪元登记，缓存的块被替换后不会释放，据其状态放弃；
+    // 登记期间全进程的回收随之推迟，不宜长期闲置）。
+    class Finger
+    {
+    public:
+        static constexpr int kMaxHops = 2;
+        bool lookup(Key k, Value *out);
+        uint64_t fallbacks() const noexcept { return fallbacks_; } // 诊断统计：未能沿链前进的次数
+
+    private:
+        friend class SBTreeBase;
+        explicit Finger(const SBTreeBase *owner) : owner_(owner) {}
+
+        const SBTreeBase *owner_;
+        EpochPin pin_;                          // 保证 blk_ 不被释放
+        DataBlock *blk_ = nullptr;              // 上次的候选块
+        size_t leaf_ = static_cast<size_t>(-1); // 上次的叶层下标（提示）
+        bool chained_ = false;                  // 上次是否沿链命中（否则跳过逐块试探）
+        bool far_ = false;                      // 上次叶层距离是否超出指数搜索范围
+        uint64_t fallbacks_ = 0;
+    };
+    Finger finger() const { return Finger(this); }
+
+    // ========================= 索引控制接口 =========================
+    void flush_index();                               // 阻塞，等待索引同步完成
+    uint64_t index_batches_enqueued() const noexcept; // 诊断统计：入队批次数
+    uint64_t index_batches_applied() const noexcept;  // 诊断统计：应用批次数
+    uint64_t index_items_enqueued() const noexcept;   // 诊断统计：入队数据块数
+    uint64_t index_items_applied() const noexcept;    // 诊断统计：已应用数据块数
+    uint64_t index_apply_rounds() const noexcept;     // 诊断统计：合并应用轮数（每轮至多发布一次追加快照）
+    std::size_t index_levels() const;                 // 搜索层层数（加锁读取）
+    std::size_t overflow_size() const noexcept;       // 诊断统计：溢出区条目数
+    uint64_t appended_entries() const noexcept;       // 诊断统计：发布到数据层尾部的条目数
+
+protected:
+    explicit SBTreeBase(const SBTreeOptions &opts);
+    virtual ~SBTreeBase(); // 负责释放 DataBlock 链表
+
+    // ========================= 派生类接口 =========================
+    void start_index_thread_();                                  // 启动后台索引线程
+    void stop_index_thread_();                                   // 等待索引同步并停止线程（幂等）
+    // 启用 seal_max_age 时由索引线程周期调用，供写入前端处理超时的缓冲
+    virtual void on_index_tick_() {}
+
+    // 新鲜读钩子（SBTreeOptions::fresh_reads），由写入前端覆盖：
+    // - lookup_fresh_：含尚未发布条目的点查；默认只查已发布数据；
+    // - fresh_overlay_：[l, r] 内有尚未发布的条目时返回一个有序 run，含这些条目以及
+    //   已发布数据（数据层与溢出区）中 key 属于 *skip（升序）或 >= *data_end 的部分，
+    //   两者取自同一时刻；*skip 为这些条目中低于 *data_end 的 key。游标在 *data_end
+    //   以下照常读取数据层与溢出区但跳过 *skip 中的 key，其余只读该 run。没有时返回 nullptr。
+    virtual bool lookup_fresh_(Key k, Value *out) const { return lookup_published_(k, out); }
+    virtual std::shared_ptr<const OverflowStore::Run> fresh_overlay_(Key, Key, Key *, std::vector<Key> *) const
+    {
+        return nullptr;
+    }
+    bool lookup_published_(Key k, Value *out) const;            // 只查已发布数据
+    RangeCursor open_published_cursor_(Key l, Key r) const;     // 只读已发布数据的游标
+
+    // 链接 run 并合并迟到点。seg 非空时 run 由该段转换而来：在数据层锁内以发布序号
+    // 包围挂链与标记段已转换，新鲜读据此得到一致快照（见 pub_seq_）
+    void publish_run_(std::vector<DataBlock *> blocks, size_t entries, SegmentedBlock *seg = nullptr);
+    // 持有数据层锁期间不会有发布：新鲜读快照重试过多时改在锁内读取
+    std::unique_lock<std::mutex> lock_publication_() const { return std::unique_lock<std::mutex>(data_layer_lock_); }
+    void insert_late_(Key key, Value value, Key wm);             // 迟到点分流（侧缓冲/溢出区）
+
+    const SBTreeOptions opts_;
+    std::atomic<Key> watermark_{0}; // 水位：数据层已转换数据的最大 key
+    // 发布序号 [代数:32 | 进行中的发布数:32]：段的条目挂入数据层前加一个进行中，
+    // 标记段已转换后转为代数加一，二者都在数据层锁内。读者快照前后序号相同且
+    // 无进行中的发布即为一致；进行中的窗口只覆盖一次数据层临界区
+    static constexpr uint64_t kPubGen = uint64_t(1) << 32;
+    std::atomic<uint64_t> pub_seq_{0};
+
+private:
+    // ========================= 内部辅助 =========================
+    // 索引任务：replaced 为空表示追加一个 run；否则 blocks 为替换 replaced 的整条新链
+    //（blocks[0] 接替其位置，其余为拆分出的后继块）；absorbed 非空时为一并并入新链、
+    // 紧随 replaced 之后的后继块（与之同属一个叶子）
+    struct IndexTask
+    {
+        std::vector<DataBlock *> blocks;
+        DataBlock *replaced = nullptr;
+        DataBlock *absorbed = nullptr;
+    };
+
+    // 并行扫描：按线程数确定分区数目标；逐分区打开游标交给 fn（领取方式见上文）
+    static constexpr size_t kPartitionsPerThread = 8; // 每线程的分区数（供动态平衡）
+    static constexpr size_t kMinPartitionLeaves = 16; // 每个分区至少的叶子数（过小不值得并行）
+    static size_t resolve_threads_(size_t threads);
+    static size_t partition_target_(size_t threads) { return resolve_threads_(threads) * kPartitionsPerThread; }
+    void run_partitions_(const std::vector<KeyRange> &parts,
+                         const std::function<void(size_t, RangeCursor &)> &fn, size_t threads) const;
+    // 多线程把有序输入填入 DataBlock 并按序链接
+    static std::vector<DataBlock *> build_sorted_blocks_(const KVPair *data, size_t n,
+                                                         size_t threads);
+    std::vector<KVPair> drain_late_();                           // 取走侧缓冲
+    void publish_stale_late_();                                  // 侧缓冲等待超过 seal_max_age 时并入
+    void split_late_prefix_locked_(std::vector<DataBlock *> &blocks, Key wm,
+                                   std::vector<KVPair> &late);   // 拆出 run 中低于水位的前缀
+    void merge_late_locked_(std::vector<KVPair> &late,
+                            std::vector<IndexTask> &replaced);   // 写时复制并入迟到点
+    DataBlock *locate_floor_locked_(Key k, DataBlock **prev) const; // 定位链上 floor 块及其前驱
+    static constexpr size_t kMaxMergeHops = 16; // 并入迟到点时沿链前进到下一组的最多块数
+    void index_worker_();                                        // 后台索引线程主循环
+    void apply_index_batch_(std::vector<IndexTask> &batch);      // 合并并应用一批积压任务
+    void apply_replace_(const IndexTask &task, std::vector<DataBlock *> &run,
+                        std::vector<uint64_t> &run_counts, size_t base); // 应用替换并记账计数
+    void push_index_task_(IndexTask &&task);                     // 入队并在需要时唤醒后台线程
+    void enqueue_index_task_(std::vector<DataBlock *> &&blocks); // 入队索引任务
+    void enqueue_replace_tasks_(std::vector<IndexTask> &&tasks); // 入队叶子替换任务
+    // 目录与搜索层可能滞后于链（替换任务尚未应用），给出已被替换的块；下列定位
+    // 函数都经 live_ 换成接替它的在链块，读写两侧拿到的候选总在链上
+    static DataBlock *live_(DataBlock *b) noexcept;              // 已替换的块 → 接替它的在链块
+    DataBlock *tail_find_(Key k) const;                          // 尾部目录
+    DataBlock *find_candidate_(Key k) const;                     // 尾部目录优先，其次搜索层
+    DataBlock *index_find_(Key k) const;                         // 按所选实现查询搜索层
+    DataBlock *index_find_(Key k, uint64_t *before) const;       // 同上，并给出之前的条目数
+    DataBlock *index_find_near_(Key k, size_t *leaf) const;      // 同上，自叶层提示处指数搜索
+    size_t index_copy_leaves_(size_t from, Key hi, DataBlock **out, size_t n) const; // 叶层指针（预取用）
+    void index_find_batch_(const Key *keys, size_t n, DataBlock **out) const; // 批量定位
+    bool lookup_from_(DataBlock *blk, Key k, Value *out) const;  // 自候选块起点查（含溢出区）
+    // floor(k) 所在块：blk 为某个 k' <= k 的 floor 块（可为空），*leaf 为叶层提示（可为 npos）
+    DataBlock *floor_block_(Key k, DataBlock *blk, size_t *leaf) const;
+    DataBlock *index_select_(uint64_t r, uint64_t *offset) const; // 按名次定位叶子
+    uint64_t data_rank_le_(Key k) const;                         // 数据层中 key <= k 的条目数
+    DataBlock *data_select_(uint64_t a, size_t *idx) const;      // 数据层第 a 个条目所在块与下标
+    void split_rank_(uint64_t g, const OverflowStore::Run &ov,
+                     uint64_t *a, uint64_t *b) const;            // 前 g 个条目在数据层/溢出区的划分
+
+    // ========================= 并发控制 =========================
+    mutable std::shared_mutex search_mu_;          // 搜索层读写锁
+    std::thread index_thread_;                     // 专用索引维护线程
+    MpscQueue<IndexTask> index_q_;                 // 索引任务队列（无锁 MPSC）
+    std::mutex q_mu_;                              // 仅用于休眠/唤醒与 flush_index 等待
+    std::condition_variable q_cv_;                 // 后台线程的休眠/唤醒（唯一的等待者）
+    std::condition_variable done_cv_;              // 进度通知（flush_index 的等待者）
+    std::atomic<bool> index_stop_{false};          // 线程停止标志
+    std::atomic<bool> index_sleeping_{false};      // 后台线程是否准备休眠（生产者据此决定是否唤醒）
+    // 拆分出的后继块 → 所属叶子下标（其条目计在该叶子名下；仅索引线程访问）
+    std::unordered_map<DataBlock *, size_t> span_owner_;
+    std::atomic<uint64_t> idx_tasks_enqueued_{0};  // 已入队任务数（含替换任务）
+    std::atomic<uint64_t> idx_tasks_done_{0};      // 已应用任务数
+
+    // ========================= 统计指标 =========================
+    std::atomic<uint64_t> idx_batches_enqueued_{0};
+    std::atomic<uint64_t> idx_batches_applied_{0};
+    std::atomic<uint64_t> idx_items_enqueued_{0};
+    std::atomic<uint64_t> idx_items_applied_{0};
+    std::atomic<uint64_t> idx_apply_rounds_{0};
+    std::atomic<uint64_t> appended_entries_{0};
+
+    // ========================= 数据层 =========================
+    mutable std::mutex data_layer_lock_;     // 数据层链表锁
+    std::atomic<DataBlock *> data_head_;     // 数据链表头（写时复制可能替换表头）
+    DataBlock *data_tail_;                   // 数据链表尾
+    // 链上拆分出的后继块（不在叶层）：重排时可与前一块合并
+    std::unordered_set<DataBlock *> successors_;
+    TailDirectory tail_dir_;                 // 链尾最新块目录（写侧在数据层锁内维护）
+
+    // ========================= 乱序写入 =========================
+    std::mutex late_mu_;                     // 侧缓冲锁
+    std::vector<KVPair> late_;               // 窗口内迟到点，等待下次转换并入
+    int64_t late_first_ns_ = 0;              // 侧缓冲中最早一点的写入时刻（启用 seal_max_age 时记录）
+    OverflowStore overflow_;                 // 超出窗口的迟到点
+
+    // ========================= 搜索层 =========================
+    SearchLayer search_;                          // 搜索层实例（BTREE）
+    std::unique_ptr<LearnedSearchLayer> learned_; // 学习型搜索层（仅 LEARNED 时创建）
+};
@@ -4,7 +4,10 @@
 #include <cstdint>
 #include <cassert>
 #include <memory>
+#include <atomic>
 #include "KVPair.h" // 定义 Key 类型
+#include "ChunkedArray.h"
+#include "PrefixCounts.h"
 
 class DataBlock; // 前向声明
 
@@ -20,57 +23,121 @@ class DataBlock; // 前向声明
 // - 搜索层的写入由后台专用线程维护（append_run 时批量晋升）；
 // - 其他工作线程只读搜索层，可并发安全访问；
 // - 这样避免了搜索层上的写入冲突，整体并发由数据层承担。
+// 布局：
+// - 每层只存分隔键（键数组），叶层另有一条与之对齐的 DataBlock* 数组；
+// - 第 lv 层第 j 个键覆盖下层 [j*F, (j+1)*F) 这一组子节点（子位置由下标
+//   推出，不再存 child_begin/child_count）；
+// - 一个“节点”即下层中连续的 F 个键，块按缓存行对齐且 F 整除块长，
+//   因此节点恒为 F*8 字节的整行连续内存，用 SIMD 一次比较完（见 Simd.h）；
+// - 扇出 8/16/32/64 各有编译期展开的下降内核，其他 2 的幂扇出走通用路径。
 // 不变式：
-// - L0 中条目按 min_key 非降；
-// - 内层节点的 min_key 等于其覆盖的第一个子节点的 min_key；
-// - promoted_ 记录各层已经完成晋升的位置。
+// - 各层键非降；
+// - 内层键等于其覆盖的第一个子节点的键；
+// - promoted_ 记录各层已经完成晋升的位置（恒为 F 的整数倍）；
+// - 最高层长度 < F（否则已晋升出更高层）；
+// - promoted_[lv] == 第 lv+1 层长度 × F：各层未晋升的尾部（< F 个）紧接在
+//   上层最后一个键所覆盖的节点之后，查找时由右边缘一并覆盖。
+// 计数：
+// - 每个叶子另记其条目数（含写时复制拆分出的、挂在该叶子之后的后继块），
+//   按与键层相同的分组逐层汇总（PrefixCounts），内层键所在位置即其子树计数；
+// - find_candidate 可同时给出候选叶子之前的条目总数，select_leaf 按名次
+//   定位叶子，二者均为 O(层数) 级别，供 rank/count/select 与分页使用。
+// 快照：
+// - 各层存放在只追加的 ChunkedArray 中，由所有快照共享；快照只记录各层
+//   发布时的长度（O(层数)），发布一次的代价与新增块数成正比，而非全量复制；
+// - 快照指针为裸原子指针，读者在 EpochGuard 临界区内读取；被替换的旧快照
+//   （连同其间写时复制替换下来的旧叶块）交给 EpochManager，宽限期后释放。
 // -----------------------------------------------------------------------------
 class SearchLayer
 {
 public:
     // ----------------------------- 公共结构体 --------------------------------
-    struct LeafEnt
-    {
-        Key min_key;    // 对应 DataBlock 的最小 key
-        DataBlock *ptr; // 指向数据块
-    };
+    using KeyArray = ChunkedArray<Key>;         // 一层的分隔键
+    using PtrArray = ChunkedArray<DataBlock *>; // 叶层的数据块指针（与叶层键对齐）
 
-    struct NodeEnt
+    struct LevelView
     {
-        Key min_key;             // 覆盖区间的最小 key（取首子节点）
-        std::size_t child_begin; // 在下层数组中的起始下标
-        std::size_t child_count; // 覆盖的子节点数量（= fanout_）
+        const KeyArray *keys; // 共享的键数组
+        std::size_t size;     // 发布时的长度
     };
 
     struct SearchSnapshot
     {
-        std::vector<LeafEnt> L0;             // 叶层快照
-        std::vector<std::vector<NodeEnt>> L; // 内层快照
+        const PtrArray *leaves = nullptr; // 共享的叶层指针数组
+        std::vector<LevelView> L;         // 各层视图（L[0] 为叶层，L[1..] 为内层）
+
+        // 本快照期间被写时复制替换下来的叶块/计数块（随快照一起退役，读者不访问）
+        std::vector<PtrArray::Chunk> garbage;
+        std::vector<PrefixCounts::CountArray::Chunk> count_garbage;
     };
 
     // ----------------------------- 构造/析构 --------------------------------
+    // fanout 须为 2 的幂且不超过块长（节点不跨块）
     explicit SearchLayer(std::size_t fanout = 64);
-    ~SearchLayer() = default;
+    ~SearchLayer();
 
     SearchLayer(const SearchLayer &) = delete;
     SearchLayer &operator=(const SearchLayer &) = delete;
-    SearchLayer(SearchLayer &&) = default;
-    SearchLayer &operator=(SearchLayer &&) = default;
 
     // ----------------------------- 追加接口 ---------------------------------
-    // 批量追加：一次段转换产出的 DataBlock* run（已按 min_key 有序）
+    // 批量追加：一次段转换产出的 DataBlock* run（已按 min_key 有序）；
+    // counts 为各叶子的条目数（缺省取块自身的条目数）
     void append_run(const std::vector<DataBlock *> &blocks);
+    void append_run(const std::vector<DataBlock *> &blocks, const std::vector<std::uint64_t> &counts);
+
+    // 写时复制替换：把叶层中指向 old 的条目改指 repl（min_key 保持不变），
+    // 并把该叶子的计数增加 added；pos 非空时写出叶子下标。
+    // 返回是否找到该叶子（old 可能不在叶层中，例如拆分出的后继块）。
+    bool replace_leaf(DataBlock *old, DataBlock *repl, std::uint64_t added = 0,
+                      std::size_t *pos = nullptr);
+
+    // 第 leaf 个叶子的计数增加 added（其拆分出的后继块又并入了迟到点）
+    void add_count(std::size_t leaf, std::uint64_t added);
+
+    // replace_leaf / add_count 以原子换块即时对读者生效，但不发布快照：换下的旧块
+    // 暂存到下一次发布时随旧快照退役。一批修改之后调用一次 publish()（append_run
+    // 自带发布），整批只发布一次快照
+    void publish();
 
     // ----------------------------- 查询接口 ---------------------------------
     // 查找候选：返回“最后一个 min_key <= k”的 DataBlock*，否则 nullptr
     DataBlock *find_candidate(Key k) const noexcept;
+    // 同上，从叶子 *leaf 起向后指数搜索（key 单调递增的连续查询只需比较
+    // O(log 距离) 个叶层键）；提示无效或距离过远时退回完整下降。
+    // *leaf 写回结果的叶层下标（无候选时为 npos），供下一次查询作为提示。
+    DataBlock *find_candidate_near(Key k, std::size_t *leaf) const noexcept;
+    // 批量查找候选：out[i] 与 find_candidate(keys[i]) 相同（keys 顺序任意）。
+    // 不小于上一个结果且相距不超过 kBatchNear 个叶子的 key 直接在叶层上定位
+    // （升序相邻、同块的 key 共享一次下降）；其余 key 每 kBatchLanes 个一组逐层
+    // 交错下降，每路比较完本层即预取下一层节点，使一组的缓存缺失同时在途。
+    void find_candidates(const Key *keys, std::size_t n, DataBlock **out) const noexcept;
+    // 同上（find_candidate），并写出候选叶子之前所有叶子的条目总数（无候选时为 0）
+    DataBlock *find_candidate(Key k, std::uint64_t *before) const noexcept;
+    // 名次 r（0 起）所在的叶子，*offset 为其相对该叶子首条目的偏移；
+    // r 超出已索引总数时返回最后一个叶子（偏移不小于其计数），为空时返回 nullptr
+    DataBlock *select_leaf(std::uint64_t r, std::uint64_t *offset) const noexcept;
+    // 并行扫描的分区边界：把覆盖 [l, r] 的叶子（floor(l) 到 floor(r)）均分为至多
+    // parts 段、每段至少 min_leaves 个叶子，把第 2 段起各段首叶子的 min_key
+    // （严格递增且落在 (l, r] 内）追加到 out
+    void split_keys(Key l, Key r, std::size_t parts, std::size_t min_leaves,
+                    std::vector<Key> &out) const;
+    // 自叶子 from 起最多复制 n 个 min_key <= hi 的叶层指针到 out，返回实际个数；
+    // 扫描预取据此得知前方块的地址，不必沿链逐个解引用
+    std::size_t copy_leaves(std::size_t from, Key hi, DataBlock **out, std::size_t n) const noexcept;
 
     // ----------------------------- 工具/状态 --------------------------------
-    bool empty() const noexcept { return L0_.empty(); }           // 是否为空
-    std::size_t leaf_size() const noexcept { return L0_.size(); } // 叶层条目数
-    std::size_t levels() const noexcept { return L_.size() + 1; } // 总层数（含叶层）
-    std::size_t fanout() const noexcept { return fanout_; }       // 返回扇出因子
-    void clear();                                                 // 清空全部内容
+    static constexpr std::size_t kMaxGallop = 64; // 指数搜索的最远步长（叶子数，约一个节点的比较量）
+    static constexpr std::size_t kBatchLanes = 16; // 批量定位时同时在途的下降路数
+    static constexpr std::size_t kBatchNear = 8;   // 批量定位时视为近邻、直接在叶层上定位的最远叶子距离
+    // 叶层 [0, n) 内自提示 h 起向后指数搜索“最后一个 <= k”的下标；
+    // 提示无效（越界或其键 > k）或距离超过 max_dist 时返回 npos（LearnedSearchLayer 复用）
+    static std::size_t gallop_floor(const KeyArray &L0, std::size_t n, std::size_t h, Key k,
+                                    std::size_t max_dist = kMaxGallop) noexcept;
+    bool empty() const noexcept { return leaf_keys_().empty(); }           // 是否为空
+    std::size_t leaf_size() const noexcept { return leaf_keys_().size(); } // 叶层条目数
+    std::size_t levels() const noexcept { return keys_.size(); }           // 总层数（含叶层）
+    std::size_t fanout() const noexcept { return fanout_; }                // 返回扇出因子
+    void clear();                                                          // 清空全部内容
 
     // 返回当前快照的层级数（测试/调试用）
     std::size_t levels_snapshot() const noexcept;
@@ -79,25 +146,31 @@ private:
     // ----------------------------- 内部帮助 ---------------------------------
     static void debug_verify_sorted_leaf_run_(const std::vector<DataBlock *> &blocks);
     void promote_from_level_(std::size_t level); // 从某层开始尝试晋升
+    bool replace_at_(std::size_t i, DataBlock *repl, std::uint64_t added, std::size_t *pos);
 
-    // 二分查找：父层节点数组，返回“最后一个 min_key <= k”的下标
-    static std::size_t upper_floor_index_(const std::vector<NodeEnt> &arr, Key k) noexcept;
+    const KeyArray &leaf_keys_() const noexcept { return *keys_.front(); }
 
-    // 二分查找：叶层区间 [lo,hi)，返回“最后一个 min_key <= k”的下标
-    static std::size_t leaf_floor_index_(const std::vector<LeafEnt> &arr,
-                                         std::size_t lo, std::size_t hi,
-                                         Key k) noexcept;
+    // 自顶向下定位叶层下标（无则 npos）；FixedF 非 0 时节点比较按编译期扇出展开
+    template <std::size_t FixedF>
+    std::size_t descend_(const SearchSnapshot &snap, Key k) const noexcept;
+    std::size_t descend_dispatch_(const SearchSnapshot &snap, Key k) const noexcept;
+    template <std::size_t FixedF>
+    void find_candidates_(const SearchSnapshot &snap, const Key *keys, std::size_t n,
+                          DataBlock **out) const noexcept;
 
-    // 重新构建快照（仅写线程调用）
-    void rebuild_snapshot_();
+    // 发布新快照：记录各层当前长度，旧快照连同待回收的旧块一起退役（仅写线程调用）
+    void publish_snapshot_();
 
 private:
     // ----------------------------- 成员变量 ---------------------------------
-    std::vector<LeafEnt> L0_;             // 叶层
-    std::vector<std::vector<NodeEnt>> L_; // 内层（L1,L2,...）
-    std::vector<std::size_t> promoted_;   // 各层的晋升进度指针
+    std::vector<std::unique_ptr<KeyArray>> keys_;  // 各层键（[0]=叶层），数组对象地址稳定
+    PtrArray leaves_;                              // 叶层 DataBlock*
+    std::vector<std::size_t> promoted_;            // 各层的晋升进度指针
+    PrefixCounts counts_;                          // 叶子条目计数（与键层同样分组）
+    std::vector<PtrArray::Chunk> pending_garbage_; // 自上次发布以来被替换下来的叶块
+    std::vector<PrefixCounts::CountArray::Chunk> pending_count_garbage_; // 同上（计数块）
 
     std::size_t fanout_ = 64; // 固定扇出
 
-    std::shared_ptr<const SearchSnapshot> snapshot_; // 快照指针
-};
\ No newline at end of file
+    std::atomic<SearchSnapshot *> snapshot_{nullptr}; // 快照指针（读者在纪元临界区内读取）
+};
@@ -1,12 +1,14 @@
 #pragma once
 #include <atomic>
 #include <cstdint>
+#include <cstddef>
 #include <mutex>
 #include <algorithm>
 #include <iterator>
 #include <vector>
 #include "KVPair.h"
 #include "PerThreadDataBlock.h"
+#include "ConversionJob.h"
 
 // -----------------------------------------------------------------------------
 // BlockStatus
@@ -14,13 +16,15 @@
 // 作用：标识分段块（SegmentedBlock）的当前生命周期阶段。
 // - ACTIVE ：可接受写入；
 // - CONVERT ：进入转换流程（不再接受写入，等待收集/合并/切片）；
-// - CONVERTED：转换完成（交由上层追加到数据层链表）。
+// - CONVERTED：转换完成且已追加到数据层链表（新鲜读据此跳过本段）；
+// - IDLE    ：已回收、在上层的复用池中等待再次启用（拒绝写入）。
 // -----------------------------------------------------------------------------
 enum class BlockStatus : uint8_t
 {
     ACTIVE,
     CONVERT,
     CONVERTED,
+    IDLE,
 };
 // -----------------------------------------------------------------------------
 // SegmentedBlock
@@ -28,23 +32,31 @@ enum class BlockStatus : uint8_t
 // 作用：
 // - 管理多线程各自的 PerThreadDataBlock（PTB），承接热写入；
 // - 当任一 PTB 写满或上层策略触发时，封印本段并进入转换；
-// - 转换阶段负责“收集 → 归并排序 → 产出有序 KV 向量”，供上层切片为 DataBlock；
+// - 转换阶段交出各 PTB 的只读区间，由上层（ConversionJob）归并并切片为 DataBlock；
 // 并发语义：
 // - 追加写入遵循“每线程独占其 PTB 槽位”的设计；
-// - 封印（seal）后不再接受写入；
+// - 封印（seal）后不再接受写入；已进入 append_ordered 的写入通过每槽位的
+//   writing_ 标志与 seal 构成 Dekker 式握手，collect_runs 会等待其退出；
 // - 状态使用原子变量，支持多线程并发读写状态标志；
+// - 段对象可被上层回收复用（recycle/activate）：持有旧指针的写线程最多看到
+//   非 ACTIVE 状态或实例编号变化而放弃本次写入，不会访问已释放的内存；
+// - 新鲜读（copy_range/find）可与写入、封印并发：PTB 指针原子发布，回收时
+//   PTB 交给 EpochManager，读者须在 EpochGuard 内调用；读到的是各 PTB 已发布
+//   的前缀，与发布到数据层的先后由上层校验；
 // 不变式（约定）：
 // - ACTIVE 阶段允许 append_ordered；CONVERT/CONVERTED 阶段拒绝写入；
 // - min_key_ 记录该段内观测到的最小 key（用于上层构建叶层有序性断言/优化）；
 // - ptb_pointers_ 中已分配槽位仅由对应线程使用；
 // 注意：
-// - 本类不直接产出 DataBlock；只负责“汇聚成有序向量”，切片由上层完成。
+// - 本类不直接产出 DataBlock；不复制数据，归并与切片由上层完成。
 // -----------------------------------------------------------------------------
 class SegmentedBlock
 {
 public:
     // ========================= 构造/析构 =========================
-    SegmentedBlock();
+    // max_entries：段内条目总数达到该值即置位 should_seal；
+    // max_ptbs   ：已分配的 PTB 数达到该值即置位 should_seal（用于按字节限制）。
+    explicit SegmentedBlock(size_t max_entries = SIZE_MAX, size_t max_ptbs = SIZE_MAX);
     ~SegmentedBlock();
 
     // ========================= 写入接口 =========================
@@ -52,26 +64,52 @@ public:
     // 约定：在单调递增工作负载下，可用作轻量断言与范围估计（更新 min_key_ 等）。
     bool append_ordered(Key k, Value v);
 
-    // ========================= 收集与排序 =========================
-    // 收集所有已分配 PTB 的数据，合并到一个 vector，并进行全局排序后返回。
-    // 说明：仅在封印后调用；返回向量用于上层切片为 DataBlock。
-    std::vector<KVPair> collect_and_sort_data();
+    // ========================= 收集 =========================
+    // 封印并等待在途写入退出后，返回各 PTB 的只读区间（不复制、不排序）。
+    // 说明：返回的指针在本段析构前有效，供 ConversionJob 协作转换。
+    std::vector<KVRun> collect_runs();
+
+    // ========================= 新鲜读（任意线程，EpochGuard 内） =========================
+    // 把尚未发布到数据层的条目中 key ∈ [l, r] 的部分追加到 out（按 PTB 依次追加，未整体排序）。
+    void copy_range(Key l, Key r, std::vector<KVPair> &out) const;
+    // 在尚未发布的条目中查找 key，命中时写 *value。
+    bool find(Key key, Value *value) const;
 
     // ========================= 状态管理 =========================
     // 将状态从 ACTIVE 置为 CONVERT（幂等）。封印后不再接受写入。
     void seal();
+    // 转换结果已追加到数据层（CONVERT → CONVERTED），之后新鲜读跳过本段。
+    void mark_converted();
 
     // 获取当前块状态（原子读）。
     BlockStatus status() const { return status_.load(std::memory_order_acquire); }
 
-    // 若返回 true，表示需要封印（由“写满”的那次写入置位，上层据此触发切段）。
+    // 若返回 true，表示需要封印（由“写满”或触及阈值的那次写入置位，上层据此触发切段）。
     bool should_seal() const noexcept { return should_seal_.load(std::memory_order_acquire); }
 
+    // ========================= 封印策略统计 =========================
+    // 段内已写入的条目总数。
+    size_t entry_count() const noexcept { return committed_count_.load(std::memory_order_relaxed); }
+    // 段内 PTB 占用的字节数（已分配 PTB 数 × PTB 大小）。
+    size_t bytes() const noexcept { return reserved_count_.load(std::memory_order_relaxed) * sizeof(PerThreadDataBlock); }
+    // 首条写入的时刻（steady_clock 纳秒）；段为空时返回 0。
+    int64_t first_write_ns() const noexcept { return first_write_ns_.load(std::memory_order_acquire); }
+
+    // ========================= 回收复用 =========================
+    // 转换完成后调用：释放所有 PTB、清空元数据并更换实例编号，状态置为 IDLE。
+    void recycle();
+    // 重新启用（IDLE → ACTIVE）；须在段对上层可见之前调用。
+    void activate();
+
 private:
     // ========================= 内部辅助 =========================
-    // 为“当前线程”分配一个专属 PTB 槽位（第一次调用时分配）。
+    // 为“当前线程”分配一个专属 PTB 槽位（第一次调用时分配，之后按线程标识找回）。
     // 返回槽位下标 [0, kMaxPTBs)，失败返回 -1。
-    int get_or_create_slot_for_this_thread_();
+    int get_or_create_slot_for_this_thread_(uint64_t id);
+    // 封印后等待所有槽位的在途写入结束。
+    void wait_for_writers_() const;
+    // 段内数据对新鲜读可见（ACTIVE 或 CONVERT）。
+    bool readable_() const noexcept;
 
     // ========================= 元数据与状态 =========================
     std::atomic<BlockStatus> status_; // 块状态：ACTIVE/CONVERT/CONVERTED
@@ -80,11 +118,29 @@ private:
 
     // ========================= PTB 分配计数 =========================
     std::atomic<size_t> reserved_count_;  // 已保留的 PTB 槽位数（分配阶段）
-    std::atomic<size_t> committed_count_; // 已提交的 PTB 槽位数（确认可用）
+    std::atomic<size_t> committed_count_; // 已写入的条目总数
+    std::atomic<int64_t> first_write_ns_; // 首条写入时刻（0 表示尚无写入）
+    const size_t max_entries_;            // 条目数阈值
+    const size_t max_ptbs_;               // PTB 数阈值
 
     // ========================= PTB 指针表 =========================
-    static constexpr size_t kMaxPTBs = 128;      // 最多支持的线程/槽位数
-    PerThreadDataBlock *ptb_pointers_[kMaxPTBs]; // 每线程数据块指针表（按槽位索引）
+    static constexpr size_t kMaxPTBs = 128; // 最多支持的线程/槽位数
+    // 每线程数据块指针表（按槽位索引，自 0 起连续分配）；原子发布供新鲜读遍历
+    std::atomic<PerThreadDataBlock *> ptb_pointers_[kMaxPTBs];
+    // 各槽位所属写线程的标识（lock_ 保护）：线程局部缓存未命中时据此找回已有槽位
+    uint64_t slot_owner_[kMaxPTBs];
+    static constexpr size_t kSlotCacheWays = 4; // 线程局部槽位缓存记住的段数
+
+    // 每槽位“写入进行中”标志，按缓存行对齐避免写线程之间伪共享
+    struct alignas(64) WriterFlag
+    {
+        std::atomic<bool> busy{false};
+    };
+    WriterFlag writing_[kMaxPTBs];
+
+    // 实例唯一编号：线程局部槽位缓存以此区分不同的段（避免地址复用误判）；
+    // recycle 时更换，写入方据此识别“段已被复用”
+    std::atomic<uint64_t> instance_id_;
 
     // ========================= 封印触发标志 =========================
     // 由“写满”的那次 append_ordered 置位；上层可据此触发切段。
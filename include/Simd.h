@@ -0,0 +1,239 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include "KVPair.h"
+
+#if defined(__AVX512F__)
+#include <immintrin.h>
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// -----------------------------------------------------------------------------
+// 键比较内核（SIMD）
+// -----------------------------------------------------------------------------
+// 作用：
+// - 统计一段键中 <= k 的个数；键非降时结果即“最后一个 <= k 的下标 + 1”，
+//   供搜索层在节点内做无分支的 floor 定位（代替逐项二分）。
+// - 所有比较彼此独立、没有数据相关的分支，节点内的各条缓存行可并行加载。
+// 实现：
+// - AVX-512：一次比较 8 个键（原生无符号比较）；
+// - AVX2   ：一次比较 4 个键（翻转符号位后用有符号比较）；
+// - 其余   ：标量累加比较结果（编译器可自动向量化）。
+// 注意：
+// - 仅依赖编译期目标指令集（-march），不做运行时分派。
+// -----------------------------------------------------------------------------
+
+// 统计 keys[0..n) 中 <= k 的个数（n 任意）
+inline std::size_t simd_count_le(const Key *keys, std::size_t n, Key k) noexcept
+{
+    std::size_t cnt = 0, i = 0;
+#if defined(__AVX512F__)
+    const __m512i kv = _mm512_set1_epi64(static_cast<long long>(k));
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m512i v = _mm512_loadu_si512(reinterpret_cast<const void *>(keys + i));
+        cnt += static_cast<std::size_t>(__builtin_popcount(_mm512_cmple_epu64_mask(v, kv)));
+    }
+#elif defined(__AVX2__)
+    const __m256i bias = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+    const __m256i kv = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(k)), bias);
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m256i v = _mm256_xor_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)), bias);
+        const int gt = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(v, kv)));
+        cnt += 4 - static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(gt)));
+    }
+#endif
+    for (; i < n; ++i)
+        cnt += static_cast<std::size_t>(keys[i] <= k);
+    return cnt;
+}
+
+// 编译期定长版本：N 为节点键数（缓存行键数的整数倍），循环完全展开
+template <std::size_t N>
+inline std::size_t simd_count_le_fixed(const Key *keys, Key k) noexcept
+{
+#if defined(__AVX512F__)
+    static_assert(N % 8 == 0, "node size must be a multiple of 8 keys");
+    const __m512i kv = _mm512_set1_epi64(static_cast<long long>(k));
+    std::size_t cnt = 0;
+    for (std::size_t i = 0; i < N; i += 8)
+    {
+        const __m512i v = _mm512_load_si512(reinterpret_cast<const void *>(keys + i));
+        cnt += static_cast<std::size_t>(__builtin_popcount(_mm512_cmple_epu64_mask(v, kv)));
+    }
+    return cnt;
+#elif defined(__AVX2__)
+    static_assert(N % 4 == 0, "node size must be a multiple of 4 keys");
+    const __m256i bias = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+    const __m256i kv = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(k)), bias);
+    std::size_t gt = 0;
+    for (std::size_t i = 0; i < N; i += 4)
+    {
+        const __m256i v = _mm256_xor_si256(
+            _mm256_load_si256(reinterpret_cast<const __m256i *>(keys + i)), bias);
+        gt += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(
+            _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(v, kv))))));
+    }
+    return N - gt;
+#else
+    std::size_t cnt = 0;
+    for (std::size_t i = 0; i < N; ++i)
+        cnt += static_cast<std::size_t>(keys[i] <= k);
+    return cnt;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// 值聚合内核（SIMD）
+// -----------------------------------------------------------------------------
+// 作用：
+// - 一次遍历一段连续的值，同时求最小值、最大值与和（降采样逐桶归约）。
+// 实现：
+// - AVX-512：原生无符号 64 位 min/max；
+// - AVX2   ：翻转符号位后用有符号比较，再按掩码混合；
+// - 其余   ：标量循环。
+// 注意：
+// - 和按 2^64 取模累加（与 Value 的无符号语义一致）。
+// -----------------------------------------------------------------------------
+
+// 把 v[0..n) 的最小值、最大值与和合并进 *mn / *mx / *sum（n 任意，可为 0）
+inline void simd_min_max_sum(const Value *v, std::size_t n, Value *mn, Value *mx, Value *sum) noexcept
+{
+    Value lo = *mn, hi = *mx, s = *sum;
+    std::size_t i = 0;
+#if defined(__AVX512F__)
+    if (n >= 8)
+    {
+        __m512i vmin = _mm512_set1_epi64(static_cast<long long>(lo));
+        __m512i vmax = _mm512_set1_epi64(static_cast<long long>(hi));
+        __m512i vsum = _mm512_setzero_si512();
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m512i x = _mm512_loadu_si512(reinterpret_cast<const void *>(v + i));
+            // 全掩码形式：直通道取已初始化的累加器（不含掩码的形式以未定义值直通）
+            vmin = _mm512_mask_min_epu64(vmin, 0xFF, vmin, x);
+            vmax = _mm512_mask_max_epu64(vmax, 0xFF, vmax, x);
+            vsum = _mm512_add_epi64(vsum, x);
+        }
+        // 逐道归约：_mm512_reduce_* 内部同样以未定义值直通，会触发 GCC 的 maybe-uninitialized 误报
+        alignas(64) Value a[8], b[8], c[8];
+        _mm512_store_si512(reinterpret_cast<void *>(a), vmin);
+        _mm512_store_si512(reinterpret_cast<void *>(b), vmax);
+        _mm512_store_si512(reinterpret_cast<void *>(c), vsum);
+        for (int j = 0; j < 8; ++j)
+        {
+            lo = a[j] < lo ? a[j] : lo;
+            hi = b[j] > hi ? b[j] : hi;
+            s += c[j];
+        }
+    }
+#elif defined(__AVX2__)
+    if (n >= 4)
+    {
+        const __m256i bias = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+        // 最小/最大值以翻转符号位后的形式保存，比较可直接用有符号指令
+        __m256i vmin = _mm256_set1_epi64x(static_cast<long long>(lo ^ 0x8000000000000000ull));
+        __m256i vmax = _mm256_set1_epi64x(static_cast<long long>(hi ^ 0x8000000000000000ull));
+        __m256i vsum = _mm256_setzero_si256();
+        for (; i + 4 <= n; i += 4)
+        {
+            const __m256i raw = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(v + i));
+            const __m256i x = _mm256_xor_si256(raw, bias);
+            vmin = _mm256_blendv_epi8(vmin, x, _mm256_cmpgt_epi64(vmin, x));
+            vmax = _mm256_blendv_epi8(vmax, x, _mm256_cmpgt_epi64(x, vmax));
+            vsum = _mm256_add_epi64(vsum, raw);
+        }
+        alignas(32) Value a[4], b[4], c[4];
+        _mm256_store_si256(reinterpret_cast<__m256i *>(a), _mm256_xor_si256(vmin, bias));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(b), _mm256_xor_si256(vmax, bias));
+        _mm256_store_si256(reinterpret_cast<__m256i *>(c), vsum);
+        for (int j = 0; j < 4; ++j)
+        {
+            lo = a[j] < lo ? a[j] : lo;
+            hi = b[j] > hi ? b[j] : hi;
+            s += c[j];
+        }
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        lo = v[i] < lo ? v[i] : lo;
+        hi = v[i] > hi ? v[i] : hi;
+        s += v[i];
+    }
+    *mn = lo;
+    *mx = hi;
+    *sum = s;
+}
+
+// -----------------------------------------------------------------------------
+// 值过滤内核（SIMD）
+// -----------------------------------------------------------------------------
+// 作用：
+// - 选出值落在 [lo, hi] 内的条目，把其键与值紧凑写出（compress-store），
+//   只复制命中项，输出保持原顺序。
+// 实现：
+// - 区间判定化为一次无符号比较：v - lo <= hi - lo（按 2^64 回绕）；
+// - AVX-512：比较得掩码后用 compressstore 直接写出命中的通道；
+// - AVX2   ：按 4 位掩码查表得到置换，把命中通道移到低位后整体写出 4 个，
+//            再按命中数前进（多写的通道随后被覆盖，不越过第 n 个输出位置）；
+// - 其余   ：标量无分支写出（先写后按是否命中前进）。
+// -----------------------------------------------------------------------------
+
+// keys/vals[0..n) 中值在 [lo, hi] 内（要求 lo <= hi）的条目依次写入 out_keys/out_vals
+// （各至少 n 个），返回命中数
+inline std::size_t simd_filter_range(const Key *keys, const Value *vals, std::size_t n, Value lo, Value hi,
+                                     Key *out_keys, Value *out_vals) noexcept
+{
+    const Value span = hi - lo;
+    std::size_t hits = 0, i = 0;
+#if defined(__AVX512F__)
+    const __m512i vlo = _mm512_set1_epi64(static_cast<long long>(lo));
+    const __m512i vspan = _mm512_set1_epi64(static_cast<long long>(span));
+    for (; i + 8 <= n; i += 8)
+    {
+        const __m512i v = _mm512_loadu_si512(reinterpret_cast<const void *>(vals + i));
+        const __mmask8 m = _mm512_cmple_epu64_mask(_mm512_sub_epi64(v, vlo), vspan);
+        if (m == 0)
+            continue;
+        const __m512i k = _mm512_loadu_si512(reinterpret_cast<const void *>(keys + i));
+        _mm512_mask_compressstoreu_epi64(out_keys + hits, m, k);
+        _mm512_mask_compressstoreu_epi64(out_vals + hits, m, v);
+        hits += static_cast<std::size_t>(__builtin_popcount(m));
+    }
+#elif defined(__AVX2__)
+    // 第 m 项：把掩码 m 中为 1 的 64 位通道依次移到低位（以 32 位下标表示）
+    alignas(32) static constexpr int kCompress4[16][8] = {
+        {0, 1, 0, 1, 0, 1, 0, 1}, {0, 1, 0, 1, 0, 1, 0, 1}, {2, 3, 0, 1, 0, 1, 0, 1}, {0, 1, 2, 3, 0, 1, 0, 1},
+        {4, 5, 0, 1, 0, 1, 0, 1}, {0, 1, 4, 5, 0, 1, 0, 1}, {2, 3, 4, 5, 0, 1, 0, 1}, {0, 1, 2, 3, 4, 5, 0, 1},
+        {6, 7, 0, 1, 0, 1, 0, 1}, {0, 1, 6, 7, 0, 1, 0, 1}, {2, 3, 6, 7, 0, 1, 0, 1}, {0, 1, 2, 3, 6, 7, 0, 1},
+        {4, 5, 6, 7, 0, 1, 0, 1}, {0, 1, 4, 5, 6, 7, 0, 1}, {2, 3, 4, 5, 6, 7, 0, 1}, {0, 1, 2, 3, 4, 5, 6, 7}};
+    const __m256i bias = _mm256_set1_epi64x(static_cast<long long>(0x8000000000000000ull));
+    const __m256i vlo = _mm256_set1_epi64x(static_cast<long long>(lo));
+    const __m256i vspan = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<long long>(span)), bias);
+    for (; i + 4 <= n; i += 4)
+    {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(vals + i));
+        const __m256i d = _mm256_xor_si256(_mm256_sub_epi64(v, vlo), bias);
+        const int out = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(d, vspan)));
+        const int m = ~out & 0xF;
+        if (m == 0)
+            continue;
+        const __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i *>(kCompress4[m]));
+        const __m256i k = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out_keys + hits), _mm256_permutevar8x32_epi32(k, perm));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out_vals + hits), _mm256_permutevar8x32_epi32(v, perm));
+        hits += static_cast<std::size_t>(__builtin_popcount(static_cast<unsigned>(m)));
+    }
+#endif
+    for (; i < n; ++i)
+    {
+        out_keys[hits] = keys[i];
+        out_vals[hits] = vals[i];
+        hits += static_cast<std::size_t>(vals[i] - lo <= span);
+    }
+    return hits;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "KVPair.h"
+#include "SBTree.h"
+
+// -----------------------------------------------------------------------------
+// BasicSBTree<SingleWriter>（即 SingleWriterSBTree）
+// -----------------------------------------------------------------------------
+// 作用：
+//   - 每个分片只有一个写入线程时使用的特化版本：写入直接追加到一个私有缓冲，
+//     缓冲满（或触及封印阈值）时在本线程就地转换为 DataBlock run，
+//     再经 SBTreeBase::publish_run_ 发布给读者（数据层锁 + 索引队列，与多写版本一致）。
+//   - 写路径不查线程局部槽位、不做状态 CAS、不切换 shortcut_、不取段锁；
+//     每次 insert 仅有水位与定时标志两次 relaxed 读。
+// 并发语义：
+//   - insert/flush 必须由同一个线程调用（或由调用方保证互斥）；
+//   - 查询接口可由任意线程并发调用，只看到已发布的 run。
+// 封印策略：
+//   - seal_max_entries / seal_max_bytes 换算为缓冲条目上限（默认一个 PTB 的容量）；
+//   - seal_max_age：索引线程只置位定时标志，由写线程在下一次 insert 时检查
+//     缓冲时长并转换；写线程空闲期间需调用 flush() 才能让缓冲可见。
+// -----------------------------------------------------------------------------
+template <>
+class BasicSBTree<SingleWriter> : public SBTreeBase
+{
+public:
+    // ========================= 构造/析构 =========================
+    explicit BasicSBTree(const SBTreeOptions &opts = SBTreeOptions{});
+    ~BasicSBTree() override;
+
+    // ========================= 基本操作接口（仅写线程） =========================
+    void insert(Key key, Value value); // 插入（单调 key 追加到缓冲，迟到 key 按乱序窗口处理）
+    void flush();                      // 转换缓冲 → 数据块
+
+protected:
+    void on_index_tick_() override; // 时间阈值：请求写线程检查缓冲时长
+
+private:
+    void seal_buffer_(); // 就地转换缓冲并发布
+
+    std::vector<KVPair> buf_;           // 热写入缓冲（仅写线程访问）
+    size_t limit_;                      // 缓冲条目上限
+    int64_t first_write_ns_ = 0;        // 缓冲首条写入时刻（仅启用时间阈值时记录）
+    std::atomic<bool> tick_{false};     // 索引线程置位，写线程消费
+};
+
+using SingleWriterSBTree = BasicSBTree<SingleWriter>;
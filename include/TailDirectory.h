@@ -0,0 +1,60 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <deque>
+#include <vector>
+#include "KVPair.h"
+
+class DataBlock; // 前向声明
+
+// -----------------------------------------------------------------------------
+// TailDirectory
+// -----------------------------------------------------------------------------
+// 作用：
+// - 记录数据层链表上最新的 K 个 DataBlock 及其 min_key，供查询在 key 落在
+//   最近数据范围内时直接定位 floor 块，跳过快照加载与搜索层下降；
+// - 块在挂链时即登记，不必等后台索引线程追加到搜索层。
+// 并发语义：
+// - 写侧（on_append/on_replace/publish）由调用方在数据层锁内调用；
+// - 读侧 find() 可与写侧并发：目录以不可变对象整体发布（原子指针），
+//   读者在 EpochGuard 内读取，旧目录交给 EpochManager 回收；
+// - 目录中的块被替换后由树交给 EpochManager 回收：调用方须在自己的
+//   EpochGuard（或 EpochPin）内调用 find() 并使用返回的块。
+// 不变式：
+// - 目录为链表的一个后缀：块按链序排列，min_key 非降。
+// -----------------------------------------------------------------------------
+class TailDirectory
+{
+public:
+    explicit TailDirectory(std::size_t capacity); // capacity == 0 表示禁用
+    ~TailDirectory();
+
+    TailDirectory(const TailDirectory &) = delete;
+    TailDirectory &operator=(const TailDirectory &) = delete;
+
+    // ========================= 写侧（数据层锁内） =========================
+    void on_append(const std::vector<DataBlock *> &blocks);            // 新 run 挂到链尾
+    // old（及紧随其后的 absorbed，可空）被 [first..last] 替换
+    void on_replace(DataBlock *old, DataBlock *first, DataBlock *last, DataBlock *absorbed = nullptr);
+    void publish();                                                     // 发布当前目录
+
+    // ========================= 读侧（任意线程） =========================
+    // k 不小于目录首块 min_key 时返回目录内“最后一个 min_key <= k”的块，否则 nullptr。
+    DataBlock *find(Key k) const noexcept;
+
+    std::size_t capacity() const noexcept { return capacity_; }
+
+private:
+    struct Dir
+    {
+        std::vector<Key> keys;           // 各块 min_key（发布时读取）
+        std::vector<DataBlock *> blocks; // 与 keys 对齐
+    };
+
+    void trim_(); // 只保留最新的 capacity_ 个块
+
+    const std::size_t capacity_;
+    std::deque<DataBlock *> recent_;  // 写侧：链尾最新的块
+    bool dirty_ = false;              // 自上次发布以来是否有变化
+    std::atomic<Dir *> dir_{nullptr}; // 已发布目录（读者在纪元临界区内读取）
+};
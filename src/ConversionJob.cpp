@@ -0,0 +1,287 @@
+#include "ConversionJob.h"
+#include "DataBlock.h"
+#include "RunMerge.h"
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+// ========================= 构造/析构 =========================
+ConversionJob::ConversionJob(std::vector<KVRun> runs)
+    : runs_(std::move(runs))
+{
+    runs_.erase(std::remove_if(runs_.begin(), runs_.end(),
+                               [](const KVRun &r)
+                               { return r.n == 0; }),
+                runs_.end());
+    owned_.resize(runs_.size());
+    for (const auto &r : runs_)
+        total_ += r.n;
+    range_entries_ = DataBlock::capacity() * kBlocksPerRange;
+    num_ranges_ = (total_ + range_entries_ - 1) / range_entries_;
+}
+
+ConversionJob::~ConversionJob()
+{
+    for (auto &blocks : out_)
+        for (auto *b : blocks)
+            delete b;
+}
+
+// ========================= 阶段控制 =========================
+std::size_t ConversionJob::begin_phase(Phase p)
+{
+    phase_ = p;
+    switch (p)
+    {
+    case Phase::SORT_RUNS:
+        return runs_.size();
+    case Phase::BUILD_RANGES:
+        out_.assign(num_ranges_, {});
+        return num_ranges_;
+    default:
+        return 0;
+    }
+}
+
+void ConversionJob::run_task(std::size_t idx)
+{
+    if (phase_ == Phase::SORT_RUNS)
+        sort_run_(idx);
+    else if (phase_ == Phase::BUILD_RANGES)
+        build_range_(idx);
+}
+
+void ConversionJob::run_all()
+{
+    for (auto p : {Phase::SORT_RUNS, Phase::BUILD_RANGES})
+    {
+        const std::size_t n = begin_phase(p);
+        for (std::size_t i = 0; i < n; ++i)
+            run_task(i);
+    }
+    begin_phase(Phase::DONE);
+}
+
+// ========================= 结果 =========================
+std::vector<DataBlock *> ConversionJob::take_blocks()
+{
+    std::vector<DataBlock *> all;
+    all.reserve((total_ + DataBlock::capacity() - 1) / DataBlock::capacity());
+    for (auto &blocks : out_)
+    {
+        for (auto *b : blocks)
+        {
+            if (!all.empty())
+                all.back()->set_next(b);
+            all.push_back(b);
+        }
+        blocks.clear();
+    }
+    return all;
+}
+
+// ========================= 任务：run 排序 =========================
+// 单调写入下各 run 天然有序，只做一次线性检查；否则复制一份做 LSD 基数排序。
+void ConversionJob::sort_run_(std::size_t i)
+{
+    KVRun &r = runs_[i];
+    const bool sorted = std::is_sorted(r.data, r.data + r.n,
+                                       [](const KVPair &a, const KVPair &b)
+                                       { return a.key < b.key; });
+    if (sorted)
+        return;
+    owned_[i].resize(r.n);
+    std::vector<KVPair> tmp(r.n);
+    radix_sort_by_key(r.data, r.n, owned_[i].data(), tmp.data());
+    r.data = owned_[i].data();
+}
+
+// ========================= 任务：区间构建 =========================
+// 用败者树归并各 run 在本区间内的切片，结果直接流式写入 DataBlock 的
+// keys_/vals_，不经过中间 vector。
+void ConversionJob::build_range_(std::size_t j)
+{
+    const std::size_t lo_rank = j * range_entries_;
+    const std::size_t hi_rank = std::min(total_, lo_rank + range_entries_);
+
+    std::vector<std::size_t> lo_pos, hi_pos;
+    split_at_rank_(lo_rank, lo_pos);
+    split_at_rank_(hi_rank, hi_pos);
+
+    std::vector<KVRun> slices;
+    slices.reserve(runs_.size());
+    for (std::size_t i = 0; i < runs_.size(); ++i)
+        if (hi_pos[i] > lo_pos[i])
+            slices.push_back({runs_[i].data + lo_pos[i], hi_pos[i] - lo_pos[i]});
+
+    auto &blocks = out_[j];
+    if (slices.size() == 1)
+    {
+        // 单一 run：无需归并，按块容量直接切片
+        const KVPair *cur = slices[0].data;
+        std::size_t remaining = slices[0].n;
+        while (remaining > 0)
+        {
+            DataBlock *b = new DataBlock();
+            std::size_t consumed = b->build_from_sorted(cur, remaining);
+            blocks.push_back(b);
+            cur += consumed;
+            remaining -= consumed;
+        }
+        return;
+    }
+
+    LoserTree lt(slices);
+    DataBlock *b = nullptr;
+    std::size_t emitted = 0;
+    while (!lt.empty())
+    {
+        if (!b || b->full())
+        {
+            if (b)
+                b->finish_build();
+            b = new DataBlock();
+            blocks.push_back(b);
+        }
+        const KVPair &e = lt.top();
+        b->push_sorted(e.key, e.value);
+        lt.pop();
+        ++emitted;
+    }
+    if (b)
+        b->finish_build();
+    assert(emitted == hi_rank - lo_rank);
+    (void)emitted;
+}
+
+// 在各有序 run 上按全局秩切分：先二分出第 rank 个元素的 key，
+// 再把等于该 key 的元素按 run 顺序补足，保证切分唯一且确定。
+void ConversionJob::split_at_rank_(std::size_t rank, std::vector<std::size_t> &pos) const
+{
+    const std::size_t k = runs_.size();
+    pos.assign(k, 0);
+    if (rank == 0)
+        return;
+    if (rank >= total_)
+    {
+        for (std::size_t i = 0; i < k; ++i)
+            pos[i] = runs_[i].n;
+        return;
+    }
+
+    auto key_less = [](const KVPair &a, Key b)
+    { return a.key < b; };
+    auto key_greater = [](Key a, const KVPair &b)
+    { return a < b.key; };
+
+    auto count_le = [&](Key x)
+    {
+        std::size_t c = 0;
+        for (const auto &r : runs_)
+            c += std::upper_bound(r.data, r.data + r.n, x, key_greater) - r.data;
+        return c;
+    };
+
+    Key lo = runs_[0].data[0].key, hi = runs_[0].data[runs_[0].n - 1].key;
+    for (const auto &r : runs_)
+    {
+        lo = std::min(lo, r.data[0].key);
+        hi = std::max(hi, r.data[r.n - 1].key);
+    }
+    // 最小的 x 使得 count_le(x) >= rank
+    while (lo < hi)
+    {
+        Key mid = lo + ((hi - lo) >> 1);
+        if (count_le(mid) >= rank)
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+
+    std::size_t taken = 0;
+    for (std::size_t i = 0; i < k; ++i)
+    {
+        const KVRun &r = runs_[i];
+        pos[i] = std::lower_bound(r.data, r.data + r.n, lo, key_less) - r.data;
+        taken += pos[i];
+    }
+    std::size_t need = rank - taken;
+    for (std::size_t i = 0; i < k && need > 0; ++i)
+    {
+        const KVRun &r = runs_[i];
+        std::size_t eq = (std::upper_bound(r.data, r.data + r.n, lo, key_greater) - r.data) - pos[i];
+        std::size_t take = std::min(eq, need);
+        pos[i] += take;
+        need -= take;
+    }
+    assert(need == 0);
+}
+
+// ========================= 协作调度 =========================
+void ConversionCoordinator::run(ConversionJob &job)
+{
+    bool expected = false;
+    const bool cooperative = busy_.compare_exchange_strong(expected, true,
+                                                           std::memory_order_acquire);
+    for (auto p : {ConversionJob::Phase::SORT_RUNS, ConversionJob::Phase::BUILD_RANGES})
+    {
+        const std::size_t n = job.begin_phase(p);
+        // 任务过少或已有协作任务在发布时，直接串行执行
+        if (!cooperative || n <= 1 || n > kMaxTasks)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+                job.run_task(i);
+            continue;
+        }
+
+        job_ = &job;
+        done_.store(0, std::memory_order_relaxed);
+        ++gen_;
+        claim_.store(pack_(gen_, 0, static_cast<uint32_t>(n)), std::memory_order_release);
+
+        uint32_t idx;
+        while (claim_one_(idx))
+        {
+            job.run_task(idx);
+            done_.fetch_add(1, std::memory_order_release);
+        }
+        while (done_.load(std::memory_order_acquire) < n)
+            std::this_thread::yield();
+    }
+    job.begin_phase(ConversionJob::Phase::DONE);
+
+    if (cooperative)
+    {
+        job_ = nullptr;
+        busy_.store(false, std::memory_order_release);
+    }
+}
+
+bool ConversionCoordinator::help()
+{
+    uint32_t idx;
+    if (!claim_one_(idx))
+        return false;
+    // 领取成功后，发起者会等待本任务完成，job_ 在此期间保持有效
+    job_->run_task(idx);
+    done_.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+bool ConversionCoordinator::claim_one_(uint32_t &idx)
+{
+    uint64_t w = claim_.load(std::memory_order_acquire);
+    for (;;)
+    {
+        const uint32_t next = next_of_(w), total = total_of_(w);
+        if (next >= total)
+            return false;
+        const uint64_t nw = pack_(uint32_t(w >> 32), next + 1, total);
+        if (claim_.compare_exchange_weak(w, nw, std::memory_order_acq_rel,
+                                         std::memory_order_acquire))
+        {
+            idx = next;
+            return true;
+        }
+    }
+}
@@ -1,4 +1,5 @@
 #include "DataBlock.h"
+#include "Simd.h"
 
 // ========================= 构造 =========================
 DataBlock::DataBlock()
@@ -25,10 +26,20 @@ size_t DataBlock::build_from_sorted(const KVPair *src, size_t n)
         vals_[i] = src[i].value;
     }
     count_ = static_cast<uint32_t>(take);
-    if (take > 0)
+    finish_build();
+    return take; // 如果 n > kCapacity，需要调用方继续切块
+}
+
+// 增量构建收尾：刷新块内最小 key、值的最小/最大值与 N-ary 表
+void DataBlock::finish_build()
+{
+    if (count_ > 0)
         min_key_ = keys_[0];
+    vmin_ = std::numeric_limits<Value>::max();
+    vmax_ = 0;
+    Value sum = 0;
+    simd_min_max_sum(vals_, count_, &vmin_, &vmax_, &sum);
     build_nary_();
-    return take; // 如果 n > kCapacity，需要调用方继续切块
 }
 
 // ========================= 查找 =========================
@@ -51,6 +62,45 @@ bool DataBlock::find(Key k, Value &out) const
     return false;
 }
 
+void DataBlock::prefetch_find(Key k) const noexcept
+{
+    if (count_ == 0 || k < min_key_)
+        return;
+    auto [lo, hi] = bucket_range_(k);
+    constexpr size_t kPerLine = kCacheLine / sizeof(Key);
+    for (size_t i = lo; i < hi; i += kPerLine)
+    {
+        __builtin_prefetch(keys_ + i, 0, 3);
+        __builtin_prefetch(vals_ + i, 0, 3);
+    }
+}
+
+void DataBlock::prefetch_tail() const noexcept
+{
+    constexpr size_t kPerLine = kCacheLine / sizeof(Key);
+    const size_t lo = count_ > kPrefetchLines * kPerLine ? count_ - kPrefetchLines * kPerLine : 0;
+    for (size_t i = lo; i < count_; i += kPerLine)
+    {
+        __builtin_prefetch(keys_ + i, 0, 3);
+        __builtin_prefetch(vals_ + i, 0, 3);
+    }
+}
+
+// 块内二分：第一个 key >= k 的位置
+size_t DataBlock::lower_bound(Key k) const
+{
+    size_t L = 0, R = count_;
+    while (L < R)
+    {
+        size_t mid = L + ((R - L) >> 1);
+        if (keys_[mid] < k)
+            L = mid + 1;
+        else
+            R = mid;
+    }
+    return L;
+}
+
 // ========================= 扫描 =========================
 // 从 startKey 开始扫描最多 count 条数据
 size_t DataBlock::scan_from(Key startKey, size_t count, std::vector<Value> &out) const
@@ -0,0 +1,138 @@
+#include "EpochManager.h"
+#include <thread>
+
+// ========================= 线程私有记录 =========================
+struct EpochManager::SlotOwner
+{
+    Slot *slot = nullptr;
+    ~SlotOwner()
+    {
+        if (slot)
+            EpochManager::release_slot_(slot);
+    }
+};
+
+EpochManager &EpochManager::instance()
+{
+    static EpochManager mgr;
+    return mgr;
+}
+
+EpochManager::Slot *EpochManager::register_thread_()
+{
+    static thread_local SlotOwner owner;
+    owner.slot = acquire_slot_();
+    return owner.slot;
+}
+
+EpochManager::~EpochManager()
+{
+    // 进程退出：不再有读者，释放剩余回收项（槽位可能仍被线程私有指针引用，保留）
+    for (auto &r : retired_)
+        r.deleter(r.p);
+    retired_.clear();
+}
+
+// ========================= 槽位管理 =========================
+// 优先复用已归还的槽位，否则新建并压入链表头
+EpochManager::Slot *EpochManager::acquire_slot_()
+{
+    for (Slot *s = slots_.load(std::memory_order_acquire); s; s = s->next)
+    {
+        bool expected = false;
+        if (!s->in_use.load(std::memory_order_relaxed) &&
+            s->in_use.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+            return s;
+    }
+    Slot *s = new Slot();
+    s->in_use.store(true, std::memory_order_relaxed);
+    Slot *head = slots_.load(std::memory_order_relaxed);
+    do
+    {
+        s->next = head;
+    } while (!slots_.compare_exchange_weak(head, s, std::memory_order_release,
+                                           std::memory_order_relaxed));
+    return s;
+}
+
+// 独占槽位：沿用当前线程临界区的纪元（更早，覆盖其中取得的指针），否则取全局纪元
+EpochManager::Slot *EpochManager::pin_()
+{
+    Slot *s = acquire_slot_();
+    const uint64_t e = tl_depth_ > 0 ? tl_slot_->epoch.load(std::memory_order_relaxed)
+                                     : global_.load(std::memory_order_relaxed);
+    s->epoch.store(e, std::memory_order_seq_cst);
+    return s;
+}
+
+void EpochManager::release_slot_(Slot *s)
+{
+    s->epoch.store(0, std::memory_order_release);
+    s->in_use.store(false, std::memory_order_release);
+}
+
+// ========================= 写者 =========================
+void EpochManager::retire_raw_(void *p, void (*deleter)(void *))
+{
+    std::vector<Retired> ready;
+    {
+        std::lock_guard<std::mutex> g(mu_);
+        retired_.push_back(Retired{global_.load(std::memory_order_seq_cst), p, deleter});
+        try_advance_locked_();
+        reclaim_locked_(ready);
+    }
+    // 在锁外释放：deleter 可能再次退役对象
+    for (auto &r : ready)
+        r.deleter(r.p);
+}
+
+bool EpochManager::try_advance_locked_()
+{
+    uint64_t e = global_.load(std::memory_order_seq_cst);
+    for (Slot *s = slots_.load(std::memory_order_acquire); s; s = s->next)
+    {
+        const uint64_t se = s->epoch.load(std::memory_order_seq_cst);
+        if (se != 0 && se != e)
+            return false; // 仍有读者停留在更早的纪元
+    }
+    return global_.compare_exchange_strong(e, e + 1, std::memory_order_seq_cst);
+}
+
+void EpochManager::reclaim_locked_(std::vector<Retired> &out)
+{
+    const uint64_t e = global_.load(std::memory_order_seq_cst);
+    size_t n = 0;
+    while (n < retired_.size() && retired_[n].epoch + 2 <= e)
+        ++n;
+    if (n == 0)
+        return;
+    out.assign(retired_.begin(), retired_.begin() + n);
+    retired_.erase(retired_.begin(), retired_.begin() + n);
+}
+
+void EpochManager::synchronize()
+{
+    std::vector<Retired> ready;
+    {
+        std::unique_lock<std::mutex> lk(mu_);
+        const uint64_t target = global_.load(std::memory_order_seq_cst) + 2;
+        while (global_.load(std::memory_order_seq_cst) < target)
+        {
+            if (!try_advance_locked_())
+            {
+                lk.unlock();
+                std::this_thread::yield();
+                lk.lock();
+            }
+        }
+        reclaim_locked_(ready);
+    }
+    for (auto &r : ready)
+        r.deleter(r.p);
+}
+
+size_t EpochManager::pending() const
+{
+    std::lock_guard<std::mutex> g(mu_);
+    return retired_.size();
+}
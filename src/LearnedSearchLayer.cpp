@@ -0,0 +1,398 @@
+#include "LearnedSearchLayer.h"
+#include "DataBlock.h"
+#include "SearchLayer.h"
+#include "EpochManager.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cassert>
+
+// ========================= 构造/析构 =========================
+LearnedSearchLayer::LearnedSearchLayer(std::size_t epsilon)
+    : eps_(epsilon)
+{
+    snapshot_.store(new Snapshot(), std::memory_order_seq_cst);
+}
+
+// 析构时已无读者：当前快照直接释放，已退役的旧快照由 EpochManager 释放
+LearnedSearchLayer::~LearnedSearchLayer()
+{
+    delete snapshot_.exchange(nullptr);
+}
+
+// ========================= 分段构建 =========================
+// 收缩锥：开放段首点为 (open_key_, open_pos_)，对每个新叶子 (k, y)，
+// 斜率须落在 [(y-open_pos_-eps)/dx, (y-open_pos_+eps)/dx] 内（dx = k-open_key_）；
+// 与已有区间求交为空则封闭开放段，新叶子成为下一段首点。
+// 与首点同键的叶子只要求 y - open_pos_ <= eps（预测值恒为 open_pos_）。
+void LearnedSearchLayer::add_leaf_(Key k)
+{
+    const std::size_t y = keys_.size() - 1;
+    if (y == 0)
+    {
+        open_key_ = k;
+        open_pos_ = 0;
+        slope_lo_ = slope_hi_ = 0.0;
+        slope_bounded_ = false;
+        return;
+    }
+
+    if (k == open_key_)
+    {
+        if (y - open_pos_ <= eps_)
+            return;
+    }
+    else
+    {
+        const double dx = static_cast<double>(k - open_key_);
+        const double dy = static_cast<double>(y - open_pos_);
+        const double eps = static_cast<double>(eps_);
+        const double lo = std::max(slope_lo_, (dy - eps) / dx);
+        const double hi = slope_bounded_ ? std::min(slope_hi_, (dy + eps) / dx) : (dy + eps) / dx;
+        if (lo <= hi)
+        {
+            slope_lo_ = lo;
+            slope_hi_ = hi;
+            slope_bounded_ = true;
+            return;
+        }
+    }
+
+    seg_keys_.push_back(open_key_);
+    segs_.push_back(Segment{open_key_, open_pos_, open_slope_()});
+    open_key_ = k;
+    open_pos_ = y;
+    slope_lo_ = slope_hi_ = 0.0;
+    slope_bounded_ = false;
+}
+
+double LearnedSearchLayer::open_slope_() const
+{
+    return slope_bounded_ ? (slope_lo_ + slope_hi_) * 0.5 : slope_lo_;
+}
+
+// ========================= 快照维护 =========================
+void LearnedSearchLayer::publish_snapshot_()
+{
+    auto *snap = new Snapshot();
+    snap->l0_size = keys_.size();
+    snap->closed = segs_.size();
+    snap->open = Segment{open_key_, open_pos_, open_slope_()};
+
+    Snapshot *prev = snapshot_.exchange(snap, std::memory_order_seq_cst);
+    for (auto &c : pending_garbage_)
+        prev->garbage.push_back(std::move(c));
+    pending_garbage_.clear();
+    for (auto &c : pending_count_garbage_)
+        prev->count_garbage.push_back(std::move(c));
+    pending_count_garbage_.clear();
+    EpochManager::instance().retire(prev);
+}
+
+std::size_t LearnedSearchLayer::levels_snapshot() const noexcept
+{
+    EpochGuard guard;
+    const Snapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    return (snap && snap->l0_size > 0) ? 2u : 0u;
+}
+
+// ========================= 追加 =========================
+void LearnedSearchLayer::append_run(const std::vector<DataBlock *> &blocks)
+{
+    std::vector<std::uint64_t> counts;
+    counts.reserve(blocks.size());
+    for (auto *b : blocks)
+        counts.push_back(b->size());
+    append_run(blocks, counts);
+}
+
+void LearnedSearchLayer::append_run(const std::vector<DataBlock *> &blocks,
+                                    const std::vector<std::uint64_t> &counts)
+{
+    if (blocks.empty())
+        return;
+    assert(counts.size() == blocks.size());
+#ifndef NDEBUG
+    if (!keys_.empty())
+        assert(keys_.back() <= blocks.front()->min_key());
+    for (std::size_t i = 1; i < blocks.size(); ++i)
+        assert(blocks[i - 1]->min_key() <= blocks[i]->min_key());
+#endif
+    for (std::size_t i = 0; i < blocks.size(); ++i)
+    {
+        keys_.push_back(blocks[i]->min_key());
+        leaves_.push_back(blocks[i]);
+        counts_.push_back(counts[i]);
+        add_leaf_(blocks[i]->min_key());
+    }
+    publish_snapshot_();
+}
+
+// ========================= 替换 =========================
+// 叶层键不变（与 SearchLayer::replace_leaf 相同），段参数无需调整
+bool LearnedSearchLayer::replace_leaf(DataBlock *old, DataBlock *repl, std::uint64_t added,
+                                      std::size_t *pos)
+{
+    const Key k = old->min_key();
+    std::size_t L = 0, R = keys_.size();
+    while (L < R)
+    {
+        std::size_t mid = L + ((R - L) >> 1);
+        if (keys_[mid] < k)
+            L = mid + 1;
+        else
+            R = mid;
+    }
+    for (std::size_t i = L; i < keys_.size() && keys_[i] == k; ++i)
+    {
+        if (leaves_[i] == old)
+            return replace_at_(i, repl, added, pos);
+    }
+    // 表头块被替换后其 min_key 可能小于叶层记录值（叶层键保持不变）
+    if (!keys_.empty() && leaves_[0] == old)
+        return replace_at_(0, repl, added, pos);
+    return false;
+}
+
+bool LearnedSearchLayer::replace_at_(std::size_t i, DataBlock *repl, std::uint64_t added,
+                                     std::size_t *pos)
+{
+    pending_garbage_.push_back(leaves_.replace(i, repl));
+    counts_.add(i, added, pending_count_garbage_);
+    if (pos)
+        *pos = i;
+    return true;
+}
+
+void LearnedSearchLayer::add_count(std::size_t leaf, std::uint64_t added)
+{
+    assert(leaf < leaves_.size());
+    counts_.add(leaf, added, pending_count_garbage_);
+}
+
+void LearnedSearchLayer::publish()
+{
+    if (!pending_garbage_.empty() || !pending_count_garbage_.empty())
+        publish_snapshot_();
+}
+
+// ========================= 查找 =========================
+std::size_t LearnedSearchLayer::floor_in_(std::size_t lo, std::size_t hi, Key k) const noexcept
+{
+    std::size_t c = 0;
+    if (const Key *p = keys_.contiguous(lo, hi))
+        c = simd_count_le(p, hi - lo, k);
+    else
+        for (std::size_t i = lo; i < hi; ++i)
+            c += static_cast<std::size_t>(keys_[i] <= k);
+    return lo + c - 1;
+}
+
+bool LearnedSearchLayer::predict_(const Snapshot &snap, Key k, Window *w) const noexcept
+{
+    // 1) 定位段：最后一个首键 <= k 的段（开放段优先，常见于最近数据）
+    Segment seg;
+    std::size_t end;
+    if (k >= snap.open.key)
+    {
+        seg = snap.open;
+        end = snap.l0_size;
+    }
+    else
+    {
+        if (snap.closed == 0 || k < seg_keys_[0])
+            return false;
+        std::size_t L = 0, R = snap.closed;
+        while (R - L > 1)
+        {
+            const std::size_t mid = L + ((R - L) >> 1);
+            if (seg_keys_[mid] <= k)
+                L = mid;
+            else
+                R = mid;
+        }
+        seg = segs_[L];
+        end = (L + 1 < snap.closed) ? segs_[L + 1].pos : snap.open.pos;
+    }
+
+    // 2) 模型预测 + 有界窗口：真实 floor 距预测不超过 eps+1，另留 1 的取整余量
+    const double p = static_cast<double>(seg.pos) + seg.slope * static_cast<double>(k - seg.key);
+    const std::size_t pred =
+        p >= static_cast<double>(end - 1) ? end - 1 : std::max(seg.pos, static_cast<std::size_t>(p));
+    const std::size_t r = eps_ + 2;
+    w->seg_pos = seg.pos;
+    w->end = end;
+    w->lo = pred > seg.pos + r ? pred - r : seg.pos;
+    w->hi = std::min(end, pred + r + 1);
+    return true;
+}
+
+std::size_t LearnedSearchLayer::resolve_(const Window &w, Key k) const noexcept
+{
+    // 3) 窗口两端须包住答案，否则（浮点误差等）回退到段内二分
+    if (keys_[w.lo] <= k && (w.hi == w.end || keys_[w.hi] > k))
+        return floor_in_(w.lo, w.hi, k);
+
+    std::size_t L = w.seg_pos, R = w.end;
+    while (R - L > 1)
+    {
+        const std::size_t mid = L + ((R - L) >> 1);
+        if (keys_[mid] <= k)
+            L = mid;
+        else
+            R = mid;
+    }
+    return L;
+}
+
+std::size_t LearnedSearchLayer::floor_index_(const Snapshot &snap, Key k) const noexcept
+{
+    Window w;
+    return predict_(snap, k, &w) ? resolve_(w, k) : static_cast<std::size_t>(-1);
+}
+
+DataBlock *LearnedSearchLayer::find_candidate(Key k) const noexcept
+{
+    EpochGuard guard;
+    const Snapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    if (!snap || snap->l0_size == 0)
+        return nullptr;
+    const std::size_t idx = floor_index_(*snap, k);
+    return idx == static_cast<std::size_t>(-1) ? nullptr : leaves_[idx];
+}
+
+// 叶层自提示指数搜索与 SearchLayer 相同，远跳时退回段定位
+DataBlock *LearnedSearchLayer::find_candidate_near(Key k, std::size_t *leaf) const noexcept
+{
+    const auto npos = static_cast<std::size_t>(-1);
+    EpochGuard guard;
+    const Snapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    if (!snap || snap->l0_size == 0)
+    {
+        *leaf = npos;
+        return nullptr;
+    }
+    std::size_t idx = SearchLayer::gallop_floor(keys_, snap->l0_size, *leaf, k);
+    if (idx == npos)
+        idx = floor_index_(*snap, k);
+    *leaf = idx;
+    return idx == npos ? nullptr : leaves_[idx];
+}
+
+// ========================= 批量查询 =========================
+// 与 SearchLayer::find_candidates 相同的分组方式：近邻 key 直接在叶层上定位，
+// 其余每组先全部做模型预测并预取各自的窗口，再逐个在窗口内求解并预取叶层指针
+void LearnedSearchLayer::find_candidates(const Key *keys, std::size_t n, DataBlock **out) const noexcept
+{
+    const auto npos = static_cast<std::size_t>(-1);
+    constexpr std::size_t kLanes = SearchLayer::kBatchLanes;
+    constexpr std::size_t kPerLine = 64 / sizeof(Key);
+    EpochGuard guard;
+    const Snapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    const std::size_t n0 = snap ? snap->l0_size : 0;
+
+    std::size_t lane_key[kLanes];
+    Window lane_win[kLanes];
+    std::size_t last = npos;
+    for (std::size_t i = 0; i < n;)
+    {
+        std::size_t m = 0;
+        for (; i < n && m < kLanes; ++i)
+        {
+            const Key k = keys[i];
+            if (last != npos)
+            {
+                const std::size_t h = SearchLayer::gallop_floor(keys_, n0, last, k, SearchLayer::kBatchNear);
+                if (h != npos)
+                {
+                    out[i] = leaves_[h];
+                    last = h;
+                    continue;
+                }
+            }
+            if (n0 == 0 || !predict_(*snap, k, &lane_win[m]))
+            {
+                out[i] = nullptr;
+                continue;
+            }
+            const Window &w = lane_win[m];
+            for (std::size_t j = w.lo; j <= w.hi && j < w.end; j += kPerLine)
+                __builtin_prefetch(&keys_[j], 0, 3);
+            lane_key[m++] = i;
+        }
+
+        std::size_t lane_idx[kLanes];
+        for (std::size_t j = 0; j < m; ++j)
+        {
+            lane_idx[j] = resolve_(lane_win[j], keys[lane_key[j]]);
+            __builtin_prefetch(&leaves_[lane_idx[j]], 0, 3);
+        }
+        for (std::size_t j = 0; j < m; ++j)
+        {
+            out[lane_key[j]] = leaves_[lane_idx[j]];
+            last = lane_idx[j];
+        }
+    }
+}
+
+// ========================= 计数查询 =========================
+DataBlock *LearnedSearchLayer::find_candidate(Key k, std::uint64_t *before) const noexcept
+{
+    *before = 0;
+    EpochGuard guard;
+    const Snapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    if (!snap || snap->l0_size == 0)
+        return nullptr;
+    const std::size_t idx = floor_index_(*snap, k);
+    if (idx == static_cast<std::size_t>(-1))
+        return nullptr;
+    *before = counts_.prefix(idx);
+    return leaves_[idx];
+}
+
+DataBlock *LearnedSearchLayer::select_leaf(std::uint64_t r, std::uint64_t *offset) const noexcept
+{
+    EpochGuard guard;
+    const Snapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    if (!snap || snap->l0_size == 0)
+        return nullptr;
+    return leaves_[counts_.select(snap->l0_size, r, offset)];
+}
+
+// ========================= 叶层遍历 =========================
+void LearnedSearchLayer::split_keys(Key l, Key r, std::size_t parts, std::size_t min_leaves,
+                                    std::vector<Key> &out) const
+{
+    const auto npos = static_cast<std::size_t>(-1);
+    EpochGuard guard;
+    const Snapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    if (!snap || snap->l0_size == 0 || parts < 2)
+        return;
+    std::size_t lo = floor_index_(*snap, l);
+    const std::size_t hi = floor_index_(*snap, r);
+    if (hi == npos)
+        return;
+    if (lo == npos)
+        lo = 0;
+    const std::size_t leaves = hi - lo + 1;
+    parts = std::min(parts, leaves / std::max<std::size_t>(min_leaves, 1));
+    for (std::size_t p = 1; p < parts; ++p)
+    {
+        const Key k = keys_[lo + leaves * p / parts];
+        if (k > l && (out.empty() || k > out.back()))
+            out.push_back(k);
+    }
+}
+
+std::size_t LearnedSearchLayer::copy_leaves(std::size_t from, Key hi, DataBlock **out, std::size_t n) const noexcept
+{
+    EpochGuard guard;
+    const Snapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    const std::size_t size = snap ? snap->l0_size : 0;
+    if (from >= size)
+        return 0;
+    n = std::min(n, size - from);
+    std::size_t i = 0;
+    for (; i < n && keys_[from + i] <= hi; ++i)
+        out[i] = leaves_[from + i];
+    return i;
+}
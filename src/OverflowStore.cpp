@@ -0,0 +1,55 @@
+#include "OverflowStore.h"
+#include <algorithm>
+
+// ========================= 快照二分 =========================
+std::size_t OverflowStore::Run::lower_bound(Key k) const noexcept
+{
+    return std::lower_bound(keys.begin(), keys.end(), k) - keys.begin();
+}
+
+std::size_t OverflowStore::Run::upper_bound(Key k) const noexcept
+{
+    return std::upper_bound(keys.begin(), keys.end(), k) - keys.begin();
+}
+
+// ========================= 写入 =========================
+void OverflowStore::insert(Key k, Value v)
+{
+    std::lock_guard<std::mutex> g(mu_);
+    map_.emplace(k, v);
+    dirty_ = true;
+    size_.store(map_.size(), std::memory_order_release);
+}
+
+// ========================= 查询 =========================
+bool OverflowStore::lookup(Key k, Value *out) const
+{
+    if (empty())
+        return false;
+    std::lock_guard<std::mutex> g(mu_);
+    auto it = map_.find(k);
+    if (it == map_.end())
+        return false;
+    if (out)
+        *out = it->second;
+    return true;
+}
+
+std::shared_ptr<const OverflowStore::Run> OverflowStore::snapshot() const
+{
+    std::lock_guard<std::mutex> g(mu_);
+    if (dirty_ || !snap_)
+    {
+        auto run = std::make_shared<Run>();
+        run->keys.reserve(map_.size());
+        run->vals.reserve(map_.size());
+        for (const auto &e : map_)
+        {
+            run->keys.push_back(e.first);
+            run->vals.push_back(e.second);
+        }
+        snap_ = std::move(run);
+        dirty_ = false;
+    }
+    return snap_;
+}
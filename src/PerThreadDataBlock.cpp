@@ -1,4 +1,6 @@
 #include "PerThreadDataBlock.h"
+#include <algorithm>
+#include <iterator>
 
 // ========================= 构造 =========================
 PerThreadDataBlock::PerThreadDataBlock()
@@ -6,27 +8,33 @@ PerThreadDataBlock::PerThreadDataBlock()
 
 // ========================= 写入接口 =========================
 // 尾部插入一条 KV。若已满返回 false。
+// 先写条目再以 release 发布条目数，并发的新鲜读只会看到已写完的条目。
 bool PerThreadDataBlock::Insert(Key key, Value value)
 {
-    if (IsFull())
+    size_t n = num_entries_.load(std::memory_order_relaxed);
+    const size_t cnt = n & ~kUnsorted;
+    if (cnt >= kCapacity)
         return false;
-    data_[num_entries_] = {key, value};
-    max_key_ = key; // 写入是顺序追加，直接更新最大 key
-    ++num_entries_;
+    data_[cnt] = {key, value};
+    if (cnt > 0 && key < max_key_)
+        n |= kUnsorted; // 逆序写入：读者不再二分
+    else
+        max_key_ = key;
+    num_entries_.store(n + 1, std::memory_order_release);
     return true;
 }
 
 // 是否已满
 bool PerThreadDataBlock::IsFull() const
 {
-    return num_entries_ >= kCapacity;
+    return GetNumEntries() >= kCapacity;
 }
 
 // ========================= 只读视图 =========================
 // 返回已写入的条目数
 size_t PerThreadDataBlock::GetNumEntries() const
 {
-    return num_entries_;
+    return num_entries_.load(std::memory_order_acquire) & ~kUnsorted;
 }
 
 // 返回指向数据区的只读指针（外部仅在只读阶段使用）
@@ -34,3 +42,45 @@ const KVPair *PerThreadDataBlock::GetData() const
 {
     return data_;
 }
+
+// ========================= 新鲜读 =========================
+size_t PerThreadDataBlock::published_(bool *sorted) const
+{
+    const size_t n = num_entries_.load(std::memory_order_acquire);
+    *sorted = (n & kUnsorted) == 0;
+    return n & ~kUnsorted;
+}
+
+void PerThreadDataBlock::CopyRange(Key l, Key r, std::vector<KVPair> &out) const
+{
+    bool sorted;
+    const size_t n = published_(&sorted);
+    const KVPair *end = data_ + n;
+    if (!sorted)
+    {
+        std::copy_if(data_, end, std::back_inserter(out), [l, r](const KVPair &e)
+                     { return e.key >= l && e.key <= r; });
+        return;
+    }
+    const KVPair *lo = std::lower_bound(data_, end, l, [](const KVPair &e, Key k)
+                                        { return e.key < k; });
+    const KVPair *hi = std::upper_bound(lo, end, r, [](Key k, const KVPair &e)
+                                        { return k < e.key; });
+    out.insert(out.end(), lo, hi);
+}
+
+bool PerThreadDataBlock::Find(Key key, Value *value) const
+{
+    bool sorted;
+    const size_t n = published_(&sorted);
+    const KVPair *end = data_ + n;
+    const KVPair *it = sorted ? std::lower_bound(data_, end, key, [](const KVPair &e, Key k)
+                                                 { return e.key < k; })
+                              : std::find_if(data_, end, [key](const KVPair &e)
+                                             { return e.key == key; });
+    if (it == end || it->key != key)
+        return false;
+    if (value)
+        *value = it->value;
+    return true;
+}
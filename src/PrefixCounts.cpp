@@ -0,0 +1,123 @@
+#include "PrefixCounts.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cassert>
+
+// ========================= 构造 =========================
+PrefixCounts::PrefixCounts(std::size_t fanout)
+    : fanout_(fanout), shift_(0)
+{
+    assert(fanout_ >= 2 && (fanout_ & (fanout_ - 1)) == 0 && fanout_ <= CountArray::kChunk &&
+           "fanout must be a power of two no larger than a chunk");
+    while ((std::size_t(1) << shift_) < fanout_)
+        ++shift_;
+    levels_[0] = std::make_unique<CountArray>();
+}
+
+// 第 lv 层长度 = n / F^lv
+static std::size_t level_size(std::size_t n, std::size_t shift, std::size_t lv) noexcept
+{
+    return lv * shift >= 64 ? 0 : n >> (lv * shift);
+}
+
+// ========================= 写侧 =========================
+// 组内累计：组首项即自身计数，其余项为前一项加自身计数；
+// 本项补齐一组时，组总数（即本项）晋升为上一层的一项，逐层向上。
+void PrefixCounts::push_back(std::uint64_t count)
+{
+    const std::size_t mask = fanout_ - 1;
+    for (std::size_t lv = 0;; ++lv)
+    {
+        assert(lv < kMaxLevels);
+        if (!levels_[lv])
+            levels_[lv] = std::make_unique<CountArray>();
+        CountArray &a = *levels_[lv];
+        const std::size_t j = a.size();
+        const std::uint64_t cum = (j & mask) ? a[j - 1] + count : count;
+        a.push_back(cum);
+        if (((j + 1) & mask) != 0)
+            break;
+        count = cum;
+    }
+}
+
+// 叶子 i 的增量影响：各层中覆盖它的那一项及同组其后各项（组内累计值）
+void PrefixCounts::add(std::size_t i, std::uint64_t delta, std::vector<CountArray::Chunk> &garbage)
+{
+    if (delta == 0)
+        return;
+    const std::size_t mask = fanout_ - 1;
+    for (std::size_t lv = 0, j = i; lv < kMaxLevels && levels_[lv]; ++lv, j >>= shift_)
+    {
+        CountArray &a = *levels_[lv];
+        if (j >= a.size())
+            break; // 所在组尚未凑满，上层没有对应项
+        const std::size_t end = std::min((j | mask) + 1, a.size());
+        garbage.push_back(a.update(j, end, [delta](std::uint64_t &c)
+                                   { c += delta; }));
+    }
+}
+
+void PrefixCounts::clear()
+{
+    for (auto &lv : levels_)
+        if (lv)
+            lv->clear();
+}
+
+// ========================= 读侧 =========================
+// i = Σ a_lv·F^lv：第 lv 层读第 (i/F^lv - 1) 项即得该层完整组之前 a_lv 项之和
+std::uint64_t PrefixCounts::prefix(std::size_t i) const noexcept
+{
+    const std::size_t mask = fanout_ - 1;
+    std::uint64_t s = 0;
+    for (std::size_t lv = 0; i > 0; ++lv, i >>= shift_)
+        if (i & mask)
+            s += (*levels_[lv])[i - 1];
+    return s;
+}
+
+// 自顶向下：每层在一组（或下层未晋升的尾部）内计数累计值 <= r 的项，
+// 命中则进入该项覆盖的子组；整组都 <= r 时扣除组总数，转入下层尾部。
+std::size_t PrefixCounts::select(std::size_t n, std::uint64_t r, std::uint64_t *rem) const noexcept
+{
+    if (n == 0)
+        return npos;
+    std::size_t top = 0;
+    while (top + 1 < kMaxLevels && level_size(n, shift_, top + 1) > 0)
+        ++top;
+
+    std::size_t lo = 0, hi = level_size(n, shift_, top);
+    for (std::size_t lv = top;; --lv)
+    {
+        const CountArray &a = *levels_[lv];
+        std::size_t c = 0;
+        if (lo < hi)
+        {
+            c = simd_count_le(a.contiguous(lo, hi), hi - lo, r);
+            if (c > 0)
+                r -= a[lo + c - 1];
+        }
+        if (c < hi - lo)
+        {
+            if (lv == 0)
+            {
+                *rem = r;
+                return lo + c;
+            }
+            lo = (lo + c) << shift_;
+            hi = lo + fanout_;
+            continue;
+        }
+        if (lv == 0)
+        {
+            // 超出总数：落在最后一个叶子之后，偏移相对该叶子起点
+            const std::size_t last = n - 1;
+            const std::uint64_t own = a[last] - ((last & (fanout_ - 1)) ? a[last - 1] : 0);
+            *rem = r + own;
+            return last;
+        }
+        lo = hi << shift_;
+        hi = level_size(n, shift_, lv - 1);
+    }
+}
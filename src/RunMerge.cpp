@@ -0,0 +1,99 @@
+#include "RunMerge.h"
+#include <algorithm>
+#include <cstring>
+
+// ========================= 败者树 =========================
+LoserTree::LoserTree(const std::vector<KVRun> &runs)
+{
+    const std::size_t k = runs.empty() ? 1 : runs.size();
+    while (leaves_ < k)
+        leaves_ <<= 1;
+
+    // 补齐的叶子用空区间表示（恒为 +∞）
+    cur_.assign(leaves_, nullptr);
+    end_.assign(leaves_, nullptr);
+    for (std::size_t i = 0; i < runs.size(); ++i)
+    {
+        cur_[i] = runs[i].data;
+        end_[i] = runs[i].data + runs[i].n;
+    }
+
+    // 自底向上初赛：winners[i] 为子树 i 的胜者，tree_[i] 记录败者
+    tree_.assign(leaves_, 0);
+    std::vector<uint32_t> winners(2 * leaves_);
+    for (std::size_t i = 0; i < leaves_; ++i)
+        winners[leaves_ + i] = static_cast<uint32_t>(i);
+    for (std::size_t i = leaves_ - 1; i >= 1; --i)
+    {
+        const uint32_t a = winners[2 * i], b = winners[2 * i + 1];
+        if (beats_(b, a))
+        {
+            winners[i] = b;
+            tree_[i] = a;
+        }
+        else
+        {
+            winners[i] = a;
+            tree_[i] = b;
+        }
+    }
+    tree_[0] = winners[1];
+}
+
+void LoserTree::pop()
+{
+    uint32_t w = tree_[0];
+    ++cur_[w];
+    // 沿叶到根重赛：与各层败者比较，输者留下，胜者继续上行
+    for (std::size_t node = (leaves_ + w) >> 1; node >= 1; node >>= 1)
+    {
+        if (beats_(tree_[node], w))
+            std::swap(tree_[node], w);
+    }
+    tree_[0] = w;
+}
+
+// ========================= LSD 基数排序 =========================
+void radix_sort_by_key(const KVPair *src, std::size_t n, KVPair *dst, KVPair *tmp)
+{
+    constexpr std::size_t kPasses = sizeof(Key);
+    std::size_t hist[kPasses][256] = {};
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        Key k = src[i].key;
+        for (std::size_t p = 0; p < kPasses; ++p)
+            ++hist[p][(k >> (8 * p)) & 0xFF];
+    }
+
+    // 需要执行的趟次：该字节上并非所有元素都相同
+    std::size_t active[kPasses], na = 0;
+    for (std::size_t p = 0; p < kPasses; ++p)
+        if (n > 0 && hist[p][(src[0].key >> (8 * p)) & 0xFF] != n)
+            active[na++] = p;
+
+    if (na == 0)
+    {
+        if (n > 0)
+            std::memcpy(dst, src, n * sizeof(KVPair));
+        return;
+    }
+
+    // 安排缓冲区轮换，使最后一趟恰好写入 dst
+    const KVPair *in = src;
+    KVPair *bufs[2] = {(na % 2 == 1) ? dst : tmp, (na % 2 == 1) ? tmp : dst};
+    for (std::size_t t = 0; t < na; ++t)
+    {
+        const std::size_t p = active[t];
+        const unsigned shift = static_cast<unsigned>(8 * p);
+        std::size_t offset[256], sum = 0;
+        for (std::size_t b = 0; b < 256; ++b)
+        {
+            offset[b] = sum;
+            sum += hist[p][b];
+        }
+        KVPair *out = bufs[t % 2];
+        for (std::size_t i = 0; i < n; ++i)
+            out[offset[(in[i].key >> shift) & 0xFF]++] = in[i];
+        in = out;
+    }
+}
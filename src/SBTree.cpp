@@ -1,182 +1,71 @@
 #include "SBTree.h"
-#include <vector>
-#include <iostream>
+#include "EpochManager.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
 
 // ========================= 构造/析构 =========================
-SBTree::SBTree()
-    : shortcut_(new SegmentedBlock()),
-      data_head_(nullptr),
-      data_tail_(nullptr)
+BasicSBTree<MultiWriter>::BasicSBTree(const SBTreeOptions &opts)
+    : SBTreeBase(opts),
+      shortcut_(nullptr)
 {
-    // 启动索引后台线程
-    index_stop_.store(false, std::memory_order_relaxed);
-    index_thread_ = std::thread(&SBTree::index_worker_, this);
+    shortcut_.store(new_segment_());
+    start_index_thread_();
 }
 
-SBTree::~SBTree()
+BasicSBTree<MultiWriter>::~BasicSBTree()
 {
     // 1) 刷新活跃段，转换并落盘到数据层
     flush();
-    // 2) 等待索引层同步完成
-    flush_index();
-    // 3) 通知后台线程退出
-    {
-        std::lock_guard<std::mutex> lk(q_mu_);
-        index_stop_.store(true, std::memory_order_release);
-    }
-    q_cv_.notify_all();
-    if (index_thread_.joinable())
-        index_thread_.join();
-
-    // 4) 释放数据层链表
-    DataBlock *cur = data_head_;
-    while (cur)
-    {
-        DataBlock *nxt = cur->next();
-        delete cur;
-        cur = nxt;
-    }
-    data_head_ = data_tail_ = nullptr;
-
-    // 5) 释放活跃分段块
+    // 2) 等待索引层同步完成并停止后台线程（其后不再回调 on_index_tick_）
+    stop_index_thread_();
+    // 3) 释放活跃分段块与复用池
     delete shortcut_;
     shortcut_ = nullptr;
-}
-
-// ========================= 内部辅助 =========================
-// 段转换 + 追加到数据层 + 入队索引任务
-void SBTree::convert_and_append(SegmentedBlock *seg_to_convert)
-{
-    if (!seg_to_convert)
-        return;
-    std::vector<KVPair> sorted_data = seg_to_convert->collect_and_sort_data();
-    delete seg_to_convert;
-    if (sorted_data.empty())
-        return;
-
-    DataBlock *new_chain_head = nullptr;
-    DataBlock *new_chain_tail = nullptr;
-    std::vector<DataBlock *> new_blocks;
-    new_blocks.reserve(16);
-
-    const KVPair *current_pos = sorted_data.data();
-    size_t remaining = sorted_data.size();
-    bool first_block = true;
-    Key prev_min = 0;
-
-    while (remaining > 0)
-    {
-        DataBlock *new_block = new DataBlock();
-        size_t consumed = new_block->build_from_sorted(current_pos, remaining);
-        assert(consumed > 0);
-
-        if (!new_chain_head)
-            new_chain_head = new_chain_tail = new_block;
-        else
-        {
-            new_chain_tail->set_next(new_block);
-            new_chain_tail = new_block;
-        }
-
-        if (!first_block)
-            assert(prev_min <= new_block->min_key());
-        prev_min = new_block->min_key();
-        first_block = false;
-        new_blocks.push_back(new_block);
-
-        current_pos += consumed;
-        remaining -= consumed;
-    }
-
-    {
-        std::lock_guard<std::mutex> g(data_layer_lock_);
-        if (!data_tail_)
-        {
-            data_head_ = new_chain_head;
-            data_tail_ = new_chain_tail;
-        }
-        else
-        {
-            data_tail_->set_next(new_chain_head);
-            data_tail_ = new_chain_tail;
-        }
-    }
-    std::cout << "Appended " << sorted_data.size() << " entries to the data layer.\n";
-    enqueue_index_task_(std::move(new_blocks));
-}
-
-// 入队索引任务
-void SBTree::enqueue_index_task_(std::vector<DataBlock *> &&blocks)
-{
-    if (blocks.empty())
-        return;
-    idx_batches_enqueued_.fetch_add(1);
-    idx_items_enqueued_.fetch_add(blocks.size());
-
+    for (auto *seg : seg_pool_)
+        delete seg;
+    seg_pool_.clear();
+    for (SegNode *n = all_segs_.load(); n;)
     {
-        std::lock_guard<std::mutex> lk(q_mu_);
-        index_q_.emplace_back(std::move(blocks));
-    }
-    q_cv_.notify_one();
-}
-
-// 后台索引线程主循环
-void SBTree::index_worker_()
-{
-    for (;;)
-    {
-        std::vector<DataBlock *> batch;
-        {
-            std::unique_lock<std::mutex> lk(q_mu_);
-            q_cv_.wait(lk, [&]
-                       { return index_stop_.load() || !index_q_.empty(); });
-            if (index_stop_.load() && index_q_.empty())
-                break;
-            batch = std::move(index_q_.front());
-            index_q_.pop_front();
-            ++index_in_flight_;
-        }
-        {
-            std::unique_lock<std::shared_mutex> wlock(search_mu_);
-            search_.append_run(batch);
-        }
-        idx_batches_applied_.fetch_add(1);
-        idx_items_applied_.fetch_add(batch.size());
-        --index_in_flight_;
-        q_cv_.notify_all();
+        SegNode *next = n->next;
+        delete n;
+        n = next;
     }
 }
 
 // ========================= 基本操作 =========================
 // 刷新活跃段
-void SBTree::flush()
+void BasicSBTree<MultiWriter>::flush()
 {
     SegmentedBlock *final_seg = shortcut_.exchange(nullptr);
     if (final_seg)
         convert_and_append(final_seg);
-}
-
-// 等待索引完成
-void SBTree::flush_index()
-{
-    std::unique_lock<std::mutex> lk(q_mu_);
-    q_cv_.wait(lk, [&]
-               { return index_q_.empty() && (index_in_flight_.load() == 0); });
+    publish_run_({}, 0); // 并入转换之后新到的迟到点
 }
 
 // 插入（并发友好，支持段切换）
-void SBTree::insert(Key key, Value value)
+void BasicSBTree<MultiWriter>::insert(Key key, Value value)
 {
+    // 若有段正在协作转换，顺手领取一个任务（单次原子读判断）
+    if (conv_.has_work())
+        conv_.help();
+
+    // 迟到点：低于水位的 key 不能进入新 run（会破坏数据层/搜索层有序性）
+    const Key wm = watermark_.load(std::memory_order_relaxed);
+    if (key < wm)
+    {
+        insert_late_(key, value, wm);
+        return;
+    }
+
     for (;;)
     {
         SegmentedBlock *seg = shortcut_.load();
         if (seg && seg->append_ordered(key, value))
         {
-            if (key > max_key_)
-                max_key_ = key;
             if (seg->should_seal())
             {
-                auto *new_seg = new SegmentedBlock();
+                SegmentedBlock *new_seg = acquire_segment_();
                 SegmentedBlock *expected = seg;
                 if (shortcut_.compare_exchange_strong(expected, new_seg))
                 {
@@ -185,12 +74,12 @@ void SBTree::insert(Key key, Value value)
                 }
                 else
                 {
-                    delete new_seg;
+                    discard_segment_(new_seg);
                 }
             }
             return;
         }
-        auto *new_seg = new SegmentedBlock();
+        SegmentedBlock *new_seg = acquire_segment_();
         SegmentedBlock *expected = seg;
         if (shortcut_.compare_exchange_strong(expected, new_seg))
         {
@@ -199,184 +88,219 @@ void SBTree::insert(Key key, Value value)
                 seg->seal();
                 convert_and_append(seg);
             }
-            new_seg->append_ordered(key, value);
-            return;
+            // 新段可能已被其他写线程写满并切走，失败时重试
+            if (new_seg->append_ordered(key, value))
+                return;
         }
         else
         {
-            delete new_seg;
+            discard_segment_(new_seg);
         }
     }
 }
 
-// 查找
-bool SBTree::lookup(Key k, Value *out) const
+// ========================= 内部辅助 =========================
+void BasicSBTree<MultiWriter>::on_index_tick_()
 {
-    DataBlock *blk = find_candidate_(k);
-    if (!blk)
-        blk = data_head_;
-    while (blk)
-    {
-        Value v{};
-        if (blk->find(k, v))
-        {
-            if (out)
-                *out = v;
-            return true;
-        }
-        DataBlock *nxt = blk->next();
-        if (!nxt || nxt->min_key() > k)
-            break;
-        blk = nxt;
-    }
-    return false;
+    seal_if_stale_();
 }
 
-// 扫描
-size_t SBTree::scan(Key l, Key r, std::vector<Value> &out) const
+// 段转换 + 追加到数据层 + 入队索引任务。
+// 先发布再回收段：挂链与标记段已转换在数据层锁内由发布序号包围（见 publish_run_）
+void BasicSBTree<MultiWriter>::convert_and_append(SegmentedBlock *seg_to_convert)
 {
-    if (l > r)
-        return 0;
-    auto cur = open_range_cursor(l, r);
-    size_t added = 0;
-    KVPair kv;
-    while (cur.next(&kv))
-    {
-        out.push_back(kv.value);
-        ++added;
-    }
-    return added;
+    if (!seg_to_convert)
+        return;
+    ConversionJob job(seg_to_convert->collect_runs());
+    conv_.run(job); // 其他写线程可在 insert 中协助执行任务
+    std::vector<DataBlock *> new_blocks = job.take_blocks();
+    publish_run_(std::move(new_blocks), job.total_entries(), seg_to_convert);
+    release_segment_(seg_to_convert);
 }
 
-// ========================= RangeCursor =========================
-SBTree::RangeCursor::RangeCursor(const SBTree *owner, Key l, Key r, DataBlock *start)
-    : owner_(owner), l_(l), r_(r), blk_(start), idx_(0)
+SegmentedBlock *BasicSBTree<MultiWriter>::acquire_segment_()
 {
-    if (!blk_ || blk_->min_key() > r_)
+    SegmentedBlock *seg = nullptr;
     {
-        blk_ = nullptr;
-        return;
+        std::lock_guard<std::mutex> g(seg_pool_mu_);
+        if (!seg_pool_.empty())
+        {
+            seg = seg_pool_.back();
+            seg_pool_.pop_back();
+        }
     }
-    seek_first_pos_();
+    if (!seg)
+        return new_segment_();
+    seg->activate();
+    return seg;
 }
 
-void SBTree::RangeCursor::seek_first_pos_()
+// 按封印策略创建新段：字节阈值换算为 PTB 个数（向上取整，至少 1 个）；
+// 登记到 all_segs_ 供新鲜读遍历
+SegmentedBlock *BasicSBTree<MultiWriter>::new_segment_()
 {
-    const std::size_t n = blk_->size();
-    std::size_t L = 0, R = n, pos = n;
-    while (L < R)
+    const size_t max_entries = opts_.seal_max_entries ? opts_.seal_max_entries : SIZE_MAX;
+    size_t max_ptbs = SIZE_MAX;
+    if (opts_.seal_max_bytes)
     {
-        std::size_t mid = L + ((R - L) >> 1);
-        const KVPair &e = blk_->get_entry(mid);
-        if (e.key >= l_)
-        {
-            pos = mid;
-            R = mid;
-        }
-        else
-            L = mid + 1;
+        constexpr size_t kPTBBytes = sizeof(PerThreadDataBlock);
+        max_ptbs = std::max<size_t>(1, (opts_.seal_max_bytes + kPTBBytes - 1) / kPTBBytes);
     }
-    idx_ = pos;
-    while (blk_ && idx_ >= blk_->size())
+    auto *seg = new SegmentedBlock(max_entries, max_ptbs);
+    auto *node = new SegNode{seg, all_segs_.load(std::memory_order_relaxed)};
+    while (!all_segs_.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                            std::memory_order_relaxed))
     {
-        blk_ = blk_->next();
-        if (!blk_ || blk_->min_key() > r_)
-        {
-            blk_ = nullptr;
-            break;
-        }
-        idx_ = 0;
     }
+    return seg;
 }
 
-bool SBTree::RangeCursor::next(KVPair *out)
+// 时间阈值：活跃段首条写入已超过 seal_max_age 时，替换并转换该段
+void BasicSBTree<MultiWriter>::seal_if_stale_()
 {
-    if (!blk_)
-        return false;
-    const std::size_t n = blk_->size();
-    while (idx_ < n)
+    SegmentedBlock *seg = shortcut_.load();
+    if (!seg)
+        return;
+    const int64_t first = seg->first_write_ns();
+    if (first == 0)
+        return;
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch())
+                            .count();
+    if (now - first < std::chrono::nanoseconds(opts_.seal_max_age).count())
+        return;
+
+    SegmentedBlock *new_seg = acquire_segment_();
+    SegmentedBlock *expected = seg;
+    if (shortcut_.compare_exchange_strong(expected, new_seg))
     {
-        const KVPair &e = blk_->get_entry(idx_++);
-        if (e.key > r_)
-        {
-            blk_ = nullptr;
-            return false;
-        }
-        if (e.key >= l_)
-        {
-            if (out)
-                *out = e;
-            return true;
-        }
+        seg->seal();
+        convert_and_append(seg);
     }
-    blk_ = blk_->next();
-    if (!blk_ || blk_->min_key() > r_)
+    else
     {
-        blk_ = nullptr;
-        return false;
+        discard_segment_(new_seg);
     }
-    idx_ = 0;
-    return next(out);
 }
 
-size_t SBTree::RangeCursor::next_batch(std::vector<KVPair> &out, size_t limit)
+// 未能发布的段：复用的段对象在启用后可能被持有旧指针的写线程写入。封印并等在途
+// 写入退出后仍为空（通常如此）则直接回池，不经发布；确有条目才按常规转换
+void BasicSBTree<MultiWriter>::discard_segment_(SegmentedBlock *seg)
 {
-    if (!blk_ || limit == 0)
-        return 0;
-    size_t added = 0;
-    KVPair kv;
-    while (added < limit && next(&kv))
+    seg->seal();
+    if (seg->collect_runs().empty())
     {
-        out.push_back(kv);
-        ++added;
+        release_segment_(seg);
+        return;
     }
-    return added;
+    convert_and_append(seg);
 }
 
-SBTree::RangeCursor SBTree::open_range_cursor(Key l, Key r) const
+void BasicSBTree<MultiWriter>::release_segment_(SegmentedBlock *seg)
 {
-    if (l > r)
-        return RangeCursor(this, 1, 0, nullptr);
-    DataBlock *blk = find_candidate_(l);
-    if (!blk)
-        blk = data_head_;
-    return RangeCursor(this, l, r, blk);
+    seg->recycle();
+    std::lock_guard<std::mutex> g(seg_pool_mu_);
+    seg_pool_.push_back(seg);
 }
 
-// ========================= 验证/统计 =========================
-bool SBTree::verify_data_layer(size_t expected_total_keys) const
+// ========================= 新鲜读 =========================
+// 进行中的发布只持续一次数据层临界区（挂链、并入迟到点与标记段），在此让出等待
+uint64_t BasicSBTree<MultiWriter>::stable_pub_seq_() const
 {
-    std::lock_guard<std::mutex> g(data_layer_lock_);
-    size_t actual = 0;
-    Key last = 0;
-    DataBlock *cur = data_head_;
-    while (cur)
+    for (;;)
     {
-        for (size_t i = 0; i < cur->size(); ++i)
-        {
-            KVPair e = cur->get_entry(i);
-            if (e.key != actual)
-                return false;
-            if (e.value != e.key * 10)
-                return false;
-            if (actual > 0 && e.key <= last)
-                return false;
-            last = e.key;
-            ++actual;
-        }
-        cur = cur->next();
+        const uint64_t seq = pub_seq_.load();
+        if ((seq & (kPubGen - 1)) == 0)
+            return seq;
+        std::this_thread::yield();
     }
-    return actual == expected_total_keys;
 }
 
-DataBlock *SBTree::find_candidate_(Key k) const
+// 已发布数据未命中时再查各段；期间若有段转移到数据层则重试（可能刚好错过），
+// 连续 kFreshRetries 次后在数据层锁内查找
+bool BasicSBTree<MultiWriter>::lookup_fresh_(Key k, Value *out) const
 {
-    return search_.find_candidate(k);
+    for (int attempt = 0;; ++attempt)
+    {
+        std::unique_lock<std::mutex> g;
+        uint64_t seq = 0;
+        if (attempt < kFreshRetries)
+            seq = stable_pub_seq_();
+        else
+            g = lock_publication_();
+        if (lookup_published_(k, out))
+            return true;
+        {
+            EpochGuard guard;
+            for (const SegNode *n = all_segs_.load(std::memory_order_acquire); n; n = n->next)
+                if (n->seg->find(k, out))
+                    return true;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (g.owns_lock() || pub_seq_.load() == seq)
+            return false;
+    }
 }
 
-uint64_t SBTree::index_batches_enqueued() const noexcept { return idx_batches_enqueued_.load(); }
-uint64_t SBTree::index_batches_applied() const noexcept { return idx_batches_applied_.load(); }
-uint64_t SBTree::index_items_enqueued() const noexcept { return idx_items_enqueued_.load(); }
-uint64_t SBTree::index_items_applied() const noexcept { return idx_items_applied_.load(); }
+// 快照取段内 [l, r] 的条目与水位 wm。此后段的发布只会向数据层追加 key >= wm 的 run，
+// 或把低于 wm 的条目以迟到点并入所在块——只改动这些条目自身的 key。因此游标在 wm
+// 以下照常读取数据层与溢出区，仅跳过段内条目低于 wm 的那些 key；这些 key 以及
+// >= wm 部分的已发布数据在同一序号下复制进 run（同 key 时已发布数据在前）。
+// 复制量与段内条目数及其 key 上的已发布条目数成正比，与区间内其余数据无关。
+// 快照期间有发布则重试，连续 kFreshRetries 次后在数据层锁内读取。
+std::shared_ptr<const OverflowStore::Run>
+BasicSBTree<MultiWriter>::fresh_overlay_(Key l, Key r, Key *data_end, std::vector<Key> *skip) const
+{
+    std::vector<KVPair> fresh, published;
+    for (int attempt = 0;; ++attempt)
+    {
+        std::unique_lock<std::mutex> g;
+        uint64_t seq = 0;
+        if (attempt < kFreshRetries)
+            seq = stable_pub_seq_();
+        else
+            g = lock_publication_();
+        fresh.clear();
+        {
+            EpochGuard guard;
+            for (const SegNode *n = all_segs_.load(std::memory_order_acquire); n; n = n->next)
+                n->seg->copy_range(l, r, fresh);
+        }
+        if (fresh.empty())
+            return nullptr;
+        std::stable_sort(fresh.begin(), fresh.end(), [](const KVPair &a, const KVPair &b)
+                         { return a.key < b.key; });
+        const Key wm = watermark_.load(std::memory_order_acquire);
+        skip->clear();
+        for (const KVPair &e : fresh)
+        {
+            if (e.key >= wm)
+                break;
+            if (skip->empty() || skip->back() != e.key)
+                skip->push_back(e.key);
+        }
+        published.clear();
+        for (Key k : *skip)
+            open_published_cursor_(k, k).next_batch(published, SIZE_MAX);
+        if (wm <= r)
+            open_published_cursor_(std::max(l, wm), r).next_batch(published, SIZE_MAX);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!g.owns_lock() && pub_seq_.load() != seq)
+            continue;
 
-std::size_t SBTree::index_levels() const { return search_.levels_snapshot(); }
\ No newline at end of file
+        auto run = std::make_shared<OverflowStore::Run>();
+        run->keys.reserve(fresh.size() + published.size());
+        run->vals.reserve(fresh.size() + published.size());
+        size_t i = 0, j = 0;
+        while (i < published.size() || j < fresh.size())
+        {
+            const KVPair &e = (j == fresh.size() || (i < published.size() && published[i].key <= fresh[j].key))
+                                  ? published[i++]
+                                  : fresh[j++];
+            run->keys.push_back(e.key);
+            run->vals.push_back(e.value);
+        }
+        *data_end = wm;
+        return run;
+    }
+}
@@ -0,0 +1,1931 @@
+#include <mutex>
+#include <cstdio>
+#include <set>
+std::mutex g_dbg_mu; std::set<unsigned long> g_dbg_late, g_dbg_split, g_dbg_merged;
+#include "SBTreeBase.h"
+#include "EpochManager.h"
+#include "Simd.h"
+#include "SegmentedBlock.h"
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <mutex>
+
+// ========================= 构造/析构 =========================
+SBTreeBase::SBTreeBase(const SBTreeOptions &opts)
+    : opts_(opts),
+      data_head_(nullptr),
+      data_tail_(nullptr),
+      tail_dir_(opts.tail_directory_blocks)
+{
+    if (opts_.search_layer == SearchLayerKind::LEARNED)
+        learned_ = std::make_unique<LearnedSearchLayer>(opts_.learned_epsilon);
+}
+
+SBTreeBase::~SBTreeBase()
+{
+    // 派生类通常已在自身析构中调用 stop_index_thread_()；此处兜底
+    stop_index_thread_();
+
+    // 释放数据层链表（被替换的旧块已在索引线程应用替换后交给 EpochManager）
+    DataBlock *cur = data_head_.load();
+    while (cur)
+    {
+        DataBlock *nxt = cur->next();
+        delete cur;
+        cur = nxt;
+    }
+    data_head_ = nullptr;
+    data_tail_ = nullptr;
+}
+
+// 启动索引后台线程（由派生类在构造完成时调用，保证 on_index_tick_ 已可用）
+void SBTreeBase::start_index_thread_()
+{
+    index_stop_.store(false, std::memory_order_relaxed);
+    index_thread_ = std::thread(&SBTreeBase::index_worker_, this);
+}
+
+// 等待索引同步并停止后台线程（幂等）
+void SBTreeBase::stop_index_thread_()
+{
+    if (!index_thread_.joinable())
+        return;
+    flush_index();
+    {
+        std::lock_guard<std::mutex> lk(q_mu_);
+        index_stop_.store(true, std::memory_order_release);
+    }
+    q_cv_.notify_all();
+    index_thread_.join();
+}
+
+// ========================= 内部辅助 =========================
+// 链接新 run 到数据层尾部，并把侧缓冲与 run 中低于水位的迟到点以写时复制并入
+void SBTreeBase::publish_run_(std::vector<DataBlock *> blocks, size_t entries, SegmentedBlock *seg)
+{
+    std::vector<KVPair> late = drain_late_();
+    if (blocks.empty() && late.empty() && !seg)
+        return;
+
+#ifndef NDEBUG
+    for (size_t i = 1; i < blocks.size(); ++i)
+        assert(blocks[i - 1]->min_key() <= blocks[i]->min_key());
+#endif
+
+    std::vector<IndexTask> replaced;
+    {
+        std::lock_guard<std::mutex> g(data_layer_lock_);
+        if (seg)
+            pub_seq_.fetch_add(1);
+        const Key wm = watermark_.load(std::memory_order_relaxed);
+        // 并发写线程可能在水位推进前读到旧水位，其数据会排在新 run 的前部
+        if (data_tail_)
+            split_late_prefix_locked_(blocks, wm, late);
+
+        if (!blocks.empty())
+        {
+            if (!data_tail_)
+                data_head_.store(blocks.front(), std::memory_order_release);
+            else
+                data_tail_->set_next(blocks.front());
+            data_tail_ = blocks.back();
+            const Key last = data_tail_->get_entry(data_tail_->size() - 1).key;
+            watermark_.store(std::max(wm, last), std::memory_order_release);
+            tail_dir_.on_append(blocks);
+        }
+        if (!late.empty())
+            merge_late_locked_(late, replaced);
+        tail_dir_.publish();
+        if (seg)
+        {
+            seg->mark_converted();
+            pub_seq_.fetch_add(kPubGen - 1);
+        }
+
+        // 在数据层锁内入队：并发转换的 run 以挂链顺序进入索引队列
+        if (!blocks.empty())
+        {
+            appended_entries_.fetch_add(entries, std::memory_order_relaxed);
+            enqueue_index_task_(std::move(blocks));
+        }
+        enqueue_replace_tasks_(std::move(replaced));
+    }
+}
+
+// 迟到点分流：窗口内进入侧缓冲，超出窗口进入溢出区。
+// 侧缓冲满时由本线程直接并入：水位远超当前写入时全部写入都是迟到点，
+// 不会再有转换来带走它们
+void SBTreeBase::insert_late_(Key key, Value value, Key wm)
+{
+    if (wm - key > opts_.disorder_window)
+    {
+        overflow_.insert(key, value);
+        return;
+    }
+    { std::lock_guard<std::mutex> dg(g_dbg_mu); g_dbg_late.insert(key); }
+    bool full = false;
+    {
+        std::lock_guard<std::mutex> g(late_mu_);
+        if (late_.empty() && opts_.seal_max_age.count() > 0)
+            late_first_ns_ = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                 std::chrono::steady_clock::now().time_since_epoch())
+                                 .count();
+        late_.push_back({key, value});
+        full = opts_.late_max_entries > 0 && late_.size() >= opts_.late_max_entries;
+    }
+    if (full)
+        publish_run_({}, 0);
+}
+
+std::vector<KVPair> SBTreeBase::drain_late_()
+{
+    std::lock_guard<std::mutex> g(late_mu_);
+    std::vector<KVPair> out;
+    out.swap(late_);
+    return out;
+}
+
+// 由索引线程周期调用：写入停顿或一直没有转换时，侧缓冲的可见性延迟同样以 seal_max_age 为界
+void SBTreeBase::publish_stale_late_()
+{
+    {
+        std::lock_guard<std::mutex> g(late_mu_);
+        if (late_.empty())
+            return;
+        const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                std::chrono::steady_clock::now().time_since_epoch())
+                                .count();
+        if (now - late_first_ns_ < std::chrono::nanoseconds(opts_.seal_max_age).count())
+            return;
+    }
+    publish_run_({}, 0);
+}
+
+// run 已整体有序：从头部开始把 key < wm 的条目移入 late；
+// 跨越水位的块按剩余部分重建，保证挂链后 run 首块 min_key >= wm。
+void SBTreeBase::split_late_prefix_locked_(std::vector<DataBlock *> &blocks, Key wm,
+                                       std::vector<KVPair> &late)
+{
+    size_t drop = 0;
+    while (drop < blocks.size() && blocks[drop]->min_key() < wm)
+    {
+        DataBlock *b = blocks[drop];
+        const size_t n = b->size();
+        size_t cut = 0;
+        while (cut < n && b->get_entry(cut).key < wm)
+        {
+            { std::lock_guard<std::mutex> dg(g_dbg_mu); g_dbg_split.insert(b->get_entry(cut).key); }
+            late.push_back(b->get_entry(cut++));
+        }
+        if (cut < n)
+        {
+            // 跨越水位：剩余部分重建为新块，接替 b 在 run 中的位置
+            DataBlock *rest = new DataBlock();
+            for (size_t i = cut; i < n; ++i)
+            {
+                KVPair e = b->get_entry(i);
+                rest->push_sorted(e.key, e.value);
+            }
+            rest->finish_build();
+            rest->set_next(b->next());
+            blocks[drop] = rest;
+            delete b;
+            break;
+        }
+        delete b;
+        ++drop;
+    }
+    blocks.erase(blocks.begin(), blocks.begin() + drop);
+}
+
+// 返回链上“最后一个 min_key <= k”的块（k 小于全局最小时返回表头），并写出其前驱。
+// 从 floor 候选之前的一个在链块出发沿 next 前进，只经过两个叶子名下的拆分后继块：
+// 候选先查尾部目录，其次查搜索层；二者都可能滞后于链（目录在本次发布末尾才更新，
+// 索引线程异步改指叶子），给出已被替换的块时经 live_ 换成接替它的在链块。
+// 只有 k 早于已索引的首块时才从表头出发。
+DataBlock *SBTreeBase::locate_floor_locked_(Key k, DataBlock **prev) const
+{
+    DataBlock *before = nullptr;
+    DataBlock *cand = tail_find_(k);
+    if (cand && cand->min_key() > 0)
+        before = tail_find_(cand->min_key() - 1);
+    if (!before)
+    {
+        cand = index_find_(k);
+        if (cand && cand->min_key() > 0)
+            before = index_find_(cand->min_key() - 1);
+    }
+
+    DataBlock *p = before;
+    DataBlock *c = before ? before->next() : data_head_.load(std::memory_order_relaxed);
+    while (c && c->next() && c->next()->min_key() <= k)
+    {
+        p = c;
+        c = c->next();
+    }
+    *prev = p;
+    return c;
+}
+
+// 写时复制并入迟到点：对每个受影响的块，归并“旧内容 + 落入该块的迟到点”
+// 生成新块，替换链上的旧块；旧块标记 RETIRED，待搜索层改指后交给 EpochManager。
+// 新链按容量装满、末块承接余数。装不下且紧随其后的是拆分出的后继块时，若一并
+// 重排不增加块数就把它也并进来：满块再落入迟到点只需挪几条到后继块，不会每次
+// 拆出一个只有几条的小块（后继块不在叶层，min_key 可以改变）。
+void SBTreeBase::merge_late_locked_(std::vector<KVPair> &late, std::vector<IndexTask> &replaced)
+{
+    std::sort(late.begin(), late.end(),
+              [](const KVPair &a, const KVPair &b)
+              { return a.key < b.key; });
+
+    const size_t cap = DataBlock::capacity();
+    auto blocks_for = [cap](size_t n)
+    { return (n + cap - 1) / cap; };
+    std::vector<KVPair> merged;
+    DataBlock *prev = nullptr, *old = nullptr;
+    size_t i = 0;
+    while (i < late.size())
+    {
+        // 迟到点已排序：下一组的 floor 不早于上一组新链之后的块，先沿链前进，
+        // 相距较远时再经目录/搜索层定位
+        size_t hops = 0;
+        while (old && old->next() && old->next()->min_key() <= late[i].key && hops < kMaxMergeHops)
+        {
+            prev = old;
+            old = old->next();
+            ++hops;
+        }
+        if (!old || hops == kMaxMergeHops)
+            old = locate_floor_locked_(late[i].key, &prev);
+        assert(old && "late points require a non-empty data layer");
+        DataBlock *succ = old->next();
+
+        // 落入 old 的迟到点：key 小于后继块的 min_key
+        size_t j = i;
+        while (j < late.size() && (!succ || late[j].key < succ->min_key()))
+            ++j;
+
+        DataBlock *absorbed = nullptr;
+        const size_t n = old->size() + (j - i);
+        if (n > cap && succ && successors_.count(succ))
+        {
+            DataBlock *after = succ->next();
+            size_t j2 = j;
+            while (j2 < late.size() && (!after || late[j2].key < after->min_key()))
+                ++j2;
+            if (blocks_for(n + succ->size() + (j2 - j)) == blocks_for(n))
+            {
+                absorbed = succ;
+                succ = after;
+                j = j2;
+            }
+        }
+
+        // old 与 absorbed 在链上相邻，依次读出即为有序；同 key 时旧条目在前
+        const size_t na = old->size(), nb = absorbed ? absorbed->size() : 0;
+        auto entry = [&](size_t x)
+        { return x < na ? old->get_entry(x) : absorbed->get_entry(x - na); };
+        merged.clear();
+        merged.reserve(na + nb + (j - i));
+        size_t a = 0;
+        while (a < na + nb || i < j)
+        {
+            if (i < j && (a >= na + nb || late[i].key < entry(a).key))
+            {
+                { std::lock_guard<std::mutex> dg(g_dbg_mu); g_dbg_merged.insert(late[i].key); }
+                merged.push_back(late[i++]);
+            }
+            else
+                merged.push_back(entry(a++));
+        }
+
+        std::vector<DataBlock *> chain;
+        const KVPair *cur = merged.data();
+        size_t remaining = merged.size();
+        while (remaining > 0)
+        {
+            DataBlock *b = new DataBlock();
+            size_t consumed = b->build_from_sorted(cur, remaining);
+            if (!chain.empty())
+                chain.back()->set_next(b);
+            chain.push_back(b);
+            cur += consumed;
+            remaining -= consumed;
+        }
+        DataBlock *first = chain.front(), *last = chain.back();
+        last->set_next(succ);
+        if (prev)
+            prev->set_next(first);
+        else
+            data_head_.store(first, std::memory_order_release);
+        if (old == data_tail_ || (absorbed && absorbed == data_tail_))
+            data_tail_ = last;
+
+        tail_dir_.on_replace(old, first, last, absorbed);
+        // 叶层之外的块：新链除首块外都是后继块；old 本身是后继块时首块同样是
+        if (successors_.erase(old))
+            successors_.insert(first);
+        successors_.insert(chain.begin() + 1, chain.end());
+        old->set_replacement(first);
+        old->set_status(DataBlock::Status::RETIRED);
+        if (absorbed)
+        {
+            successors_.erase(absorbed);
+            absorbed->set_replacement(first);
+            absorbed->set_status(DataBlock::Status::RETIRED);
+        }
+        prev = chain.size() > 1 ? chain[chain.size() - 2] : prev;
+        replaced.push_back(IndexTask{std::move(chain), old, absorbed});
+        old = last;
+    }
+}
+
+// 入队并在后台线程休眠时唤醒它：生产者的 push（seq_cst 交换）与
+// index_sleeping_ 读取，和后台线程的 index_sleeping_ 写入与队列判空，
+// 构成 Dekker 式握手——两者至少有一方看到对方，唤醒不会丢失。
+// q_cv_ 只有后台线程在等（flush_index 等 done_cv_），notify_one 不会被别人接走。
+void SBTreeBase::push_index_task_(IndexTask &&task)
+{
+    idx_tasks_enqueued_.fetch_add(1, std::memory_order_acq_rel);
+    index_q_.push(std::move(task));
+    if (index_sleeping_.load(std::memory_order_seq_cst))
+    {
+        std::lock_guard<std::mutex> lk(q_mu_);
+        q_cv_.notify_one();
+    }
+}
+
+// 入队索引任务
+void SBTreeBase::enqueue_index_task_(std::vector<DataBlock *> &&blocks)
+{
+    if (blocks.empty())
+        return;
+    idx_batches_enqueued_.fetch_add(1);
+    idx_items_enqueued_.fetch_add(blocks.size());
+    push_index_task_(IndexTask{std::move(blocks), nullptr});
+}
+
+// 入队叶子替换任务（不计入批次统计）；与追加任务同一 FIFO，保证替换在其叶子追加之后应用
+void SBTreeBase::enqueue_replace_tasks_(std::vector<IndexTask> &&tasks)
+{
+    for (auto &t : tasks)
+        push_index_task_(std::move(t));
+}
+
+// 合并应用：连续的追加任务拼成一个 run（入队顺序即挂链顺序，整体有序），
+// 最后一次性追加、只发布一次快照。替换任务按序处理：目标叶子尚在待追加
+// 的 run 中时直接就地替换；否则已在搜索层中，立即替换（与待追加部分互不相交，
+// 不单独发布，换下的旧块随本批唯一一次发布退役）。
+void SBTreeBase::apply_index_batch_(std::vector<IndexTask> &batch)
+{
+    std::vector<DataBlock *> run;
+    std::vector<uint64_t> run_counts;
+    uint64_t appends = 0, replacements = 0;
+    std::unique_lock<std::shared_mutex> wlock(search_mu_);
+    const size_t base = learned_ ? learned_->leaf_size() : search_.leaf_size();
+    for (auto &task : batch)
+    {
+        if (!task.replaced)
+        {
+            run.insert(run.end(), task.blocks.begin(), task.blocks.end());
+            for (auto *b : task.blocks)
+                run_counts.push_back(b->size());
+            ++appends;
+            continue;
+        }
+        apply_replace_(task, run, run_counts, base);
+        ++replacements;
+    }
+    if (!run.empty())
+    {
+        if (learned_)
+            learned_->append_run(run, run_counts);
+        else
+            search_.append_run(run, run_counts);
+    }
+    else if (learned_)
+        learned_->publish();
+    else
+        search_.publish();
+    wlock.unlock();
+    // 搜索层已改指接替者：此后的定位不会再拿到旧块，仍可能访问它们的只剩此前
+    // 进入纪元临界区的读者与打开的游标，交给 EpochManager 在宽限期后释放。
+    // 替换任务按入队顺序应用，旧块释放时其接替链上后来被替换的块尚未交出
+    if (replacements > 0)
+        for (const auto &task : batch)
+            for (DataBlock *b : {task.replaced, task.absorbed})
+                if (b)
+                    EpochManager::instance().retire(b);
+    idx_batches_applied_.fetch_add(appends);
+    idx_items_applied_.fetch_add(run.size());
+    idx_apply_rounds_.fetch_add(1);
+}
+
+// 叶子计数覆盖“该叶子起、到下一个叶子之前”的整段链：写时复制拆分出的后继块
+// 不进入叶层，其条目计在前面的叶子名下。替换 old 时新链的条目增量记到 old
+// 所属的叶子（old 本身是叶子，或是登记过的后继块），新链中不接替叶子的块
+// 登记为该叶子的后继块。叶子下标 >= base 表示仍在待追加的 run 中。
+void SBTreeBase::apply_replace_(const IndexTask &task, std::vector<DataBlock *> &run,
+                                std::vector<uint64_t> &run_counts, size_t base)
+{
+    DataBlock *old = task.replaced;
+    uint64_t added = 0;
+    for (auto *b : task.blocks)
+        added += b->size();
+    added -= old->size();
+    if (task.absorbed)
+    {
+        added -= task.absorbed->size(); // 与 old 同属一个叶子
+        span_owner_.erase(task.absorbed);
+    }
+
+    const size_t npos = static_cast<size_t>(-1);
+    size_t owner = npos;
+    bool is_leaf = true;
+    auto it = std::find(run.begin(), run.end(), old);
+    auto span = span_owner_.find(old);
+    if (it != run.end())
+    {
+        *it = task.blocks.front();
+        owner = base + static_cast<size_t>(it - run.begin());
+    }
+    else if (span != span_owner_.end())
+    {
+        owner = span->second;
+        is_leaf = false;
+        span_owner_.erase(span);
+        if (owner < base)
+        {
+            if (learned_)
+                learned_->add_count(owner, added);
+            else
+                search_.add_count(owner, added);
+        }
+    }
+    else if (learned_)
+        learned_->replace_leaf(old, task.blocks.front(), added, &owner);
+    else
+        search_.replace_leaf(old, task.blocks.front(), added, &owner);
+
+    assert(owner != npos && "replaced block is neither a leaf nor a registered successor");
+    if (owner == npos)
+        return;
+    if (owner >= base)
+        run_counts[owner - base] += added;
+    for (size_t i = is_leaf ? 1 : 0; i < task.blocks.size(); ++i)
+        span_owner_[task.blocks[i]] = owner;
+}
+
+// 后台索引线程主循环
+void SBTreeBase::index_worker_()
+{
+    // 启用时间阈值时按其 1/4 的周期醒来，检查侧缓冲并交由写入策略检查活跃缓冲（至少 1ms）
+    const bool timed = opts_.seal_max_age.count() > 0;
+    const auto tick = std::max(std::chrono::milliseconds(1), opts_.seal_max_age / 4);
+
+    std::vector<IndexTask> batch;
+    for (;;)
+    {
+        if (timed)
+        {
+            publish_stale_late_();
+            on_index_tick_();
+        }
+
+        // 一次取走全部积压任务
+        batch.clear();
+        IndexTask task;
+        while (index_q_.try_pop(task))
+            batch.push_back(std::move(task));
+
+        if (batch.empty())
+        {
+            if (index_stop_.load(std::memory_order_acquire))
+                break;
+            index_sleeping_.store(true, std::memory_order_seq_cst);
+            {
+                std::unique_lock<std::mutex> lk(q_mu_);
+                auto ready = [&]
+                { return index_stop_.load() || !index_q_.empty(); };
+                if (timed)
+                    q_cv_.wait_for(lk, tick, ready); // 超时：回到循环顶部检查缓冲时长
+                else
+                    q_cv_.wait(lk, ready);
+            }
+            index_sleeping_.store(false, std::memory_order_relaxed);
+            continue;
+        }
+
+        apply_index_batch_(batch);
+        idx_tasks_done_.fetch_add(batch.size(), std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lk(q_mu_);
+        }
+        done_cv_.notify_all(); // 唤醒 flush_index 的等待者
+    }
+}
+
+// ========================= 批量装载 =========================
+// 每个线程负责连续的一段块下标，块边界即输入的 capacity 整数倍位置，
+// 因此各线程互不依赖，结果与串行逐块构建一致；全部完成后再按序链接。
+std::vector<DataBlock *> SBTreeBase::build_sorted_blocks_(const KVPair *data, size_t n,
+                                                          size_t threads)
+{
+    constexpr size_t kMinBlocksPerThread = 64; // 过小的输入不值得开线程
+    const size_t cap = DataBlock::capacity();
+    const size_t nblocks = (n + cap - 1) / cap;
+    std::vector<DataBlock *> blocks(nblocks, nullptr);
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max<size_t>(1, std::min(threads, nblocks / kMinBlocksPerThread));
+
+    auto work = [&](size_t t)
+    {
+        const size_t b0 = nblocks * t / threads, b1 = nblocks * (t + 1) / threads;
+        for (size_t b = b0; b < b1; ++b)
+        {
+            const size_t off = b * cap;
+            auto *blk = new DataBlock();
+            blk->build_from_sorted(data + off, std::min(cap, n - off));
+            blocks[b] = blk;
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t)
+        pool.emplace_back(work, t);
+    work(0);
+    for (auto &th : pool)
+        th.join();
+
+    for (size_t b = 1; b < nblocks; ++b)
+        blocks[b - 1]->set_next(blocks[b]);
+    return blocks;
+}
+
+void SBTreeBase::bulk_load(const KVPair *data, size_t n, size_t threads)
+{
+    if (n == 0)
+        return;
+    assert(std::is_sorted(data, data + n, [](const KVPair &a, const KVPair &b)
+                          { return a.key < b.key; }) &&
+           "bulk_load(): input must be sorted by key");
+    publish_run_(build_sorted_blocks_(data, n, threads), n);
+    flush_index();
+}
+
+size_t SBTreeBase::bulk_load_stream(const std::function<size_t(KVPair *, size_t)> &fill,
+                                    size_t threads)
+{
+    // 每段约 4096 块（约 1M 条）：足够分给多个线程，缓冲也不至于过大
+    std::vector<KVPair> buf(DataBlock::capacity() * 4096);
+    size_t total = 0;
+    for (;;)
+    {
+        const size_t got = fill(buf.data(), buf.size());
+        if (got == 0)
+            break;
+        assert(std::is_sorted(buf.data(), buf.data() + got, [](const KVPair &a, const KVPair &b)
+                              { return a.key < b.key; }) &&
+               "bulk_load_stream(): input must be sorted by key");
+        publish_run_(build_sorted_blocks_(buf.data(), got, threads), got);
+        total += got;
+    }
+    flush_index();
+    return total;
+}
+
+// ========================= 基本操作 =========================
+// 等待索引完成：此前入队的全部任务都已应用
+void SBTreeBase::flush_index()
+{
+    const uint64_t target = idx_tasks_enqueued_.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lk(q_mu_);
+    done_cv_.wait(lk, [&]
+                  { return idx_tasks_done_.load(std::memory_order_acquire) >= target; });
+}
+
+// 查找
+bool SBTreeBase::lookup(Key k, Value *out) const
+{
+    if (opts_.fresh_reads)
+        return lookup_fresh_(k, out);
+    return lookup_published_(k, out);
+}
+
+bool SBTreeBase::lookup_published_(Key k, Value *out) const
+{
+    EpochGuard guard; // 候选块可能随后被替换并退役
+    return lookup_from_(find_candidate_(k), k, out);
+}
+
+// 候选块为空时从表头开始；同 key 可能跨块，沿链继续直到后继 min_key > k
+bool SBTreeBase::lookup_from_(DataBlock *blk, Key k, Value *out) const
+{
+    if (!blk)
+        blk = data_head_.load(std::memory_order_acquire);
+    while (blk)
+    {
+        Value v{};
+        if (blk->find(k, v))
+        {
+            if (out)
+                *out = v;
+            return true;
+        }
+        DataBlock *nxt = blk->next();
+        if (!nxt || nxt->min_key() > k)
+            break;
+        blk = nxt;
+    }
+    return overflow_.lookup(k, out);
+}
+
+// 批量点查：尾部目录命中的 key 直接取其块，其余一次交给搜索层批量定位；
+// 块内查找提前 2D 个 key 预取块头与 N-ary 表、提前 D 个 key 预取目标桶，
+// 轮到该 key 时其所需的缓存行多已到达。候选块与逐个 lookup 相同，结果一致；
+// 启用新鲜读时未命中的 key 逐个走 lookup_fresh_（命中的 key 已由已发布数据给出）。
+// 不预先排序：实测排序的开销超过共享定位省下的下降，按调用方顺序处理时
+// 升序或成簇的 key 仍可经近邻判定共享定位。
+size_t SBTreeBase::lookup_batch(const Key *keys, size_t n, Value *values, bool *found) const
+{
+    constexpr size_t D = 8; // 块内查找的预取距离（key 数）
+    if (n == 0)
+        return 0;
+    EpochGuard guard;
+
+    // 1) 候选块
+    std::vector<DataBlock *> cand(n);
+    size_t rest = 0;
+    for (size_t i = 0; i < n; ++i)
+        if (!(cand[i] = tail_find_(keys[i])))
+            ++rest;
+    if (rest == n)
+        index_find_batch_(keys, n, cand.data());
+    else if (rest > 0)
+    {
+        std::vector<Key> rest_keys;
+        std::vector<size_t> rest_pos;
+        rest_keys.reserve(rest);
+        rest_pos.reserve(rest);
+        for (size_t i = 0; i < n; ++i)
+            if (!cand[i])
+            {
+                rest_keys.push_back(keys[i]);
+                rest_pos.push_back(i);
+            }
+        std::vector<DataBlock *> found_blks(rest);
+        index_find_batch_(rest_keys.data(), rest, found_blks.data());
+        for (size_t j = 0; j < rest; ++j)
+            cand[rest_pos[j]] = found_blks[j];
+    }
+
+    // 2) 块内查找流水线
+    for (size_t i = 0; i < std::min(n, 2 * D); ++i)
+        if (cand[i])
+            cand[i]->prefetch_header();
+    size_t hits = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (i + 2 * D < n && cand[i + 2 * D])
+            cand[i + 2 * D]->prefetch_header();
+        if (i + D < n && cand[i + D])
+            cand[i + D]->prefetch_find(keys[i + D]);
+        Value v{};
+        bool hit = lookup_from_(cand[i], keys[i], &v);
+        if (!hit && opts_.fresh_reads)
+            hit = lookup_fresh_(keys[i], &v); // 已发布数据未命中：与 lookup 一样补查写入前端
+        if (hit)
+        {
+            values[i] = v;
+            ++hits;
+        }
+        if (found)
+            found[i] = hit;
+    }
+    return hits;
+}
+
+// ========================= as-of 查询 =========================
+// keys[from, n) 中第一个 > k 的下标（调用方保证 keys[0, from) <= k）；
+// 相邻采样点多落在附近，自 from 起指数扩展再二分
+static size_t gallop_upper(const Key *keys, size_t n, size_t from, Key k) noexcept
+{
+    if (from >= n || keys[from] > k)
+        return from;
+    size_t lo = from, step = 1; // keys[lo] <= k
+    while (lo + step < n && keys[lo + step] <= k)
+    {
+        lo += step;
+        step <<= 1;
+    }
+    return std::upper_bound(keys + lo + 1, keys + std::min(lo + step, n), k) - keys;
+}
+
+// 先沿链前进（通常 k 仍在当前块或其后一两块），其次尾部目录，再自叶层
+// 提示处指数搜索；最后沿链越过 min_key <= k 的块（拆分出的后继块、同 key 跨块）
+DataBlock *SBTreeBase::floor_block_(Key k, DataBlock *blk, size_t *leaf) const
+{
+    if (blk)
+    {
+        for (int hop = 0;; ++hop)
+        {
+            DataBlock *nxt = blk->next();
+            if (!nxt || nxt->min_key() > k)
+                return blk;
+            if (hop == Finger::kMaxHops)
+                break;
+            blk = nxt;
+            if (*leaf != static_cast<size_t>(-1))
+                ++*leaf; // 提示偏大时由指数搜索识别并放弃
+        }
+    }
+    blk = tail_find_(k);
+    if (!blk)
+        blk = index_find_near_(k, leaf);
+    if (!blk)
+    {
+        blk = data_head_.load(std::memory_order_acquire);
+        if (!blk || blk->min_key() > k)
+            return nullptr;
+    }
+    for (DataBlock *nxt; (nxt = blk->next()) && nxt->min_key() <= k;)
+        blk = nxt;
+    return blk;
+}
+
+bool SBTreeBase::lookup_floor(Key k, KVPair *out) const
+{
+    bool found = false;
+    sample_asof(k, 0, 1, out, &found);
+    return found;
+}
+
+size_t SBTreeBase::sample_asof(Key start, Key step, size_t count, KVPair *out, bool *found) const
+{
+    EpochGuard guard;
+    std::shared_ptr<const OverflowStore::Run> ov;
+    if (!overflow_.empty())
+        ov = overflow_.snapshot();
+    size_t ov_pos = 0; // 溢出区 [0, ov_pos) <= t
+
+    DataBlock *blk = nullptr;               // floor(t) 所在块（t 小于全部数据时为空）
+    size_t pos = 0;                         // blk 内 [0, pos) <= t
+    size_t leaf = static_cast<size_t>(-1); // blk 的叶层提示
+    size_t hits = 0;
+    Key t = start;
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i > 0)
+            t = step > std::numeric_limits<Key>::max() - t ? std::numeric_limits<Key>::max() : t + step;
+
+        DataBlock *b = floor_block_(t, blk, &leaf);
+        if (b != blk)
+        {
+            blk = b;
+            pos = 0;
+        }
+        if (blk)
+            pos = gallop_upper(blk->keys(), blk->size(), pos, t);
+        if (ov)
+            ov_pos = gallop_upper(ov->keys.data(), ov->keys.size(), ov_pos, t);
+
+        // 两侧各自的 floor 取较大者，同 key 时数据层优先
+        const bool has_blk = blk && pos > 0;
+        const bool has_ov = ov_pos > 0;
+        if (!has_blk && !has_ov)
+        {
+            if (found)
+                found[i] = false;
+            continue;
+        }
+        if (has_blk && (!has_ov || blk->keys()[pos - 1] >= ov->keys[ov_pos - 1]))
+            out[i] = blk->get_entry(pos - 1);
+        else
+            out[i] = KVPair{ov->keys[ov_pos - 1], ov->vals[ov_pos - 1]};
+        if (found)
+            found[i] = true;
+        ++hits;
+    }
+    return hits;
+}
+
+// ========================= 降采样 =========================
+// 游标产出的每一段（块内或溢出区内连续数组）按桶切开：段首 key 确定桶号，
+// 段尾不越过桶终点时整段归入该桶，否则在段内指数搜索桶终点。同一个桶可能
+// 跨多段（块边界、与溢出区交错），各段结果依次合并。
+size_t SBTreeBase::downsample(Key l, Key r, Key width, unsigned aggs, Bucket *out, size_t cap) const
+{
+    if (l > r || width == 0)
+        return 0;
+    // 桶数可达 2^64（l = 0、r = Key 上限、width = 1），+1 会回绕为 0，按上限饱和
+    const uint64_t steps = (r - l) / width;
+    const uint64_t total = steps == std::numeric_limits<uint64_t>::max() ? steps : steps + 1;
+    const size_t nb = static_cast<size_t>(std::min<uint64_t>(total, cap));
+    if (nb == 0)
+        return total;
+    for (size_t b = 0; b < nb; ++b)
+        out[b] = Bucket{l + b * width, 0, std::numeric_limits<Value>::max(), 0, 0, 0, 0};
+    const Key hi = nb == total ? r : l + nb * width - 1; // 只扫描写出的桶
+
+    const bool reduce = (aggs & (AGG_MIN | AGG_MAX | AGG_SUM)) != 0;
+    auto cur = open_range_cursor(l, hi);
+    Span sp;
+    while (cur.next_span(&sp))
+    {
+        for (size_t i = 0; i < sp.n;)
+        {
+            const size_t b = static_cast<size_t>((sp.keys[i] - l) / width);
+            const Key end = b + 1 == nb ? hi : l + (b + 1) * width - 1;
+            const size_t j = sp.keys[sp.n - 1] <= end ? sp.n : gallop_upper(sp.keys, sp.n, i, end);
+            Bucket &o = out[b];
+            if (reduce)
+                simd_min_max_sum(sp.values + i, j - i, &o.min, &o.max, &o.sum);
+            o.count += j - i;
+            o.last_key = sp.keys[j - 1];
+            o.last = sp.values[j - 1];
+            i = j;
+        }
+    }
+
+    for (size_t b = 0; b < nb; ++b)
+    {
+        Bucket &o = out[b];
+        if (!(aggs & AGG_MIN) || o.count == 0)
+            o.min = 0;
+        if (!(aggs & AGG_MAX))
+            o.max = 0;
+        if (!(aggs & AGG_SUM))
+            o.sum = 0;
+        if (!(aggs & AGG_LAST))
+            o.last_key = o.last = 0;
+    }
+    return total;
+}
+
+// 扫描：按段整体追加，不逐条构造 KVPair
+size_t SBTreeBase::scan(Key l, Key r, std::vector<Value> &out) const
+{
+    if (l > r)
+        return 0;
+    auto cur = open_range_cursor(l, r);
+    size_t added = 0;
+    Span sp;
+    while (cur.next_span(&sp))
+    {
+        out.insert(out.end(), sp.values, sp.values + sp.n);
+        added += sp.n;
+    }
+    return added;
+}
+
+size_t SBTreeBase::scan_spans(Key l, Key r, const std::function<void(const Span &)> &fn) const
+{
+    if (l > r)
+        return 0;
+    auto cur = open_range_cursor(l, r);
+    size_t total = 0;
+    Span sp;
+    while (cur.next_span(&sp))
+    {
+        fn(sp);
+        total += sp.n;
+    }
+    return total;
+}
+
+// 过滤扫描：每轮在输出末尾预留 kBuf 个位置交给游标直接写入，再截到实际命中数；
+// 命中稀疏时一轮即可扫完整个区间
+size_t SBTreeBase::scan_filtered(Key l, Key r, Value lo, Value hi, std::vector<Key> &keys,
+                                 std::vector<Value> &values) const
+{
+    constexpr size_t kBuf = 4096;
+    if (l > r || lo > hi)
+        return 0;
+    auto cur = open_range_cursor(l, r);
+    size_t total = 0;
+    for (;;)
+    {
+        const size_t kb = keys.size(), vb = values.size();
+        keys.resize(kb + kBuf);
+        values.resize(vb + kBuf);
+        const size_t got = cur.next_filtered(lo, hi, keys.data() + kb, values.data() + vb, kBuf);
+        keys.resize(kb + got);
+        values.resize(vb + got);
+        total += got;
+        if (got == 0)
+            return total;
+    }
+}
+
+size_t SBTreeBase::scan_stride(Key l, Key r, Key width, std::vector<KVPair> &out) const
+{
+    if (l > r || width == 0)
+        return 0;
+    auto cur = open_range_cursor(l, r);
+    size_t added = 0;
+    KVPair kv;
+    while (cur.next_stride(width, &kv))
+    {
+        out.push_back(kv);
+        ++added;
+    }
+    return added;
+}
+
+// ========================= 并行扫描 =========================
+size_t SBTreeBase::resolve_threads_(size_t threads)
+{
+    return threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+// 边界取自搜索层叶层（均分覆盖 [l, r] 的叶子），分区天然与块对齐；
+// 尚未被索引的最新块归入最后一个分区
+std::vector<SBTreeBase::KeyRange> SBTreeBase::scan_partitions(Key l, Key r, size_t max_parts) const
+{
+    std::vector<KeyRange> parts;
+    if (l > r)
+        return parts;
+    std::vector<Key> cuts;
+    if (learned_)
+        learned_->split_keys(l, r, max_parts, kMinPartitionLeaves, cuts);
+    else
+        search_.split_keys(l, r, max_parts, kMinPartitionLeaves, cuts);
+    Key lo = l;
+    for (Key c : cuts)
+    {
+        parts.push_back({lo, c - 1});
+        lo = c;
+    }
+    parts.push_back({lo, r});
+    return parts;
+}
+
+size_t SBTreeBase::parallel_scan(Key l, Key r, const std::function<void(size_t, const Span &)> &fn,
+                                 size_t threads) const
+{
+    const auto parts = scan_partitions(l, r, partition_target_(threads));
+    std::atomic<size_t> total{0};
+    run_partitions_(parts, [&](size_t p, RangeCursor &cur)
+                    {
+                        size_t n = 0;
+                        Span sp;
+                        while (cur.next_span(&sp))
+                        {
+                            fn(p, sp);
+                            n += sp.n;
+                        }
+                        total.fetch_add(n, std::memory_order_relaxed); },
+                    threads);
+    return total.load();
+}
+
+// 领取分区：共享计数器自增，先完成的线程继续取后面的分区
+void SBTreeBase::run_partitions_(const std::vector<KeyRange> &parts,
+                                 const std::function<void(size_t, RangeCursor &)> &fn,
+                                 size_t threads) const
+{
+    threads = std::min(resolve_threads_(threads), parts.size());
+    std::atomic<size_t> next{0};
+    std::mutex error_mu;
+    std::exception_ptr error;
+    auto work = [&]()
+    {
+        for (size_t p; (p = next.fetch_add(1, std::memory_order_relaxed)) < parts.size();)
+        {
+            try
+            {
+                auto cur = open_range_cursor(parts[p].lo, parts[p].hi);
+                fn(p, cur);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> g(error_mu);
+                if (!error)
+                    error = std::current_exception();
+                next.store(parts.size(), std::memory_order_relaxed); // 其余分区不再领取
+            }
+        }
+    };
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t)
+        pool.emplace_back(work);
+    work();
+    for (auto &th : pool)
+        th.join();
+    if (error)
+        std::rethrow_exception(error);
+}
+
+// ========================= 计数与名次 =========================
+// 数据层中 key <= k 的条目数：搜索层给出 floor 叶子及其之前的条目总数，
+// 再沿链累加从该叶子起 key <= k 的部分（通常只涉及一两个块）
+uint64_t SBTreeBase::data_rank_le_(Key k) const
+{
+    uint64_t n = 0;
+    DataBlock *blk = index_find_(k, &n);
+    if (!blk)
+        blk = data_head_.load(std::memory_order_acquire);
+    for (; blk && blk->min_key() <= k; blk = blk->next())
+    {
+        const size_t sz = blk->size();
+        if (blk->get_entry(sz - 1).key <= k)
+            n += sz;
+        else
+        {
+            n += blk->lower_bound(k + 1); // k 小于块内最大 key，k + 1 不会溢出
+            break;
+        }
+    }
+    return n;
+}
+
+// 数据层第 a 个条目（0 起）：搜索层按名次定位叶子，再沿链扣除块长
+DataBlock *SBTreeBase::data_select_(uint64_t a, size_t *idx) const
+{
+    uint64_t off = a;
+    DataBlock *blk = index_select_(a, &off);
+    if (!blk)
+    {
+        blk = data_head_.load(std::memory_order_acquire);
+        off = a;
+    }
+    while (blk && off >= blk->size())
+    {
+        off -= blk->size();
+        blk = blk->next();
+    }
+    *idx = static_cast<size_t>(off);
+    return blk;
+}
+
+// 按游标的归并顺序（相同 key 时数据层在前），前 g 个条目由 a 个数据层条目与
+// b 个溢出区条目组成：二分最小的 b，使溢出区第 b 个条目不先于数据层第 g-b-1 个
+void SBTreeBase::split_rank_(uint64_t g, const OverflowStore::Run &ov, uint64_t *a,
+                             uint64_t *b) const
+{
+    uint64_t lo = 0, hi = std::min<uint64_t>(g, ov.size());
+    while (lo < hi)
+    {
+        const uint64_t mid = lo + (hi - lo) / 2;
+        size_t idx = 0;
+        DataBlock *blk = data_select_(g - mid - 1, &idx);
+        if (!blk || ov.keys[mid] < blk->get_entry(idx).key)
+            lo = mid + 1; // 数据层不足或溢出区条目更靠前：需要更多溢出区条目
+        else
+            hi = mid;
+    }
+    *a = g - lo;
+    *b = lo;
+}
+
+size_t SBTreeBase::rank(Key k) const
+{
+    EpochGuard guard;
+    uint64_t n = k == 0 ? 0 : data_rank_le_(k - 1);
+    if (!overflow_.empty())
+        n += overflow_.snapshot()->lower_bound(k);
+    return static_cast<size_t>(n);
+}
+
+size_t SBTreeBase::count(Key l, Key r) const
+{
+    if (l > r)
+        return 0;
+    EpochGuard guard;
+    const uint64_t hi = data_rank_le_(r);
+    const uint64_t lo = l == 0 ? 0 : data_rank_le_(l - 1);
+    uint64_t n = hi > lo ? hi - lo : 0; // 两次查询之间索引推进时避免下溢
+    if (!overflow_.empty())
+    {
+        auto ov = overflow_.snapshot();
+        n += ov->upper_bound(r) - ov->lower_bound(l);
+    }
+    return static_cast<size_t>(n);
+}
+
+bool SBTreeBase::select(size_t i, KVPair *out) const
+{
+    EpochGuard guard;
+    std::shared_ptr<const OverflowStore::Run> ov;
+    if (!overflow_.empty())
+        ov = overflow_.snapshot();
+    uint64_t a = i, b = 0;
+    if (ov)
+        split_rank_(i, *ov, &a, &b);
+
+    size_t idx = 0;
+    DataBlock *blk = data_select_(a, &idx);
+    if (ov && b < ov->size() && (!blk || ov->keys[b] < blk->get_entry(idx).key))
+    {
+        if (out)
+            *out = KVPair{ov->keys[b], ov->vals[b]};
+        return true;
+    }
+    if (!blk)
+        return false;
+    if (out)
+        *out = blk->get_entry(idx);
+    return true;
+}
+
+// ========================= RangeCursor =========================
+SBTreeBase::RangeCursor::RangeCursor(const SBTreeBase *owner, Key l, Key r, DataBlock *start, size_t leaf)
+    : owner_(owner), l_(l), r_(r), hi_(r), blk_(start), idx_(0)
+{
+    // 溢出区非空时取一次快照并定位到 [l, r] 对应的下标区间
+    if (owner_ && l_ <= r_ && !owner_->overflow_.empty())
+    {
+        ov_ = owner_->overflow_.snapshot();
+        ov_pos_ = ov_->lower_bound(l_);
+        ov_end_ = ov_->upper_bound(r_);
+    }
+    pf_done_ = !owner_ || owner_->opts_.scan_prefetch_blocks == 0;
+    if (!blk_ || blk_->min_key() > r_)
+    {
+        blk_ = nullptr;
+        return;
+    }
+    seek_leaf_ = leaf;
+    if (!pf_done_ && leaf != static_cast<size_t>(-1))
+    {
+        pf_next_ = leaf + 1;
+        prefetch_ahead_();
+    }
+    seek_first_pos_();
+}
+
+void SBTreeBase::RangeCursor::seek_first_pos_()
+{
+    idx_ = blk_->lower_bound(l_);
+    settle_();
+}
+
+bool SBTreeBase::RangeCursor::settle_()
+{
+    for (;;)
+    {
+        while (blk_ && idx_ >= blk_->size())
+        {
+            DataBlock *nx = blk_->next();
+            if (!nx && blk_->status() == DataBlock::Status::RETIRED && blk_->size() > 0)
+            {
+                // 遍历期间被替换的块仍按旧内容读完并沿旧 next 前进；只有被替换的
+                // 尾块 next 永远为空，此后追加的块挂在接替链上，改从接替链上已读过
+                // 的最后一个 key 之后继续
+                const Key last = blk_->keys()[blk_->size() - 1];
+                DataBlock *b = live_(blk_);
+                while (b && b->size() > 0 && b->keys()[b->size() - 1] <= last)
+                    b = b->next();
+                if (b && last < r_ && b->min_key() <= r_)
+                {
+                    blk_ = b;
+                    idx_ = b->lower_bound(last + 1);
+                    continue;
+                }
+            }
+            blk_ = nx;
+            if (!blk_ || blk_->min_key() > r_)
+            {
+                blk_ = nullptr;
+                break;
+            }
+            idx_ = 0;
+            // 候选块可能落后于 l（索引滞后），后继块同样需跳过 < l 的条目
+            if (blk_->min_key() < l_)
+                idx_ = blk_->lower_bound(l_);
+            if (!pf_done_)
+                prefetch_ahead_();
+        }
+        if (blk_ && blk_->get_entry(idx_).key > r_)
+            blk_ = nullptr;
+        if (!blk_ || skip_pos_ == skip_.size())
+            return blk_ != nullptr;
+        // 新鲜读：该 key 的条目由快照 run 提供（同 key 可能跨块，跳过后再检查）
+        const Key k = blk_->keys()[idx_];
+        while (skip_pos_ < skip_.size() && skip_[skip_pos_] < k)
+            ++skip_pos_;
+        if (skip_pos_ == skip_.size() || skip_[skip_pos_] != k)
+            return true;
+        idx_ = blk_->lower_bound(k + 1); // k < 水位，不会溢出
+    }
+}
+
+bool SBTreeBase::RangeCursor::next(KVPair *out)
+{
+    const bool has_blk = settle_();
+    const bool has_ov = ov_pos_ < ov_end_;
+    if (!has_blk && !has_ov)
+        return false;
+
+    // 数据层与溢出区按 key 归并；相同 key 时数据层优先
+    if (has_ov && (!has_blk || ov_->keys[ov_pos_] < blk_->get_entry(idx_).key))
+    {
+        if (out)
+            *out = KVPair{ov_->keys[ov_pos_], ov_->vals[ov_pos_]};
+        ++ov_pos_;
+        return true;
+    }
+    if (out)
+        *out = blk_->get_entry(idx_);
+    ++idx_;
+    return true;
+}
+
+// 块间由 next_ 链接、在堆上并不相邻，每次跨块都是硬件预取器无法预测的冷缺失。
+// 起始叶子已知时（经搜索层打开）立即预取其后 depth 个块，否则在跨过首个块边界时
+// 再定位当前块的叶层下标；此后每进入一个新块补一个，使预取始终领先约 depth 块。
+// 只预取 min_key <= r 的叶子，短区间不会预取区间外的块。叶层与链不必严格对齐
+// （拆分出的后继块不在叶层中），预取只是提示，不影响正确性。
+void SBTreeBase::RangeCursor::prefetch_ahead_()
+{
+    size_t target;
+    if (pf_next_ == static_cast<size_t>(-1))
+    {
+        size_t leaf = seek_leaf_;
+        if (!owner_->index_find_near_(blk_->min_key(), &leaf))
+        {
+            pf_done_ = true; // 尚未被索引（例如仍只在尾部）
+            return;
+        }
+        seek_leaf_ = leaf;
+        pf_next_ = leaf + 1;
+    }
+    if (hint_len_ == 0) // 首次：一次预取 depth 个
+        target = pf_next_ + owner_->opts_.scan_prefetch_blocks;
+    else
+        target = pf_next_ + 1;
+
+    for (; pf_next_ < target; ++pf_next_)
+    {
+        if (pf_next_ >= hint_base_ + hint_len_)
+        {
+            hint_base_ = pf_next_;
+            hint_len_ = owner_->index_copy_leaves_(pf_next_, r_, hint_, kHintBatch);
+            if (hint_len_ == 0)
+            {
+                pf_done_ = true; // 叶层已到尽头或越过区间右端
+                return;
+            }
+        }
+        hint_[pf_next_ - hint_base_]->prefetch();
+    }
+}
+
+// 当前可连续产出的一段：数据层取到块尾或区间右端为止，溢出区非空时
+// 再截到下一个溢出区 key（相同 key 数据层在前）；溢出区的段取到下一个
+// 数据层 key 之前（严格小于）。段非空。
+bool SBTreeBase::RangeCursor::peek_span_(Span *out, bool *from_ov)
+{
+    const bool has_blk = settle_();
+    const bool has_ov = ov_pos_ < ov_end_;
+    if (!has_blk && !has_ov)
+        return false;
+
+    if (has_ov && (!has_blk || ov_->keys[ov_pos_] < blk_->keys()[idx_]))
+    {
+        const size_t end = has_blk ? std::min(ov_end_, ov_->lower_bound(blk_->keys()[idx_])) : ov_end_;
+        *out = Span{ov_->keys.data() + ov_pos_, ov_->vals.data() + ov_pos_, end - ov_pos_};
+        *from_ov = true;
+        return true;
+    }
+    const Key *keys = blk_->keys();
+    const size_t n = blk_->size();
+    size_t end = keys[n - 1] <= r_ ? n : blk_->lower_bound(r_ + 1); // 此时 r_ < 块内最大 key
+    if (has_ov)
+    {
+        const Key ok = ov_->keys[ov_pos_];
+        if (keys[end - 1] > ok)
+            end = blk_->lower_bound(ok + 1); // ok < 块内某 key，不会溢出
+    }
+    if (skip_pos_ < skip_.size() && keys[end - 1] >= skip_[skip_pos_])
+        end = blk_->lower_bound(skip_[skip_pos_]); // settle_ 之后当前 key 小于它，段仍非空
+    *out = Span{keys + idx_, blk_->values() + idx_, end - idx_};
+    *from_ov = false;
+    return true;
+}
+
+bool SBTreeBase::RangeCursor::next_span(Span *out)
+{
+    bool from_ov = false;
+    if (!peek_span_(out, &from_ov))
+        return false;
+    if (from_ov)
+        ov_pos_ += out->n;
+    else
+        idx_ += out->n;
+    return true;
+}
+
+size_t SBTreeBase::RangeCursor::next_batch(Key *keys, Value *values, size_t cap)
+{
+    size_t filled = 0;
+    Span sp;
+    bool from_ov = false;
+    while (filled < cap && peek_span_(&sp, &from_ov))
+    {
+        const size_t m = std::min(sp.n, cap - filled);
+        std::copy(sp.keys, sp.keys + m, keys + filled);
+        std::copy(sp.values, sp.values + m, values + filled);
+        filled += m;
+        if (from_ov)
+            ov_pos_ += m;
+        else
+            idx_ += m;
+    }
+    return filled;
+}
+
+// 数据层：k 不超过当前块最大 key 时块内二分；否则定位 floor(k - 1) 所在块（其后才
+// 可能出现 >= k 的元素；同 key 跨块时 floor(k) 会越过前一块中的 k）——沿链试探
+// 近邻块、尾部目录、自叶层提示指数搜索，依次退化（见 floor_block_）。索引滞后时
+// 候选可能落在当前块之前，此时改从当前块沿链前进，游标不会后退。跨块后按新位置
+// 重启预取流水线。溢出区自当前位置指数搜索。
+bool SBTreeBase::RangeCursor::seek(Key k)
+{
+    if (k > hi_)
+    {
+        blk_ = nullptr;
+        ov_pos_ = ov_end_;
+        return false;
+    }
+    if (ov_pos_ < ov_end_ && k > 0)
+        ov_pos_ = gallop_upper(ov_->keys.data(), ov_end_, ov_pos_, k - 1);
+
+    if (settle_() && blk_->keys()[idx_] < k)
+    {
+        const size_t n = blk_->size();
+        if (blk_->keys()[n - 1] >= k)
+            idx_ = blk_->lower_bound(k);
+        else
+        {
+            DataBlock *b = owner_->floor_block_(k - 1, blk_, &seek_leaf_);
+            if (!b || b->min_key() < blk_->min_key())
+                b = blk_;
+            while (b && b->min_key() <= r_ && b->keys()[b->size() - 1] < k)
+                b = b->next();
+            if (!b || b->min_key() > r_)
+                blk_ = nullptr;
+            else
+            {
+                blk_ = b;
+                idx_ = b->lower_bound(k);
+                if (!pf_done_)
+                {
+                    pf_next_ = static_cast<size_t>(-1); // 自新块重新定位预取起点
+                    hint_len_ = 0;
+                    prefetch_ahead_();
+                }
+            }
+        }
+        settle_(); // 落点可能是新鲜读跳过的 key
+    }
+    return valid();
+}
+
+bool SBTreeBase::RangeCursor::next_stride(Key width, KVPair *out)
+{
+    KVPair kv;
+    if (width == 0 || !next(&kv))
+        return false;
+    if (out)
+        *out = kv;
+    const Key w = (kv.key - l_) / width; // 所在窗口序号
+    if (w >= (hi_ - l_) / width)
+    {
+        blk_ = nullptr; // 已是最后一个窗口（下一窗口起点可能溢出 Key）
+        ov_pos_ = ov_end_;
+    }
+    else
+        seek(l_ + (w + 1) * width);
+    return true;
+}
+
+// 数据层的段先查所在块的值统计，不可能命中时整段跳过（不读值数组）；
+// 其余每次至多 chunk 个交给过滤内核，输出空间始终足够整段写出
+size_t SBTreeBase::RangeCursor::next_filtered(Value lo, Value hi, Key *keys, Value *values, size_t cap)
+{
+    if (lo > hi)
+        return 0;
+    const size_t chunk = std::min(cap, kFilterChunk);
+    size_t filled = 0;
+    Span sp;
+    bool from_ov = false;
+    while (chunk > 0 && cap - filled >= chunk && peek_span_(&sp, &from_ov))
+    {
+        if (!from_ov && (blk_->value_max() < lo || blk_->value_min() > hi))
+        {
+            idx_ += sp.n;
+            continue;
+        }
+        const size_t m = std::min(sp.n, chunk);
+        filled += simd_filter_range(sp.keys, sp.values, m, lo, hi, keys + filled, values + filled);
+        if (from_ov)
+            ov_pos_ += m;
+        else
+            idx_ += m;
+    }
+    return filled;
+}
+
+size_t SBTreeBase::RangeCursor::next_batch(std::vector<KVPair> &out, size_t limit)
+{
+    size_t added = 0;
+    Span sp;
+    bool from_ov = false;
+    while (added < limit && peek_span_(&sp, &from_ov))
+    {
+        const size_t m = std::min(sp.n, limit - added);
+        const size_t base = out.size();
+        out.resize(base + m); // 按段扩容（几何增长），再逐项写入
+        for (size_t i = 0; i < m; ++i)
+            out[base + i] = KVPair{sp.keys[i], sp.values[i]};
+        added += m;
+        if (from_ov)
+            ov_pos_ += m;
+        else
+            idx_ += m;
+    }
+    return added;
+}
+
+// 新鲜读：数据层与溢出区只读到 data_end 之前且跳过快照 run 中已有的 key，
+// run 与该范围内的溢出区归并后作为游标的溢出流（二者 key 不相交）
+SBTreeBase::RangeCursor SBTreeBase::open_range_cursor(Key l, Key r) const
+{
+    Key data_end = 0;
+    std::vector<Key> skip;
+    std::shared_ptr<const OverflowStore::Run> fresh;
+    if (!opts_.fresh_reads || l > r || !(fresh = fresh_overlay_(l, r, &data_end, &skip)))
+        return open_published_cursor_(l, r);
+
+    RangeCursor cur = data_end > l ? open_published_cursor_(l, std::min(r, data_end - 1))
+                                   : RangeCursor(this, 1, 0, nullptr);
+    cur.l_ = l;
+    if (cur.ov_ && cur.ov_pos_ < cur.ov_end_)
+    {
+        const OverflowStore::Run &ov = *cur.ov_;
+        auto run = std::make_shared<OverflowStore::Run>();
+        run->keys.reserve(cur.ov_end_ - cur.ov_pos_ + fresh->size());
+        run->vals.reserve(cur.ov_end_ - cur.ov_pos_ + fresh->size());
+        size_t i = cur.ov_pos_, j = 0, s = 0;
+        while (i < cur.ov_end_ || j < fresh->size())
+        {
+            if (i < cur.ov_end_)
+            {
+                while (s < skip.size() && skip[s] < ov.keys[i])
+                    ++s;
+                if (s < skip.size() && skip[s] == ov.keys[i])
+                {
+                    ++i; // 已随快照 run 复制
+                    continue;
+                }
+            }
+            if (j == fresh->size() || (i < cur.ov_end_ && ov.keys[i] < fresh->keys[j]))
+            {
+                run->keys.push_back(ov.keys[i]);
+                run->vals.push_back(ov.vals[i++]);
+            }
+            else
+            {
+                run->keys.push_back(fresh->keys[j]);
+                run->vals.push_back(fresh->vals[j++]);
+            }
+        }
+        fresh = std::move(run);
+    }
+    cur.ov_ = std::move(fresh);
+    cur.ov_pos_ = 0;
+    cur.ov_end_ = cur.ov_->size();
+    cur.skip_ = std::move(skip);
+    cur.hi_ = r;
+    cur.settle_();
+    return cur;
+}
+
+SBTreeBase::RangeCursor SBTreeBase::open_published_cursor_(Key l, Key r) const
+{
+    if (l > r)
+        return RangeCursor(this, 1, 0, nullptr);
+    EpochGuard guard; // 游标构造时沿用本临界区的纪元登记，覆盖这里取得的起始块
+    // 尾部目录命中：区间落在最新的块上，这些块通常仍在缓存中，不预取
+    if (DataBlock *blk = tail_find_(l))
+    {
+        RangeCursor cur(this, l, r, blk);
+        cur.pf_done_ = true;
+        return cur;
+    }
+    // 下降搜索层时顺带得到起始叶子下标，预取流水线由此直接开始
+    size_t leaf = static_cast<size_t>(-1);
+    DataBlock *blk = index_find_near_(l, &leaf);
+    if (!blk)
+        blk = data_head_.load(std::memory_order_acquire);
+    return RangeCursor(this, l, r, blk, leaf);
+}
+
+// 分页：区间起点之前的条目数加上 offset 即目标名次，经搜索层计数直接定位
+// 到目标块，不逐条跳过
+SBTreeBase::RangeCursor SBTreeBase::open_range_cursor(Key l, Key r, size_t offset) const
+{
+    if (l > r)
+        return RangeCursor(this, 1, 0, nullptr);
+    EpochGuard guard;
+    RangeCursor cur(this, l, r, nullptr); // 只取溢出区快照并定位其 [l, r] 区间
+    uint64_t a = (l == 0 ? 0 : data_rank_le_(l - 1)) + offset, b = 0;
+    if (cur.ov_)
+    {
+        split_rank_(a + cur.ov_pos_, *cur.ov_, &a, &b);
+        cur.ov_pos_ = std::max<size_t>(cur.ov_pos_, b);
+    }
+    size_t idx = 0;
+    cur.blk_ = data_select_(a, &idx);
+    cur.idx_ = idx;
+    // 索引滞后时计数与块可能短暂不一致：不越过区间左端
+    if (cur.blk_ && cur.blk_->get_entry(idx).key < l)
+        cur.idx_ = cur.blk_->lower_bound(l);
+    cur.settle_();
+    return cur;
+}
+
+// ========================= ReverseCursor =========================
+SBTreeBase::ReverseCursor::ReverseCursor(const SBTreeBase *owner, Key l, Key r, DataBlock *start, size_t leaf)
+    : owner_(owner), l_(l), r_(r), leaf_(leaf)
+{
+    if (l_ > r_)
+        return;
+    if (!owner_->overflow_.empty())
+    {
+        ov_ = owner_->overflow_.snapshot();
+        ov_lo_ = ov_->lower_bound(l_);
+        ov_pos_ = ov_->upper_bound(r_);
+    }
+    // 起始组：候选块及其后 min_key <= r 的块（拆分出的后继块、尚未索引的新块）
+    if (load_group_(start, nullptr, r_))
+    {
+        gi_ = group_.size() - 1;
+        enter_(group_[gi_]);
+    }
+}
+
+bool SBTreeBase::ReverseCursor::load_group_(DataBlock *from, DataBlock *stop, Key bound)
+{
+    group_.clear();
+    for (DataBlock *b = from; b && b != stop && b->min_key() <= bound; b = b->next())
+        group_.push_back(b);
+    return !group_.empty();
+}
+
+void SBTreeBase::ReverseCursor::enter_(DataBlock *b)
+{
+    blk_ = b;
+    const size_t n = b->size();
+    lo_ = b->min_key() < l_ ? b->lower_bound(l_) : 0;
+    end_ = b->keys()[n - 1] <= r_ ? n : b->lower_bound(r_ + 1); // 此时 r_ < 块内最大 key
+}
+
+DataBlock *SBTreeBase::ReverseCursor::leaf_at_(size_t i)
+{
+    if (i < back_base_ || i >= back_base_ + back_len_)
+    {
+        back_base_ = i + 1 > kLeafBatch ? i + 1 - kLeafBatch : 0;
+        back_len_ = owner_->index_copy_leaves_(back_base_, std::numeric_limits<Key>::max(), back_,
+                                               i + 1 - back_base_);
+        if (i >= back_base_ + back_len_)
+            return nullptr;
+    }
+    return live_(back_[i - back_base_]);
+}
+
+// 前一组：取当前组首块的前一个叶子，沿链走到当前组首块之前。叶层与链在
+// 索引滞后时可能不一致：前一个叶子不可用（下标未知、已越过首块或 min_key
+// 偏大）时按 bound - 1 下降搜索层，候选 min_key 严格小于 bound，必在首块之前；
+// 其后尚未索引的块一并收入本组。同 key 可能跨块，收集条件为 min_key <= bound。
+bool SBTreeBase::ReverseCursor::prev_group_()
+{
+    DataBlock *stop = group_.front();
+    const Key bound = stop->min_key();
+    if (bound < l_)
+        return false; // 更早的块全部小于 l
+    DataBlock *from = (leaf_ != static_cast<size_t>(-1) && leaf_ > 0) ? leaf_at_(leaf_ - 1) : nullptr;
+    if (from && from != stop && from->min_key() <= bound)
+        --leaf_;
+    else
+    {
+        leaf_ = static_cast<size_t>(-1);
+        from = bound == 0 ? nullptr : owner_->index_find_near_(bound - 1, &leaf_);
+        if (!from)
+        {
+            from = owner_->data_head_.load(std::memory_order_acquire);
+            leaf_ = static_cast<size_t>(-1);
+        }
+    }
+    if (!load_group_(from, stop, bound))
+        return false;
+    prefetch_behind_();
+    gi_ = group_.size() - 1;
+    enter_(group_[gi_]);
+    return true;
+}
+
+// 与 RangeCursor::prefetch_ahead_ 对称：块头领先 depth 个叶子，键/值数组的
+// 末尾（逆序先读）领先一个叶子（此时其块头多已到达，读条目数不再阻塞）
+void SBTreeBase::ReverseCursor::prefetch_behind_()
+{
+    const size_t depth = std::min(owner_->opts_.scan_prefetch_blocks, kLeafBatch);
+    if (depth == 0 || leaf_ == static_cast<size_t>(-1) || leaf_ == 0)
+        return;
+    if (DataBlock *b = leaf_at_(leaf_ - 1)) // 先取近处，使较远的叶子落在同一批中
+        b->prefetch_tail();
+    if (leaf_ >= depth)
+        if (DataBlock *b = leaf_at_(leaf_ - depth))
+            b->prefetch_header();
+}
+
+bool SBTreeBase::ReverseCursor::settle_()
+{
+    while (blk_ && end_ <= lo_)
+    {
+        if (lo_ > 0)
+            blk_ = nullptr; // 块内已有小于 l 的条目，更早的块不必再看
+        else if (gi_ > 0)
+            enter_(group_[--gi_]);
+        else if (!prev_group_())
+            blk_ = nullptr;
+    }
+    return blk_ != nullptr;
+}
+
+bool SBTreeBase::ReverseCursor::next(KVPair *out)
+{
+    const bool has_blk = settle_();
+    const bool has_ov = ov_lo_ < ov_pos_;
+    if (!has_blk && !has_ov)
+        return false;
+
+    // 与 RangeCursor 相反：相同 key 时溢出区在前
+    if (has_ov && (!has_blk || ov_->keys[ov_pos_ - 1] >= blk_->keys()[end_ - 1]))
+    {
+        --ov_pos_;
+        if (out)
+            *out = KVPair{ov_->keys[ov_pos_], ov_->vals[ov_pos_]};
+        return true;
+    }
+    --end_;
+    if (out)
+        *out = blk_->get_entry(end_);
+    return true;
+}
+
+// 溢出区的段取 key 不小于当前数据层 key 的部分；数据层的段取 key 大于
+// 下一个溢出区 key 的部分。段非空。
+bool SBTreeBase::ReverseCursor::peek_span_(Span *out, bool *from_ov)
+{
+    const bool has_blk = settle_();
+    const bool has_ov = ov_lo_ < ov_pos_;
+    if (!has_blk && !has_ov)
+        return false;
+
+    if (has_ov && (!has_blk || ov_->keys[ov_pos_ - 1] >= blk_->keys()[end_ - 1]))
+    {
+        const size_t begin = has_blk ? std::max(ov_lo_, ov_->lower_bound(blk_->keys()[end_ - 1])) : ov_lo_;
+        *out = Span{ov_->keys.data() + begin, ov_->vals.data() + begin, ov_pos_ - begin};
+        *from_ov = true;
+        return true;
+    }
+    size_t begin = lo_;
+    if (has_ov)
+    {
+        const Key ok = ov_->keys[ov_pos_ - 1];
+        if (blk_->keys()[begin] <= ok)
+            begin = blk_->lower_bound(ok + 1); // ok 小于块内某 key，不会溢出
+    }
+    *out = Span{blk_->keys() + begin, blk_->values() + begin, end_ - begin};
+    *from_ov = false;
+    return true;
+}
+
+bool SBTreeBase::ReverseCursor::next_span(Span *out)
+{
+    bool from_ov = false;
+    if (!peek_span_(out, &from_ov))
+        return false;
+    if (from_ov)
+        ov_pos_ -= out->n;
+    else
+        end_ -= out->n;
+    return true;
+}
+
+size_t SBTreeBase::ReverseCursor::next_batch(std::vector<KVPair> &out, size_t limit)
+{
+    size_t added = 0;
+    Span sp;
+    bool from_ov = false;
+    while (added < limit && peek_span_(&sp, &from_ov))
+    {
+        const size_t m = std::min(sp.n, limit - added);
+        const size_t base = out.size();
+        out.resize(base + m);
+        for (size_t i = 0; i < m; ++i)
+            out[base + i] = KVPair{sp.keys[sp.n - 1 - i], sp.values[sp.n - 1 - i]};
+        added += m;
+        if (from_ov)
+            ov_pos_ -= m;
+        else
+            end_ -= m;
+    }
+    return added;
+}
+
+SBTreeBase::ReverseCursor SBTreeBase::open_reverse_cursor(Key l, Key r) const
+{
+    if (l > r)
+        return ReverseCursor(this, 1, 0, nullptr, static_cast<size_t>(-1));
+    EpochGuard guard;
+    size_t leaf = static_cast<size_t>(-1);
+    DataBlock *blk = tail_find_(r);
+    if (!blk)
+        blk = index_find_near_(r, &leaf);
+    if (!blk)
+        blk = data_head_.load(std::memory_order_acquire);
+    return ReverseCursor(this, l, r, blk, leaf);
+}
+
+// 逆序取段（只记指针，段在游标存续期间有效），再按升序一次性写出，
+// 不必逐条逆序复制后再整体翻转
+size_t SBTreeBase::latest_n(Key r, size_t n, std::vector<KVPair> &out) const
+{
+    auto cur = open_reverse_cursor(0, r);
+    std::vector<Span> spans;
+    size_t got = 0;
+    Span sp;
+    while (got < n && cur.next_span(&sp))
+    {
+        if (sp.n > n - got) // 只取段尾（较大的 key）
+        {
+            const size_t skip = sp.n - (n - got);
+            sp = Span{sp.keys + skip, sp.values + skip, n - got};
+        }
+        spans.push_back(sp);
+        got += sp.n;
+    }
+    size_t pos = out.size();
+    out.resize(pos + got);
+    for (auto it = spans.rbegin(); it != spans.rend(); ++it)
+        for (size_t i = 0; i < it->n; ++i)
+            out[pos++] = KVPair{it->keys[i], it->values[i]};
+    return got;
+}
+
+// ========================= Finger =========================
+bool SBTreeBase::Finger::lookup(Key k, Value *out)
+{
+    // 1) 缓存块仍在链上且不超过 k：k 不超过其最大 key 时即为候选；否则（上次
+    //    也是沿链命中时）沿 next() 前进，直到后继越过 k。叶层提示同步前移
+    //   （拆分出的后继块不占叶子，提示偏大时由指数搜索识别并放弃）
+    DataBlock *blk = nullptr;
+    if (blk_ && blk_->status() == DataBlock::Status::READY && blk_->min_key() <= k)
+    {
+        if (k <= blk_->get_entry(blk_->size() - 1).key)
+            blk = blk_;
+        else if (chained_)
+        {
+            DataBlock *b = blk_;
+            for (int hop = 0;; ++hop)
+            {
+                DataBlock *nxt = b->next();
+                if (!nxt || nxt->min_key() > k)
+                {
+                    blk = b;
+                    break;
+                }
+                if (hop == kMaxHops)
+                    break;
+                b = nxt;
+                if (leaf_ != static_cast<size_t>(-1))
+                    ++leaf_; // 无提示（上次未命中或经尾部目录定位）时保持无提示
+            }
+        }
+    }
+    // 2) 远跳或回退：最近数据查尾部目录，其余自叶层提示处指数搜索；
+    //    上次未能沿链命中时不再逐块试探，上次叶层距离超出指数搜索范围时
+    //    直接完整下降（随机访问时只多一次提示判断）
+    chained_ = blk != nullptr;
+    if (!blk)
+    {
+        ++fallbacks_;
+        blk = owner_->tail_find_(k);
+        if (!blk)
+        {
+            const size_t hint = far_ ? static_cast<size_t>(-1) : leaf_;
+            leaf_ = hint;
+            blk = owner_->index_find_near_(k, &leaf_);
+            far_ = hint == static_cast<size_t>(-1) || leaf_ < hint ||
+                   leaf_ - hint > SearchLayer::kMaxGallop;
+        }
+    }
+    blk_ = blk;
+    return owner_->lookup_from_(blk, k, out);
+}
+
+// ========================= 验证/统计 =========================
+bool SBTreeBase::verify_data_layer(size_t expected_total_keys) const
+{
+    std::lock_guard<std::mutex> g(data_layer_lock_);
+    size_t actual = 0;
+    Key last = 0;
+    DataBlock *cur = data_head_.load();
+    while (cur)
+    {
+        for (size_t i = 0; i < cur->size(); ++i)
+        {
+            KVPair e = cur->get_entry(i);
+            if (e.key != actual)
+            {
+                fprintf(stderr, "DBG key %lu expected %lu blk=%p size=%zu i=%zu status=%d min=%lu\n", (unsigned long)e.key, (unsigned long)actual, (void*)cur, cur->size(), i, (int)cur->status(), (unsigned long)cur->min_key());
+                return false;
+            }
+            if (e.value != e.key * 10)
+                return false;
+            if (actual > 0 && e.key <= last)
+                return false;
+            last = e.key;
+            ++actual;
+        }
+        cur = cur->next();
+    }
+    if (actual != expected_total_keys) fprintf(stderr, "DBG total %zu expected %zu\n", actual, expected_total_keys);
+    return actual == expected_total_keys;
+}
+
+// 最近数据走尾部目录（O(1) 判定 + 一次目录内比较）；更早的 key 或目录
+// 尚为空时下降搜索层
+DataBlock *SBTreeBase::find_candidate_(Key k) const
+{
+    if (DataBlock *blk = tail_find_(k))
+        return blk;
+    return index_find_(k);
+}
+
+// 替换可能连续发生多次：沿接替链走到在链块。读者处于纪元临界区内，接替链上
+// 的块比旧块更晚交给 EpochManager，读到旧块时它们都尚未释放
+DataBlock *SBTreeBase::live_(DataBlock *b) noexcept
+{
+    while (b && b->status() == DataBlock::Status::RETIRED)
+        b = b->replacement();
+    return b;
+}
+
+DataBlock *SBTreeBase::tail_find_(Key k) const
+{
+    return live_(tail_dir_.find(k));
+}
+
+DataBlock *SBTreeBase::index_find_(Key k) const
+{
+    return live_(learned_ ? learned_->find_candidate(k) : search_.find_candidate(k));
+}
+
+DataBlock *SBTreeBase::index_find_(Key k, uint64_t *before) const
+{
+    return live_(learned_ ? learned_->find_candidate(k, before) : search_.find_candidate(k, before));
+}
+
+DataBlock *SBTreeBase::index_find_near_(Key k, size_t *leaf) const
+{
+    return live_(learned_ ? learned_->find_candidate_near(k, leaf) : search_.find_candidate_near(k, leaf));
+}
+
+void SBTreeBase::index_find_batch_(const Key *keys, size_t n, DataBlock **out) const
+{
+    if (learned_)
+        learned_->find_candidates(keys, n, out);
+    else
+        search_.find_candidates(keys, n, out);
+    for (size_t i = 0; i < n; ++i)
+        out[i] = live_(out[i]);
+}
+
+size_t SBTreeBase::index_copy_leaves_(size_t from, Key hi, DataBlock **out, size_t n) const
+{
+    return learned_ ? learned_->copy_leaves(from, hi, out, n) : search_.copy_leaves(from, hi, out, n);
+}
+
+DataBlock *SBTreeBase::index_select_(uint64_t r, uint64_t *offset) const
+{
+    return live_(learned_ ? learned_->select_leaf(r, offset) : search_.select_leaf(r, offset));
+}
+
+uint64_t SBTreeBase::index_batches_enqueued() const noexcept { return idx_batches_enqueued_.load(); }
+uint64_t SBTreeBase::index_batches_applied() const noexcept { return idx_batches_applied_.load(); }
+uint64_t SBTreeBase::index_items_enqueued() const noexcept { return idx_items_enqueued_.load(); }
+uint64_t SBTreeBase::index_items_applied() const noexcept { return idx_items_applied_.load(); }
+uint64_t SBTreeBase::index_apply_rounds() const noexcept { return idx_apply_rounds_.load(); }
+uint64_t SBTreeBase::appended_entries() const noexcept { return appended_entries_.load(); }
+
+std::size_t SBTreeBase::index_levels() const
+{
+    return learned_ ? learned_->levels_snapshot() : search_.levels_snapshot();
+}
+std::size_t SBTreeBase::overflow_size() const noexcept { return overflow_.size(); }
\ No newline at end of file
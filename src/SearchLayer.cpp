@@ -1,11 +1,13 @@
 #include "SearchLayer.h"
 #include "DataBlock.h"
+#include "EpochManager.h"
+#include "Simd.h"
 #include <atomic>
 #include <algorithm>
 
 // ========================= 内部断言 =========================
 // 确认传入的一批 DataBlock 按 min_key 非降
-void SearchLayer::debug_verify_sorted_leaf_run_(const std::vector<DataBlock *> &blocks)
+void SearchLayer::debug_verify_sorted_leaf_run_([[maybe_unused]] const std::vector<DataBlock *> &blocks)
 {
 #ifndef NDEBUG
     if (blocks.empty())
@@ -20,87 +22,73 @@ void SearchLayer::debug_verify_sorted_leaf_run_(const std::vector<DataBlock *> &
 #endif
 }
 
-// ========================= 构造 =========================
+// ========================= 构造/析构 =========================
 SearchLayer::SearchLayer(std::size_t fanout)
-    : fanout_(fanout)
+    : counts_(fanout), fanout_(fanout)
 {
     assert(fanout_ >= 2 && "fanout must be >= 2");
-    auto init = std::make_shared<SearchSnapshot>();
-    std::atomic_store(&snapshot_, std::static_pointer_cast<const SearchSnapshot>(init));
+    assert((fanout_ & (fanout_ - 1)) == 0 && fanout_ <= KeyArray::kChunk &&
+           "fanout must be a power of two no larger than a chunk");
+    keys_.push_back(std::make_unique<KeyArray>());
+    auto *init = new SearchSnapshot();
+    init->leaves = &leaves_;
+    init->L.push_back(LevelView{keys_.front().get(), 0});
+    snapshot_.store(init, std::memory_order_seq_cst);
+}
+
+// 析构时已无读者访问本搜索层：当前快照直接释放；已退役的旧快照不引用
+// 各层数组本身，仍由 EpochManager 在宽限期后释放
+SearchLayer::~SearchLayer()
+{
+    delete snapshot_.exchange(nullptr);
 }
 
 // ========================= 快照维护 =========================
-void SearchLayer::rebuild_snapshot_()
+void SearchLayer::publish_snapshot_()
 {
-    auto snap = std::make_shared<SearchSnapshot>();
-    snap->L0 = L0_;
-    snap->L = L_;
-    std::atomic_store(&snapshot_, std::static_pointer_cast<const SearchSnapshot>(snap));
+    auto *snap = new SearchSnapshot();
+    snap->leaves = &leaves_;
+    snap->L.reserve(keys_.size());
+    for (const auto &lv : keys_)
+        snap->L.push_back(LevelView{lv.get(), lv->size()});
+
+    SearchSnapshot *prev = snapshot_.exchange(snap, std::memory_order_seq_cst);
+    // 旧块可能被 prev 及更早快照的读者访问：随 prev 一起退役
+    for (auto &c : pending_garbage_)
+        prev->garbage.push_back(std::move(c));
+    pending_garbage_.clear();
+    for (auto &c : pending_count_garbage_)
+        prev->count_garbage.push_back(std::move(c));
+    pending_count_garbage_.clear();
+    EpochManager::instance().retire(prev);
 }
 
 std::size_t SearchLayer::levels_snapshot() const noexcept
 {
-    auto snap = std::atomic_load(&snapshot_);
-    if (!snap)
+    EpochGuard guard;
+    const SearchSnapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    if (!snap || snap->L.front().size == 0)
         return 0;
-    return snap->L.empty() ? (snap->L0.empty() ? 0u : 1u) : snap->L.size() + 1;
+    return snap->L.size();
 }
 
 // ========================= 清空 =========================
 void SearchLayer::clear()
 {
-    L0_.clear();
-    L_.clear();
+    keys_.resize(1);
+    keys_.front()->clear();
+    leaves_.clear();
+    counts_.clear();
     promoted_.clear();
-}
-
-// ========================= 内部二分 =========================
-std::size_t SearchLayer::upper_floor_index_(const std::vector<NodeEnt> &arr, Key k) noexcept
-{
-    std::size_t lo = 0, hi = arr.size(), pos = static_cast<std::size_t>(-1);
-    while (lo < hi)
-    {
-        std::size_t mid = lo + ((hi - lo) >> 1);
-        if (arr[mid].min_key <= k)
-        {
-            pos = mid;
-            lo = mid + 1;
-        }
-        else
-            hi = mid;
-    }
-    return pos;
-}
-
-std::size_t SearchLayer::leaf_floor_index_(const std::vector<LeafEnt> &arr,
-                                           std::size_t lo, std::size_t hi,
-                                           Key k) noexcept
-{
-    if (lo >= hi)
-        return static_cast<std::size_t>(-1);
-    std::size_t L = lo, R = hi, pos = static_cast<std::size_t>(-1);
-    while (L < R)
-    {
-        std::size_t mid = L + ((R - L) >> 1);
-        if (arr[mid].min_key <= k)
-        {
-            pos = mid;
-            L = mid + 1;
-        }
-        else
-            R = mid;
-    }
-    return pos;
+    publish_snapshot_();
 }
 
 // ========================= 晋升 =========================
+// 第 lv 层每凑满 F 个未晋升条目，就把其中首键追加到 lv+1 层；
+// 子节点位置由下标推出（第 j 个上层键覆盖 [j*F, (j+1)*F)）。
 void SearchLayer::promote_from_level_(std::size_t level)
 {
     const std::size_t F = fanout_;
-    auto level_size = [&](std::size_t lv)
-    { return (lv == 0) ? L0_.size() : L_[lv - 1].size(); };
-    auto level_min_key_at = [&](std::size_t lv, std::size_t idx)
-    { return (lv == 0) ? L0_[idx].min_key : L_[lv - 1][idx].min_key; };
 
     std::size_t lv = level;
     for (;;)
@@ -108,25 +96,21 @@ void SearchLayer::promote_from_level_(std::size_t level)
         if (promoted_.size() <= lv)
             promoted_.resize(lv + 1, 0);
         std::size_t p = promoted_[lv];
-        std::size_t sz = level_size(lv);
+        std::size_t sz = keys_[lv]->size();
 
         if (sz >= p + F)
         {
-            if (L_.size() <= lv)
-                L_.resize(lv + 1);
+            if (keys_.size() <= lv + 1)
+                keys_.push_back(std::make_unique<KeyArray>());
             if (promoted_.size() <= lv + 1)
                 promoted_.resize(lv + 2, 0);
-            const std::size_t child_begin = p;
-            L_[lv].push_back(NodeEnt{level_min_key_at(lv, child_begin), child_begin, F});
-            p += F;
-            promoted_[lv] = p;
+            keys_[lv + 1]->push_back((*keys_[lv])[p]);
+            promoted_[lv] = p + F;
             continue;
         }
-        if (L_.size() <= lv)
+        if (keys_.size() <= lv + 1)
             break;
-        if (promoted_.size() <= lv + 1)
-            break;
-        std::size_t parent_sz = L_[lv].size();
+        std::size_t parent_sz = keys_[lv + 1]->size();
         std::size_t parent_p = promoted_[lv + 1];
         if (parent_sz >= parent_p + F)
         {
@@ -139,78 +123,384 @@ void SearchLayer::promote_from_level_(std::size_t level)
 
 // ========================= 追加 =========================
 void SearchLayer::append_run(const std::vector<DataBlock *> &blocks)
+{
+    std::vector<std::uint64_t> counts;
+    counts.reserve(blocks.size());
+    for (auto *b : blocks)
+        counts.push_back(b->size());
+    append_run(blocks, counts);
+}
+
+void SearchLayer::append_run(const std::vector<DataBlock *> &blocks,
+                             const std::vector<std::uint64_t> &counts)
 {
     if (blocks.empty())
         return;
+    assert(counts.size() == blocks.size());
     debug_verify_sorted_leaf_run_(blocks);
+    KeyArray &L0 = *keys_.front();
 #ifndef NDEBUG
-    if (!L0_.empty())
-        assert(L0_.back().min_key <= blocks.front()->min_key());
+    if (!L0.empty())
+        assert(L0.back() <= blocks.front()->min_key());
 #endif
 
-    for (auto *b : blocks)
-        L0_.push_back(LeafEnt{b->min_key(), b});
+    for (std::size_t i = 0; i < blocks.size(); ++i)
+    {
+        L0.push_back(blocks[i]->min_key());
+        leaves_.push_back(blocks[i]);
+        counts_.push_back(counts[i]);
+    }
 
-    if (promoted_.size() < 1)
-        promoted_.resize(1, 0);
     promote_from_level_(0);
 
 #ifndef NDEBUG
-    for (std::size_t i = 1; i < L0_.size(); ++i)
-        assert(L0_[i - 1].min_key <= L0_[i].min_key);
+    for (std::size_t i = L0.size() - blocks.size(); i > 0 && i < L0.size(); ++i)
+        assert(L0[i - 1] <= L0[i]);
     for (std::size_t lv = 0; lv < promoted_.size(); ++lv)
-        assert(promoted_[lv] <= ((lv == 0) ? L0_.size() : L_[lv - 1].size()));
+        assert(promoted_[lv] <= keys_[lv]->size() &&
+               promoted_[lv] == (lv + 1 < keys_.size() ? keys_[lv + 1]->size() * fanout_ : 0));
+    assert(keys_.back()->size() < fanout_);
 #endif
 
-    rebuild_snapshot_();
+    publish_snapshot_();
+}
+
+// ========================= 替换 =========================
+// 叶层按 min_key 有序：先二分到 old->min_key() 的首个位置，再在等键区间内比指针。
+// 键不变，只写时复制指针数组所在的块，旧块在下一次发布（publish/append_run）时
+// 交给当时的快照回收。
+bool SearchLayer::replace_leaf(DataBlock *old, DataBlock *repl, std::uint64_t added,
+                               std::size_t *pos)
+{
+    const KeyArray &L0 = leaf_keys_();
+    const Key k = old->min_key();
+    std::size_t L = 0, R = L0.size();
+    while (L < R)
+    {
+        std::size_t mid = L + ((R - L) >> 1);
+        if (L0[mid] < k)
+            L = mid + 1;
+        else
+            R = mid;
+    }
+    for (std::size_t i = L; i < L0.size() && L0[i] == k; ++i)
+    {
+        if (leaves_[i] == old)
+            return replace_at_(i, repl, added, pos);
+    }
+    // 表头块被替换后其 min_key 可能小于叶层记录值（叶层键保持不变）
+    if (!L0.empty() && leaves_[0] == old)
+        return replace_at_(0, repl, added, pos);
+    return false;
+}
+
+bool SearchLayer::replace_at_(std::size_t i, DataBlock *repl, std::uint64_t added, std::size_t *pos)
+{
+    pending_garbage_.push_back(leaves_.replace(i, repl));
+    counts_.add(i, added, pending_count_garbage_);
+    if (pos)
+        *pos = i;
+    return true;
+}
+
+void SearchLayer::add_count(std::size_t leaf, std::uint64_t added)
+{
+    assert(leaf < leaves_.size());
+    counts_.add(leaf, added, pending_count_garbage_);
+}
+
+void SearchLayer::publish()
+{
+    if (!pending_garbage_.empty() || !pending_count_garbage_.empty())
+        publish_snapshot_();
 }
 
 // ========================= 查找 =========================
+// 最高层不足一个节点，按实际长度比较；其下每层只比较父键所指的一个节点
+// （F 个连续键），节点内计数 <= k 的键即得 floor 下标，无分支、无二分。
+// 右边缘：未凑满 F 个的尾部没有父键，挂在本层最后一个键之下——父键是上层
+// 最后一个键时，其子节点之后紧跟下层尾部 [lo+F, size)，一并比较，
+// 因此新写入的数据与旧数据同样只需每层一个节点（外加至多一段尾部）。
+template <std::size_t FixedF>
+std::size_t SearchLayer::descend_(const SearchSnapshot &snap, Key k) const noexcept
+{
+    const auto npos = static_cast<std::size_t>(-1);
+    const std::size_t F = FixedF ? FixedF : fanout_;
+    const auto &L = snap.L;
+    const std::size_t top = L.size() - 1;
+
+    const Key *top_keys = L[top].keys->contiguous(0, L[top].size);
+    std::size_t c = simd_count_le(top_keys, L[top].size, k);
+    if (c == 0)
+        return npos;
+    std::size_t idx = c - 1;
+
+    for (std::size_t lv = top; lv > 0; --lv)
+    {
+        const std::size_t lo = idx * F;
+        const Key *node = L[lv - 1].keys->contiguous(lo, lo + F);
+        c = FixedF ? simd_count_le_fixed<FixedF>(node, k) : simd_count_le(node, F, k);
+        // 节点首键即父键（<= k），因此 c >= 1
+        assert(c >= 1);
+        // 尾部起点为 F 的整数倍且不足 F 个，必落在同一块内
+        const std::size_t end = L[lv - 1].size;
+        if (c == F && idx + 1 == L[lv].size && lo + F < end)
+            c += simd_count_le(L[lv - 1].keys->contiguous(lo + F, end), end - lo - F, k);
+        idx = lo + c - 1;
+    }
+    return idx;
+}
+
+std::size_t SearchLayer::descend_dispatch_(const SearchSnapshot &snap, Key k) const noexcept
+{
+    switch (fanout_)
+    {
+    case 8:
+        return descend_<8>(snap, k);
+    case 16:
+        return descend_<16>(snap, k);
+    case 32:
+        return descend_<32>(snap, k);
+    case 64:
+        return descend_<64>(snap, k);
+    default:
+        return descend_<0>(snap, k);
+    }
+}
+
 DataBlock *SearchLayer::find_candidate(Key k) const noexcept
 {
-    auto snap = std::atomic_load(&snapshot_);
-    if (!snap || snap->L0.empty())
+    EpochGuard guard;
+    const SearchSnapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    if (!snap || snap->L.front().size == 0)
         return nullptr;
-    const auto &L0 = snap->L0;
-    const auto &L = snap->L;
-    const auto npos = static_cast<std::size_t>(-1);
 
-    if (L.empty())
+    const std::size_t idx = descend_dispatch_(*snap, k);
+    return (idx == static_cast<std::size_t>(-1)) ? nullptr : (*snap->leaves)[idx];
+}
+
+// 指数搜索：自提示叶子 h 起以 1,2,4,... 为步长探测，直到越过 k 或到达叶层末尾，
+// 再在最后一段内计数；步长超过 max_dist 仍未越过 k 时视为远跳，返回 npos。
+std::size_t SearchLayer::gallop_floor(const KeyArray &L0, std::size_t n, std::size_t h,
+                                      Key k, std::size_t max_dist) noexcept
+{
+    const auto npos = static_cast<std::size_t>(-1);
+    if (h >= n || L0[h] > k)
+        return npos;
+    std::size_t lo = h, step = 1;
+    while (step <= max_dist && lo + step < n && L0[lo + step] <= k)
     {
-        std::size_t pos = leaf_floor_index_(L0, 0, L0.size(), k);
-        return (pos == npos) ? nullptr : L0[pos].ptr;
+        lo += step;
+        step <<= 1;
     }
+    if (step > max_dist)
+        return npos;
+    const std::size_t hi = std::min(n, lo + step);
+    if (const Key *p = L0.contiguous(lo, hi))
+        return lo + simd_count_le(p, hi - lo, k) - 1;
+    std::size_t L = lo, R = hi;
+    while (R - L > 1)
+    {
+        const std::size_t mid = L + ((R - L) >> 1);
+        if (L0[mid] <= k)
+            L = mid;
+        else
+            R = mid;
+    }
+    return L;
+}
 
-    std::size_t top = L.size() - 1;
-    const auto &topv = L[top];
-    std::size_t idx = upper_floor_index_(topv, k);
-    if (idx == npos)
+DataBlock *SearchLayer::find_candidate_near(Key k, std::size_t *leaf) const noexcept
+{
+    const auto npos = static_cast<std::size_t>(-1);
+    EpochGuard guard;
+    const SearchSnapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    const std::size_t n = snap ? snap->L.front().size : 0;
+    if (n == 0)
+    {
+        *leaf = npos;
         return nullptr;
+    }
+    std::size_t idx = gallop_floor(*snap->L.front().keys, n, *leaf, k);
+    if (idx == npos)
+        idx = descend_dispatch_(*snap, k);
+    *leaf = idx;
+    return idx == npos ? nullptr : (*snap->leaves)[idx];
+}
 
-    std::size_t lo = topv[idx].child_begin;
-    std::size_t hi = lo + topv[idx].child_count;
+// ========================= 批量查询 =========================
+// 预取 [p, p + n) 覆盖的缓存行
+static inline void prefetch_keys(const Key *p, std::size_t n) noexcept
+{
+    constexpr std::size_t kPerLine = 64 / sizeof(Key);
+    for (std::size_t i = 0; i < n; i += kPerLine)
+        __builtin_prefetch(p + i, 0, 3);
+}
 
-    for (std::size_t lv = top; lv > 0; --lv)
+void SearchLayer::find_candidates(const Key *keys, std::size_t n, DataBlock **out) const noexcept
+{
+    EpochGuard guard;
+    const SearchSnapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    if (!snap || snap->L.front().size == 0)
+    {
+        std::fill(out, out + n, nullptr);
+        return;
+    }
+    switch (fanout_)
+    {
+    case 8:
+        return find_candidates_<8>(*snap, keys, n, out);
+    case 16:
+        return find_candidates_<16>(*snap, keys, n, out);
+    case 32:
+        return find_candidates_<32>(*snap, keys, n, out);
+    case 64:
+        return find_candidates_<64>(*snap, keys, n, out);
+    default:
+        return find_candidates_<0>(*snap, keys, n, out);
+    }
+}
+
+// 各路下降深度相同，因此按层同步推进整组即可让缺失交错（无需逐路状态机）：
+// 组内每路完成本层比较后立即预取其下一层节点，轮到它时数据多已到达。
+// 近邻判定只参考已完成的组，同组内落在同一叶子的 key 各自下降（节点已在缓存中）。
+template <std::size_t FixedF>
+void SearchLayer::find_candidates_(const SearchSnapshot &snap, const Key *keys, std::size_t n,
+                                   DataBlock **out) const noexcept
+{
+    const auto npos = static_cast<std::size_t>(-1);
+    const std::size_t F = FixedF ? FixedF : fanout_;
+    const auto &L = snap.L;
+    const std::size_t top = L.size() - 1;
+    const KeyArray &L0 = *L.front().keys;
+    const std::size_t n0 = L.front().size;
+    const Key *top_keys = L[top].keys->contiguous(0, L[top].size);
+
+    std::size_t lane_key[kBatchLanes]; // 各路对应的 keys 下标
+    std::size_t lane_idx[kBatchLanes]; // 各路在当前层的下标
+    std::size_t last = npos;           // 最近解析出的叶子下标（近邻搜索起点）
+    for (std::size_t i = 0; i < n;)
     {
-        const auto &nodes = L[lv - 1];
-        std::size_t Lb = lo, Rb = hi, pos = npos;
-        while (Lb < Rb)
+        // 1) 凑一组需要下降的 key；近邻 key 直接在叶层上定位
+        std::size_t m = 0;
+        for (; i < n && m < kBatchLanes; ++i)
         {
-            std::size_t mid = Lb + ((Rb - Lb) >> 1);
-            if (nodes[mid].min_key <= k)
+            const Key k = keys[i];
+            if (last != npos)
+            {
+                const std::size_t h = gallop_floor(L0, n0, last, k, kBatchNear);
+                if (h != npos)
+                {
+                    out[i] = (*snap.leaves)[h];
+                    last = h;
+                    continue;
+                }
+            }
+            const std::size_t c = simd_count_le(top_keys, L[top].size, k);
+            if (c == 0)
+            {
+                out[i] = nullptr;
+                continue;
+            }
+            lane_key[m] = i;
+            lane_idx[m] = c - 1;
+            if (top > 0)
+                prefetch_keys(L[top - 1].keys->contiguous((c - 1) * F, c * F), F);
+            ++m;
+        }
+
+        // 2) 整组逐层推进（单路逻辑与 descend_ 相同）
+        for (std::size_t lv = top; lv > 0; --lv)
+            for (std::size_t j = 0; j < m; ++j)
             {
-                pos = mid;
-                Lb = mid + 1;
+                const Key k = keys[lane_key[j]];
+                const std::size_t idx = lane_idx[j], lo = idx * F;
+                const Key *node = L[lv - 1].keys->contiguous(lo, lo + F);
+                std::size_t c = FixedF ? simd_count_le_fixed<FixedF>(node, k) : simd_count_le(node, F, k);
+                assert(c >= 1);
+                const std::size_t end = L[lv - 1].size;
+                if (c == F && idx + 1 == L[lv].size && lo + F < end)
+                    c += simd_count_le(L[lv - 1].keys->contiguous(lo + F, end), end - lo - F, k);
+                const std::size_t next = lo + c - 1;
+                lane_idx[j] = next;
+                if (lv > 1)
+                    prefetch_keys(L[lv - 2].keys->contiguous(next * F, (next + 1) * F), F);
+                else
+                    __builtin_prefetch(&(*snap.leaves)[next], 0, 3);
             }
-            else
-                Rb = mid;
+
+        // 3) 读出叶层指针
+        for (std::size_t j = 0; j < m; ++j)
+        {
+            out[lane_key[j]] = (*snap.leaves)[lane_idx[j]];
+            last = lane_idx[j];
         }
-        if (pos == npos)
-            return nullptr;
-        lo = nodes[pos].child_begin;
-        hi = lo + nodes[pos].child_count;
     }
+}
+
+// ========================= 计数查询 =========================
+// 下降得到叶子下标后，前缀计数按同一下标在计数层上读出（每层至多一项）
+DataBlock *SearchLayer::find_candidate(Key k, std::uint64_t *before) const noexcept
+{
+    *before = 0;
+    EpochGuard guard;
+    const SearchSnapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    if (!snap || snap->L.front().size == 0)
+        return nullptr;
+
+    const std::size_t idx = descend_dispatch_(*snap, k);
+    if (idx == static_cast<std::size_t>(-1))
+        return nullptr;
+    *before = counts_.prefix(idx);
+    return (*snap->leaves)[idx];
+}
+
+DataBlock *SearchLayer::select_leaf(std::uint64_t r, std::uint64_t *offset) const noexcept
+{
+    EpochGuard guard;
+    const SearchSnapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    if (!snap || snap->L.front().size == 0)
+        return nullptr;
+    const std::size_t idx = counts_.select(snap->L.front().size, r, offset);
+    return (*snap->leaves)[idx];
+}
+
+// ========================= 叶层遍历 =========================
+void SearchLayer::split_keys(Key l, Key r, std::size_t parts, std::size_t min_leaves,
+                             std::vector<Key> &out) const
+{
+    const auto npos = static_cast<std::size_t>(-1);
+    EpochGuard guard;
+    const SearchSnapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    if (!snap || snap->L.front().size == 0 || parts < 2)
+        return;
+    std::size_t lo = descend_dispatch_(*snap, l);
+    const std::size_t hi = descend_dispatch_(*snap, r);
+    if (hi == npos)
+        return;
+    if (lo == npos)
+        lo = 0;
+    const std::size_t leaves = hi - lo + 1;
+    parts = std::min(parts, leaves / std::max<std::size_t>(min_leaves, 1));
+    for (std::size_t p = 1; p < parts; ++p)
+    {
+        const Key k = (*snap->L.front().keys)[lo + leaves * p / parts];
+        if (k > l && (out.empty() || k > out.back()))
+            out.push_back(k);
+    }
+}
 
-    std::size_t leaf_pos = leaf_floor_index_(L0, lo, hi, k);
-    return (leaf_pos == npos) ? nullptr : L0[leaf_pos].ptr;
-}
\ No newline at end of file
+std::size_t SearchLayer::copy_leaves(std::size_t from, Key hi, DataBlock **out, std::size_t n) const noexcept
+{
+    EpochGuard guard;
+    const SearchSnapshot *snap = snapshot_.load(std::memory_order_seq_cst);
+    const std::size_t size = snap ? snap->L.front().size : 0;
+    if (from >= size)
+        return 0;
+    n = std::min(n, size - from);
+    const KeyArray &keys = *snap->L.front().keys;
+    std::size_t i = 0;
+    for (; i < n && keys[from + i] <= hi; ++i)
+        out[i] = (*snap->leaves)[from + i];
+    return i;
+}
@@ -1,14 +1,31 @@
+#include <atomic>
+std::atomic<unsigned long> g_app[1<<18], g_colN[1<<20], g_colC[1<<20];
 #include "SegmentedBlock.h"
+#include "EpochManager.h"
 #include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace
+{
+    std::atomic<uint64_t> g_next_instance_id{1};  // 段实例编号分配器
+    std::atomic<uint64_t> g_next_thread_token{1}; // 写线程标识分配器
+}
 
 // ========================= 构造/析构 =========================
-SegmentedBlock::SegmentedBlock()
+SegmentedBlock::SegmentedBlock(size_t max_entries, size_t max_ptbs)
     : status_(BlockStatus::ACTIVE),
       min_key_(UINT64_MAX),
       reserved_count_(0),
-      committed_count_(0)
+      committed_count_(0),
+      first_write_ns_(0),
+      max_entries_(max_entries),
+      max_ptbs_(max_ptbs),
+      instance_id_(g_next_instance_id.fetch_add(1, std::memory_order_relaxed))
 {
-    std::fill(std::begin(ptb_pointers_), std::end(ptb_pointers_), nullptr);
+    for (auto &p : ptb_pointers_)
+        p.store(nullptr, std::memory_order_relaxed);
+    std::fill(std::begin(slot_owner_), std::end(slot_owner_), uint64_t{0});
 }
 
 // 析构时释放所有 PTB
@@ -16,7 +33,7 @@ SegmentedBlock::~SegmentedBlock()
 {
     for (size_t i = 0; i < kMaxPTBs; ++i)
     {
-        delete ptb_pointers_[i];
+        delete ptb_pointers_[i].load(std::memory_order_relaxed);
     }
 }
 
@@ -27,26 +44,29 @@ bool SegmentedBlock::append_ordered(Key k, Value v)
     if (status_.load(std::memory_order_acquire) != BlockStatus::ACTIVE)
         return false; // 仅 ACTIVE 状态允许写入
 
-    if (reserved_count_.load(std::memory_order_relaxed) >= kMaxPTBs)
-        return false; // PTB 槽位已达上限
-
-    int slot = get_or_create_slot_for_this_thread_();
+    const uint64_t id = instance_id_.load(std::memory_order_acquire);
+    int slot = get_or_create_slot_for_this_thread_(id);
     if (slot < 0)
-        return false;
+        return false; // PTB 槽位已达上限
 
-    PerThreadDataBlock *ptb = ptb_pointers_[slot];
-    if (!ptb)
+    // 先声明“写入进行中”再复查状态；与 seal() 的顺序一致性 CAS 配对，
+    // 保证要么本次写入被转换方等待，要么本次写入看到已封印而放弃。
+    // 同时复查实例编号：期间段若已被回收并重新启用，槽位不再属于本线程。
+    std::atomic<bool> &busy = writing_[slot].busy;
+    busy.store(true, std::memory_order_seq_cst);
+    if (status_.load(std::memory_order_seq_cst) != BlockStatus::ACTIVE ||
+        instance_id_.load(std::memory_order_seq_cst) != id)
     {
-        ptb = new PerThreadDataBlock();
-        ptb_pointers_[slot] = ptb;
-        reserved_count_.fetch_add(1);
+        busy.store(false, std::memory_order_release);
+        return false;
     }
 
-    if (ptb->IsFull())
-        return false; // 当前 PTB 已满
-
+    PerThreadDataBlock *ptb = ptb_pointers_[slot].load(std::memory_order_relaxed);
     if (!ptb->Insert(k, v))
-        return false; // 插入失败
+    {
+        busy.store(false, std::memory_order_release);
+        return false; // 当前 PTB 已满
+    }
 
     // 更新 min_key_
     Key old_min = min_key_.load(std::memory_order_relaxed);
@@ -57,12 +77,19 @@ bool SegmentedBlock::append_ordered(Key k, Value v)
     {
     }
 
-    committed_count_.fetch_add(1);
+    const size_t n = committed_count_.fetch_add(1) + 1;
+    if (n == 1)
+        first_write_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now().time_since_epoch())
+                                  .count(),
+                              std::memory_order_release);
 
-    // 如果刚好写满，触发 should_seal_
-    if (ptb->IsFull())
+    // 如果刚好写满或达到条目数阈值，触发 should_seal_
+    if (ptb->IsFull() || n >= max_entries_)
         should_seal_.store(true, std::memory_order_release);
 
+    if (k < (1u<<18)) g_app[k].store(id, std::memory_order_relaxed);
+    busy.store(false, std::memory_order_release);
     return true;
 }
 
@@ -72,59 +99,153 @@ void SegmentedBlock::seal()
 {
     BlockStatus expected = BlockStatus::ACTIVE;
     status_.compare_exchange_strong(expected, BlockStatus::CONVERT,
-                                    std::memory_order_acq_rel,
-                                    std::memory_order_acquire);
+                                    std::memory_order_seq_cst);
+}
+
+void SegmentedBlock::mark_converted()
+{
+    status_.store(BlockStatus::CONVERTED, std::memory_order_seq_cst);
+}
+
+// ========================= 回收复用 =========================
+// 转换已完成且在途写入已退出（collect_runs 之后）：清空本段以便复用。
+// 新鲜读可能仍在读取 PTB，交给 EpochManager 在宽限期后释放。
+void SegmentedBlock::recycle()
+{
+    std::lock_guard<std::mutex> g(lock_);
+    status_.store(BlockStatus::IDLE, std::memory_order_seq_cst);
+    instance_id_.store(g_next_instance_id.fetch_add(1, std::memory_order_relaxed),
+                       std::memory_order_seq_cst);
+    for (size_t i = 0; i < kMaxPTBs; ++i)
+    {
+        if (PerThreadDataBlock *p = ptb_pointers_[i].exchange(nullptr, std::memory_order_acq_rel))
+            EpochManager::instance().retire(p);
+        slot_owner_[i] = 0;
+    }
+    min_key_.store(UINT64_MAX, std::memory_order_relaxed);
+    reserved_count_.store(0, std::memory_order_relaxed);
+    committed_count_.store(0, std::memory_order_relaxed);
+    first_write_ns_.store(0, std::memory_order_relaxed);
+    should_seal_.store(false, std::memory_order_relaxed);
+}
+
+void SegmentedBlock::activate()
+{
+    BlockStatus expected = BlockStatus::IDLE;
+    status_.compare_exchange_strong(expected, BlockStatus::ACTIVE,
+                                    std::memory_order_release);
+}
+
+// 等待封印前已进入 append_ordered 的写入全部退出
+void SegmentedBlock::wait_for_writers_() const
+{
+    for (size_t i = 0; i < kMaxPTBs; ++i)
+        while (writing_[i].busy.load(std::memory_order_seq_cst))
+            std::this_thread::yield();
 }
 
 // ========================= 数据收集 =========================
-// 收集并排序本段所有 PTB 的数据
-std::vector<KVPair> SegmentedBlock::collect_and_sort_data()
+// 封印并返回各 PTB 的只读区间，供协作转换使用
+std::vector<KVRun> SegmentedBlock::collect_runs()
 {
     std::lock_guard<std::mutex> g(lock_);
 
     if (status_.load(std::memory_order_acquire) == BlockStatus::ACTIVE)
-        seal(); // 若还未封印，先封印
+        seal();
+    wait_for_writers_();
 
-    std::vector<KVPair> all_data;
-    size_t total_entries = 0;
+    std::vector<KVRun> runs;
     for (size_t i = 0; i < kMaxPTBs; ++i)
-        if (ptb_pointers_[i])
-            total_entries += ptb_pointers_[i]->GetNumEntries();
-    all_data.reserve(total_entries);
+    {
+        const PerThreadDataBlock *p = ptb_pointers_[i].load(std::memory_order_acquire);
+        if (p && p->GetNumEntries() > 0)
+            runs.push_back({p->GetData(), p->GetNumEntries()});
+    }
+    {
+        size_t tot = 0; for (auto &r : runs) tot += r.n;
+        const uint64_t iid = instance_id_.load() & ((1u<<20)-1);
+        g_colN[iid].fetch_add(tot); g_colC[iid].fetch_add(committed_count_.load());
+    }
+    return runs;
+}
+
+// ========================= 新鲜读 =========================
+bool SegmentedBlock::readable_() const noexcept
+{
+    const BlockStatus st = status_.load(std::memory_order_acquire);
+    return st == BlockStatus::ACTIVE || st == BlockStatus::CONVERT;
+}
 
+// 槽位自 0 起连续分配，遇到空槽即止
+void SegmentedBlock::copy_range(Key l, Key r, std::vector<KVPair> &out) const
+{
+    if (!readable_() || min_key_.load(std::memory_order_acquire) > r)
+        return;
     for (size_t i = 0; i < kMaxPTBs; ++i)
-        if (ptb_pointers_[i])
-        {
-            const KVPair *ptb_data = ptb_pointers_[i]->GetData();
-            size_t n = ptb_pointers_[i]->GetNumEntries();
-            all_data.insert(all_data.end(), ptb_data, ptb_data + n);
-        }
+    {
+        const PerThreadDataBlock *p = ptb_pointers_[i].load(std::memory_order_acquire);
+        if (!p)
+            break;
+        p->CopyRange(l, r, out);
+    }
+}
 
-    std::sort(all_data.begin(), all_data.end(),
-              [](const KVPair &a, const KVPair &b)
-              { return a.key < b.key; });
-    return all_data;
+bool SegmentedBlock::find(Key key, Value *value) const
+{
+    if (!readable_())
+        return false;
+    for (size_t i = 0; i < kMaxPTBs; ++i)
+    {
+        const PerThreadDataBlock *p = ptb_pointers_[i].load(std::memory_order_acquire);
+        if (!p)
+            break;
+        if (p->Find(key, value))
+            return true;
+    }
+    return false;
 }
 
 // ========================= 内部辅助 =========================
 // 获取或为当前线程分配 PTB 槽位
-int SegmentedBlock::get_or_create_slot_for_this_thread_()
+int SegmentedBlock::get_or_create_slot_for_this_thread_(uint64_t id)
 {
-    static thread_local int tls_slot = -1;
-    if (tls_slot >= 0 && (size_t)tls_slot < kMaxPTBs && ptb_pointers_[tls_slot])
-        return tls_slot; // 缓存有效
+    // 线程局部缓存按段实例编号区分，保留最近写过的几个段：
+    // 一个线程交替写多棵树时不必每次切换都回到加锁路径
+    struct SlotCache
+    {
+        uint64_t seg[kSlotCacheWays] = {};
+        int slot[kSlotCacheWays] = {};
+        unsigned next = 0;
+    };
+    static thread_local SlotCache cache;
+    for (size_t w = 0; w < kSlotCacheWays; ++w)
+        if (cache.seg[w] == id)
+            return cache.slot[w]; // 缓存有效
+
+    // 线程标识：进程内唯一，用于在槽位表中认领本线程已有的 PTB
+    static thread_local const uint64_t token = g_next_thread_token.fetch_add(1, std::memory_order_relaxed);
 
     std::lock_guard<std::mutex> g(lock_);
-    for (size_t i = 0; i < kMaxPTBs; ++i)
+    if (instance_id_.load(std::memory_order_relaxed) != id)
+        return -1; // 段已被回收
+    int slot = -1;
+    for (size_t i = 0; i < kMaxPTBs && slot < 0; ++i)
     {
-        if (!ptb_pointers_[i])
+        if (!ptb_pointers_[i].load(std::memory_order_relaxed))
         {
-            ptb_pointers_[i] = new PerThreadDataBlock();
-            ++reserved_count_;
-            ++committed_count_;
-            tls_slot = static_cast<int>(i);
-            return tls_slot;
+            slot_owner_[i] = token;
+            ptb_pointers_[i].store(new PerThreadDataBlock(), std::memory_order_release);
+            if (++reserved_count_ >= max_ptbs_)
+                should_seal_.store(true, std::memory_order_release); // 达到字节阈值
+            slot = static_cast<int>(i);
         }
+        else if (slot_owner_[i] == token)
+            slot = static_cast<int>(i); // 缓存被其他段挤出，沿用本线程已有的槽位
     }
-    return -1; // 无可用槽位
+    if (slot < 0)
+        return -1; // 无可用槽位
+    const unsigned w = cache.next++ % kSlotCacheWays;
+    cache.seg[w] = id;
+    cache.slot[w] = slot;
+    return slot;
 }
\ No newline at end of file
@@ -0,0 +1,85 @@
+#include "SingleWriterSBTree.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+    int64_t now_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+}
+
+// ========================= 构造/析构 =========================
+// 缓冲上限：默认一个 PTB 的容量；条目/字节阈值只会把它调小
+BasicSBTree<SingleWriter>::BasicSBTree(const SBTreeOptions &opts)
+    : SBTreeBase(opts),
+      limit_(PerThreadDataBlock::Capacity())
+{
+    if (opts_.seal_max_entries)
+        limit_ = std::min(limit_, opts_.seal_max_entries);
+    if (opts_.seal_max_bytes)
+        limit_ = std::min(limit_, std::max<size_t>(1, opts_.seal_max_bytes / sizeof(KVPair)));
+    buf_.reserve(limit_);
+    start_index_thread_();
+}
+
+BasicSBTree<SingleWriter>::~BasicSBTree()
+{
+    flush();
+    stop_index_thread_();
+}
+
+// ========================= 基本操作 =========================
+void BasicSBTree<SingleWriter>::insert(Key key, Value value)
+{
+    // 水位只由本线程的发布推进，relaxed 读即可
+    const Key wm = watermark_.load(std::memory_order_relaxed);
+    if (key < wm)
+    {
+        insert_late_(key, value, wm);
+        return;
+    }
+
+    if (buf_.empty() && opts_.seal_max_age.count() > 0)
+        first_write_ns_ = now_ns();
+    buf_.push_back({key, value});
+    if (buf_.size() >= limit_)
+    {
+        seal_buffer_();
+        return;
+    }
+
+    if (tick_.load(std::memory_order_relaxed))
+    {
+        tick_.store(false, std::memory_order_relaxed);
+        if (now_ns() - first_write_ns_ >= std::chrono::nanoseconds(opts_.seal_max_age).count())
+            seal_buffer_();
+    }
+}
+
+void BasicSBTree<SingleWriter>::flush()
+{
+    seal_buffer_();
+    publish_run_({}, 0); // 并入尚在侧缓冲中的迟到点
+}
+
+// ========================= 内部辅助 =========================
+void BasicSBTree<SingleWriter>::on_index_tick_()
+{
+    tick_.store(true, std::memory_order_relaxed);
+}
+
+// 单一 run：有序时直接切块，否则先基数排序；全部在本线程完成
+void BasicSBTree<SingleWriter>::seal_buffer_()
+{
+    if (buf_.empty())
+        return;
+    ConversionJob job({KVRun{buf_.data(), buf_.size()}});
+    job.run_all();
+    std::vector<DataBlock *> blocks = job.take_blocks();
+    buf_.clear();
+    publish_run_(std::move(blocks), job.total_entries());
+}
@@ -0,0 +1,93 @@
+#include "TailDirectory.h"
+#include "DataBlock.h"
+#include "EpochManager.h"
+#include "Simd.h"
+#include <algorithm>
+
+// ========================= 构造/析构 =========================
+TailDirectory::TailDirectory(std::size_t capacity)
+    : capacity_(capacity)
+{
+}
+
+// 析构时已无读者：当前目录直接释放，已退役的旧目录由 EpochManager 释放
+TailDirectory::~TailDirectory()
+{
+    delete dir_.exchange(nullptr);
+}
+
+// ========================= 写侧 =========================
+void TailDirectory::on_append(const std::vector<DataBlock *> &blocks)
+{
+    if (capacity_ == 0 || blocks.empty())
+        return;
+    // run 比目录还长时只需要它的末尾部分
+    const std::size_t skip = blocks.size() > capacity_ ? blocks.size() - capacity_ : 0;
+    recent_.insert(recent_.end(), blocks.begin() + skip, blocks.end());
+    trim_();
+    dirty_ = true;
+}
+
+// 写时复制并入迟到点后，old（与 absorbed）在链上被 [first..last]（经 next 相连）取代。
+// 目录是链的后缀：old 不在目录中而 absorbed 在时，它恰为目录首块
+void TailDirectory::on_replace(DataBlock *old, DataBlock *first, DataBlock *last, DataBlock *absorbed)
+{
+    if (capacity_ == 0)
+        return;
+    auto it = std::find(recent_.begin(), recent_.end(), old);
+    if (it != recent_.end())
+        it = recent_.erase(it);
+    else if (absorbed && !recent_.empty() && recent_.front() == absorbed)
+        it = recent_.begin();
+    else
+        return;
+    if (absorbed && it != recent_.end() && *it == absorbed)
+        it = recent_.erase(it);
+    std::vector<DataBlock *> repl;
+    for (DataBlock *b = first;; b = b->next())
+    {
+        repl.push_back(b);
+        if (b == last)
+            break;
+    }
+    recent_.insert(it, repl.begin(), repl.end());
+    trim_();
+    dirty_ = true;
+}
+
+void TailDirectory::publish()
+{
+    if (!dirty_)
+        return;
+    dirty_ = false;
+    auto *dir = new Dir();
+    dir->keys.reserve(recent_.size());
+    dir->blocks.reserve(recent_.size());
+    for (DataBlock *b : recent_)
+    {
+        dir->keys.push_back(b->min_key());
+        dir->blocks.push_back(b);
+    }
+    Dir *prev = dir_.exchange(dir, std::memory_order_seq_cst);
+    if (prev)
+        EpochManager::instance().retire(prev);
+}
+
+void TailDirectory::trim_()
+{
+    while (recent_.size() > capacity_)
+        recent_.pop_front();
+}
+
+// ========================= 读侧 =========================
+DataBlock *TailDirectory::find(Key k) const noexcept
+{
+    if (capacity_ == 0)
+        return nullptr;
+    EpochGuard guard;
+    const Dir *dir = dir_.load(std::memory_order_seq_cst);
+    if (!dir || dir->keys.empty() || k < dir->keys.front())
+        return nullptr;
+    const std::size_t c = simd_count_le(dir->keys.data(), dir->keys.size(), k);
+    return dir->blocks[c - 1];
+}
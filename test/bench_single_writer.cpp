@@ -0,0 +1,44 @@
+// 单写线程基准：同一单调 key 序列分别写入多写版本 (SBTree) 与单写特化
+// (SingleWriterSBTree)，比较插入吞吐。用法：bench_single_writer [总条数]
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+template <class Tree>
+static double run_once(size_t n)
+{
+    Tree tree;
+    auto t0 = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < n; ++i)
+        tree.insert(static_cast<Key>(i), static_cast<Value>(i * 10));
+    tree.flush();
+    auto t1 = std::chrono::steady_clock::now();
+    tree.flush_index();
+    if (!tree.verify_data_layer(n))
+    {
+        std::cerr << "verify_data_layer failed\n";
+        std::exit(1);
+    }
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+int main(int argc, char **argv)
+{
+    const size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+    const int rounds = 3;
+
+    double best_multi = 1e30, best_single = 1e30;
+    for (int r = 0; r < rounds; ++r)
+    {
+        best_multi = std::min(best_multi, run_once<SBTree>(n));
+        best_single = std::min(best_single, run_once<SingleWriterSBTree>(n));
+    }
+
+    std::cout << "entries          : " << n << "\n";
+    std::cout << "MultiWriter  Mops: " << n / best_multi / 1e6 << "\n";
+    std::cout << "SingleWriter Mops: " << n / best_single / 1e6 << "\n";
+    std::cout << "speedup          : " << best_multi / best_single << "x\n";
+    return 0;
+}
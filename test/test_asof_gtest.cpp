@@ -0,0 +1,131 @@
+// test/test_asof_gtest.cpp
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+// 真值：按 key 排序的全部条目（数据层与溢出区同 key 时数据层的值以 *10 结尾）
+static bool floor_truth(const std::vector<KVPair> &truth, Key k, KVPair *out)
+{
+    auto it = std::upper_bound(truth.begin(), truth.end(), k,
+                               [](Key a, const KVPair &b)
+                               { return a < b.key; });
+    if (it == truth.begin())
+        return false;
+    *out = *(it - 1);
+    return true;
+}
+
+template <class Tree>
+static void check_asof(SearchLayerKind kind)
+{
+    SBTreeOptions opts;
+    opts.search_layer = kind;
+    opts.disorder_window = 20000;
+    Tree t(opts);
+    std::vector<KVPair> truth;
+    const Key N = 3000000;
+    for (Key k = 1000; k < N; k += 10)
+    {
+        t.insert(k, k * 10);
+        truth.push_back({k, k * 10});
+    }
+    t.flush();
+    for (Key k = N - 15003; k < N; k += 10) // 写时复制并入，满块拆分
+    {
+        t.insert(k, k * 10);
+        truth.push_back({k, k * 10});
+    }
+    for (Key k = 5007; k < 2000000; k += 7001) // 溢出区
+    {
+        t.insert(k, k * 10);
+        truth.push_back({k, k * 10});
+    }
+    for (Key k = 9000; k < 2000000; k += 50000) // 溢出区中与数据层同 key：取数据层
+        t.insert(k, k * 10 + 1);
+    t.flush();
+    t.flush_index();
+    ASSERT_GT(t.overflow_size(), 0u);
+    std::sort(truth.begin(), truth.end(),
+              [](const KVPair &a, const KVPair &b)
+              { return a.key < b.key; });
+
+    std::mt19937_64 rng(31);
+    for (int it = 0; it < 20000; ++it)
+    {
+        const Key k = rng() % (N + 100);
+        KVPair got{}, want{};
+        const bool hit = t.lookup_floor(k, &got);
+        ASSERT_EQ(hit, floor_truth(truth, k, &want)) << "k=" << k;
+        if (hit)
+        {
+            ASSERT_EQ(got.key, want.key) << "k=" << k;
+            ASSERT_EQ(got.value, want.value) << "k=" << k;
+        }
+    }
+
+    // 不同步长：块内多点、逐块、跨越多块与超出末尾
+    for (Key step : {Key(0), Key(1), Key(3), Key(37), Key(2500), Key(40000), Key(700001)})
+    {
+        const Key start = 990 + rng() % 50;
+        const size_t count = step == 0 ? 5 : std::min<size_t>(20000, (N + 50000 - start) / step + 2);
+        std::vector<KVPair> out(count, KVPair{7, 7});
+        std::unique_ptr<bool[]> f(new bool[count]);
+        const size_t hits = t.sample_asof(start, step, count, out.data(), f.get());
+        size_t expect_hits = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            KVPair want{};
+            const Key k = start + i * step;
+            const bool hit = floor_truth(truth, k, &want);
+            ASSERT_EQ(f[i], hit) << "step=" << step << " i=" << i;
+            if (hit)
+            {
+                ++expect_hits;
+                ASSERT_EQ(out[i].key, want.key) << "step=" << step << " i=" << i;
+                ASSERT_EQ(out[i].value, want.value) << "step=" << step << " i=" << i;
+            }
+            else
+                ASSERT_EQ(out[i].key, 7u); // 未命中时不写
+        }
+        EXPECT_EQ(hits, expect_hits);
+    }
+}
+
+TEST(AsOf, FloorAndSamplingMatchTruth)
+{
+    check_asof<SBTree>(SearchLayerKind::BTREE);
+    check_asof<SBTree>(SearchLayerKind::LEARNED);
+    check_asof<SingleWriterSBTree>(SearchLayerKind::BTREE);
+}
+
+// 边界：空树、早于全部数据、采样点越过 Key 上限、索引尚未追上
+TEST(AsOf, EdgeCases)
+{
+    SBTree empty;
+    KVPair kv{};
+    EXPECT_FALSE(empty.lookup_floor(100, &kv));
+    EXPECT_EQ(empty.sample_asof(0, 10, 4, &kv, nullptr), 0u);
+
+    SBTreeOptions opts;
+    opts.tail_directory_blocks = 0;
+    SBTree t(opts);
+    for (Key k = 100; k < 200000; k += 2)
+        t.insert(k, k);
+    t.flush(); // 不等待索引：floor 块可能只在链上
+
+    KVPair out[4];
+    EXPECT_EQ(t.sample_asof(50, 30, 4, out, nullptr), 2u); // 50、80 未命中，110、140 命中
+    EXPECT_EQ(out[2].key, 110u);
+    EXPECT_EQ(out[3].key, 140u);
+    ASSERT_TRUE(t.lookup_floor(199999, &kv));
+    EXPECT_EQ(kv.key, 199998u);
+
+    const Key max = std::numeric_limits<Key>::max();
+    bool f[3];
+    EXPECT_EQ(t.sample_asof(max - 5, 4, 3, out, f), 3u);
+    for (int i = 0; i < 3; ++i)
+        EXPECT_EQ(out[i].key, 199998u);
+}
@@ -0,0 +1,88 @@
+// test/test_bulk_load_gtest.cpp
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <vector>
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+static std::vector<KVPair> make_sorted(Key lo, Key hi)
+{
+    std::vector<KVPair> v;
+    v.reserve(hi - lo);
+    for (Key k = lo; k < hi; ++k)
+        v.push_back({k, k * 10});
+    return v;
+}
+
+// 多线程装载（块数不能被线程数整除、末块不满）：数据层、点查、扫描与逐条插入一致
+TEST(BulkLoad, ParallelLoadMatchesInsert)
+{
+    const Key N = 1000003;
+    for (size_t threads : {1u, 3u, 8u})
+    {
+        SBTree t;
+        auto data = make_sorted(0, N);
+        t.bulk_load(data.data(), data.size(), threads);
+
+        EXPECT_TRUE(t.verify_data_layer(N)) << "threads=" << threads;
+        EXPECT_EQ(t.appended_entries(), N);
+        EXPECT_EQ(t.index_items_applied(), (N + DataBlock::capacity() - 1) / DataBlock::capacity());
+        EXPECT_EQ(t.index_levels(), 2u); // 4001 块 / 扇出 64 → 62 个父键
+        for (Key k = 0; k < N; k += 997)
+        {
+            Value v = 0;
+            ASSERT_TRUE(t.lookup(k, &v)) << k;
+            ASSERT_EQ(v, k * 10);
+        }
+        std::vector<Value> vals;
+        EXPECT_EQ(t.scan(N - 600, N + 5, vals), 600u);
+    }
+}
+
+// 与逐条写入混用：装载追加在已有数据之后，之后的写入继续走快路径；
+// 低于水位的装载数据按迟到点并入
+TEST(BulkLoad, MixesWithInsertAndLateData)
+{
+    SingleWriterSBTree t;
+    for (Key k = 0; k < 10000; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+
+    std::vector<KVPair> late; // 填补 [1, 9999] 的奇数空缺 + 新区间 [10000, 60000)
+    for (Key k = 1; k < 10000; k += 2)
+        late.push_back({k, k * 10});
+    auto fresh = make_sorted(10000, 60000);
+    late.insert(late.end(), fresh.begin(), fresh.end());
+    std::sort(late.begin(), late.end(), [](const KVPair &a, const KVPair &b)
+              { return a.key < b.key; });
+    t.bulk_load(late.data(), late.size());
+
+    for (Key k = 60000; k < 70000; ++k)
+        t.insert(k, k * 10);
+    t.flush();
+    t.flush_index();
+    EXPECT_TRUE(t.verify_data_layer(70000));
+}
+
+// 流式装载：分段提供（段长不是块容量整数倍），结果与一次装载相同
+TEST(BulkLoad, StreamingLoad)
+{
+    SBTree t;
+    const Key N = 3000000;
+    Key next = 0;
+    size_t calls = 0;
+    const size_t total = t.bulk_load_stream([&](KVPair *buf, size_t cap)
+                                            {
+                                                ++calls;
+                                                const size_t n = std::min<size_t>(cap - 7, N - next);
+                                                for (size_t i = 0; i < n; ++i, ++next)
+                                                    buf[i] = {next, next * 10};
+                                                return n; },
+                                            4);
+    EXPECT_EQ(total, N);
+    EXPECT_GE(calls, 3u);
+    EXPECT_TRUE(t.verify_data_layer(N));
+    Value v = 0;
+    ASSERT_TRUE(t.lookup(N - 1, &v));
+    EXPECT_EQ(v, (N - 1) * 10);
+}
@@ -0,0 +1,133 @@
+// test/test_cooperative_conversion_gtest.cpp
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "ConversionJob.h"
+#include "DataBlock.h"
+#include "KVPair.h"
+#include "SBTree.h"
+
+// 把 job 产出的块链展开成 KV 序列，并释放块
+static std::vector<KVPair> drain_blocks(std::vector<DataBlock *> blocks)
+{
+    std::vector<KVPair> out;
+    for (size_t i = 0; i < blocks.size(); ++i)
+    {
+        if (i + 1 < blocks.size())
+        {
+            EXPECT_EQ(blocks[i]->next(), blocks[i + 1]);
+        }
+        for (size_t j = 0; j < blocks[i]->size(); ++j)
+            out.push_back(blocks[i]->get_entry(j));
+    }
+    for (auto *b : blocks)
+        delete b;
+    return out;
+}
+
+// 多个 run 交错（含无序 run 与重复 key）：结果等于全局排序，且除最后一块外均满
+TEST(CooperativeConversion, RangesMatchSerialSort)
+{
+    const size_t R = 12, per = 1000;
+    std::vector<std::vector<KVPair>> runs(R);
+    std::vector<KVPair> expect;
+    for (size_t r = 0; r < R; ++r)
+    {
+        for (size_t i = 0; i < per; ++i)
+        {
+            Key k = i * R + r;
+            if (r == 3)
+                k = (i * 7919) % (per * R); // 无序 run
+            if (r == 5)
+                k = (i / 4) * R;            // 含重复 key
+            runs[r].push_back({k, k * 10});
+            expect.push_back({k, k * 10});
+        }
+    }
+    std::vector<KVRun> views;
+    for (auto &r : runs)
+        views.push_back({r.data(), r.size()});
+
+    ConversionJob job(views);
+    ConversionCoordinator conv;
+    conv.run(job);
+    ASSERT_EQ(job.total_entries(), R * per);
+
+    std::vector<DataBlock *> blocks = job.take_blocks();
+    for (size_t i = 0; i + 1 < blocks.size(); ++i)
+        EXPECT_EQ(blocks[i]->size(), DataBlock::capacity());
+
+    std::vector<KVPair> got = drain_blocks(std::move(blocks));
+    ASSERT_EQ(got.size(), expect.size());
+    std::stable_sort(expect.begin(), expect.end(),
+                     [](const KVPair &a, const KVPair &b)
+                     { return a.key < b.key; });
+    for (size_t i = 0; i < got.size(); ++i)
+        ASSERT_EQ(got[i].key, expect[i].key) << "at " << i;
+}
+
+// 协助线程并发领取任务：结果不变，且协助者确实执行过任务
+TEST(CooperativeConversion, HelpersShareTheWork)
+{
+    const size_t R = 64, per = 1023;
+    std::vector<std::vector<KVPair>> runs(R);
+    for (size_t r = 0; r < R; ++r)
+        for (size_t i = 0; i < per; ++i)
+            runs[r].push_back({i * R + r, i * R + r});
+    std::vector<KVRun> views;
+    for (auto &r : runs)
+        views.push_back({r.data(), r.size()});
+
+    ConversionCoordinator conv;
+    std::atomic<bool> stop{false};
+    std::atomic<size_t> helped{0};
+    std::vector<std::thread> helpers;
+    for (int t = 0; t < 3; ++t)
+        helpers.emplace_back([&]
+                             {
+            while (!stop.load(std::memory_order_acquire))
+                if (conv.help())
+                    helped.fetch_add(1, std::memory_order_relaxed);
+                else
+                    std::this_thread::yield(); });
+
+    for (int round = 0; round < 20; ++round)
+    {
+        ConversionJob job(views);
+        conv.run(job);
+        std::vector<KVPair> got = drain_blocks(job.take_blocks());
+        ASSERT_EQ(got.size(), R * per);
+        for (size_t i = 0; i < got.size(); ++i)
+            ASSERT_EQ(got[i].key, i);
+    }
+    stop.store(true, std::memory_order_release);
+    for (auto &h : helpers)
+        h.join();
+    EXPECT_FALSE(conv.has_work());
+    std::cout << "[test] tasks run by helpers: " << helped.load() << "\n";
+}
+
+// 一个线程交替写两棵树：每棵树的段内只占一个 PTB，段按 PTB 写满转换，
+// 转换次数与单独写入一棵树相同（不会因切换而不断认领新槽位、提前封印）
+TEST(CooperativeConversion, OneThreadFeedsTwoTrees)
+{
+    SBTree a, b;
+    const Key N = 200000;
+    for (Key k = 0; k < N; ++k)
+    {
+        a.insert(k, k);
+        b.insert(k, k + 1);
+    }
+    const uint64_t per_tree = N / PerThreadDataBlock::Capacity(); // 写满即转换
+    EXPECT_EQ(a.index_batches_enqueued(), per_tree);
+    EXPECT_EQ(b.index_batches_enqueued(), per_tree);
+    a.flush();
+    b.flush();
+    EXPECT_EQ(a.count(0, N), N);
+    EXPECT_EQ(b.count(0, N), N);
+    Value v = 0;
+    ASSERT_TRUE(b.lookup(N - 1, &v));
+    EXPECT_EQ(v, N);
+}
@@ -0,0 +1,153 @@
+// test/test_downsample_gtest.cpp
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "Simd.h"
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+// SIMD 归约与标量结果一致（任意长度、初值与取值范围）
+TEST(Downsample, MinMaxSumKernelMatchesScalar)
+{
+    std::mt19937_64 rng(41);
+    for (int it = 0; it < 5000; ++it)
+    {
+        std::vector<Value> v(rng() % 100);
+        for (auto &x : v)
+            x = it % 2 ? rng() : rng() % 1000;
+        Value mn = it % 3 ? std::numeric_limits<Value>::max() : rng(), mx = it % 3 ? 0 : rng() % 10, sum = rng();
+        Value a = mn, b = mx, c = sum;
+        for (Value x : v)
+        {
+            a = std::min(a, x);
+            b = std::max(b, x);
+            c += x;
+        }
+        simd_min_max_sum(v.data(), v.size(), &mn, &mx, &sum);
+        ASSERT_EQ(mn, a);
+        ASSERT_EQ(mx, b);
+        ASSERT_EQ(sum, c);
+    }
+}
+
+// 逐条扫描得到的真值
+template <class Tree>
+static std::vector<SBTree::Bucket> naive(const Tree &t, Key l, Key r, Key w, size_t nb)
+{
+    std::vector<SBTree::Bucket> out(nb);
+    for (size_t b = 0; b < nb; ++b)
+        out[b] = SBTree::Bucket{l + b * w, 0, 0, 0, 0, 0, 0};
+    auto cur = t.open_range_cursor(l, r);
+    KVPair kv;
+    while (cur.next(&kv))
+    {
+        const size_t b = (kv.key - l) / w;
+        if (b >= nb)
+            break;
+        SBTree::Bucket &o = out[b];
+        o.min = o.count == 0 ? kv.value : std::min(o.min, kv.value);
+        o.max = std::max(o.max, kv.value);
+        o.sum += kv.value;
+        ++o.count;
+        o.last_key = kv.key;
+        o.last = kv.value;
+    }
+    return out;
+}
+
+template <class Tree>
+static void check_downsample(SearchLayerKind kind)
+{
+    SBTreeOptions opts;
+    opts.search_layer = kind;
+    opts.disorder_window = 20000;
+    Tree t(opts);
+    std::mt19937_64 rng(43);
+    const Key N = 2000000;
+    for (Key k = 0; k < N; k += 1 + rng() % 5)
+        t.insert(k, rng() % 100000);
+    t.flush();
+    for (Key k = N - 15001; k < N; k += 7) // 写时复制并入
+        t.insert(k, rng() % 100000);
+    for (Key k = 1003; k < 1500000; k += 997) // 溢出区
+        t.insert(k, rng() % 100000);
+    t.flush();
+    t.flush_index();
+    ASSERT_GT(t.overflow_size(), 0u);
+
+    for (Key w : {Key(1), Key(3), Key(60), Key(1000), Key(77777), Key(5000000)})
+    {
+        const Key l = rng() % 100000, r = w == 1 ? l + 5000 : N - rng() % 100000;
+        const size_t total = (r - l) / w + 1;
+        std::vector<SBTree::Bucket> got(total);
+        ASSERT_EQ(t.downsample(l, r, w, SBTree::AGG_ALL, got.data(), got.size()), total);
+        const auto want = naive(t, l, r, w, total);
+        for (size_t b = 0; b < total; ++b)
+        {
+            ASSERT_EQ(got[b].start, want[b].start) << "w=" << w << " b=" << b;
+            ASSERT_EQ(got[b].count, want[b].count) << "w=" << w << " b=" << b;
+            ASSERT_EQ(got[b].min, want[b].min) << "w=" << w << " b=" << b;
+            ASSERT_EQ(got[b].max, want[b].max) << "w=" << w << " b=" << b;
+            ASSERT_EQ(got[b].sum, want[b].sum) << "w=" << w << " b=" << b;
+            ASSERT_EQ(got[b].last_key, want[b].last_key) << "w=" << w << " b=" << b;
+            ASSERT_EQ(got[b].last, want[b].last) << "w=" << w << " b=" << b;
+        }
+
+        // 缓冲不足：只写前 cap 个桶，结果与完整输出的前缀相同
+        const size_t cap = total / 3;
+        std::vector<SBTree::Bucket> part(cap + 1, SBTree::Bucket{7, 7, 7, 7, 7, 7, 7});
+        ASSERT_EQ(t.downsample(l, r, w, SBTree::AGG_MAX | SBTree::AGG_LAST, part.data(), cap), total);
+        for (size_t b = 0; b < cap; ++b)
+        {
+            ASSERT_EQ(part[b].count, want[b].count) << "w=" << w << " b=" << b;
+            ASSERT_EQ(part[b].max, want[b].max);
+            ASSERT_EQ(part[b].last, want[b].last);
+            ASSERT_EQ(part[b].min, 0u); // 未选中
+            ASSERT_EQ(part[b].sum, 0u);
+        }
+        EXPECT_EQ(part[cap].start, 7u); // 不越过 cap
+    }
+}
+
+TEST(Downsample, MatchesNaiveBucketing)
+{
+    check_downsample<SBTree>(SearchLayerKind::BTREE);
+    check_downsample<SBTree>(SearchLayerKind::LEARNED);
+    check_downsample<SingleWriterSBTree>(SearchLayerKind::BTREE);
+}
+
+TEST(Downsample, EdgeCases)
+{
+    SBTree t;
+    std::vector<KVPair> data;
+    const Key max = std::numeric_limits<Key>::max();
+    for (Key k = 0; k < 1000; ++k)
+        data.push_back({max - 2000 + k * 2, k});
+    t.bulk_load(data.data(), data.size());
+
+    SBTree::Bucket b[4];
+    EXPECT_EQ(t.downsample(5, 4, 10, SBTree::AGG_ALL, b, 4), 0u);
+    EXPECT_EQ(t.downsample(0, 10, 0, SBTree::AGG_ALL, b, 4), 0u);
+    // 桶延伸到 Key 上限：最后一个桶截止于 r
+    EXPECT_EQ(t.downsample(max - 3000, max, 1000, SBTree::AGG_ALL, b, 4), 4u);
+    EXPECT_EQ(b[0].count, 0u);
+    EXPECT_EQ(b[0].min, 0u);
+    EXPECT_EQ(b[1].count, 500u);
+    EXPECT_EQ(b[2].count, 500u);
+    EXPECT_EQ(b[3].count, 0u);
+    EXPECT_EQ(b[2].last, 999u);
+    EXPECT_DOUBLE_EQ(b[1].avg(), 249.5);
+
+    // 覆盖整个 Key 范围、宽度 1：桶数 2^64 不可表示，饱和而不回绕为 0；仍写出前 cap 个桶
+    EXPECT_EQ(t.downsample(0, max, 1, SBTree::AGG_ALL, b, 4), std::numeric_limits<size_t>::max());
+    for (size_t i = 0; i < 4; ++i)
+    {
+        EXPECT_EQ(b[i].start, i);
+        EXPECT_EQ(b[i].count, 0u);
+    }
+    EXPECT_EQ(t.downsample(0, max, 2, SBTree::AGG_ALL, b, 0), size_t(1) << 63);
+    EXPECT_EQ(t.downsample(0, max, max, SBTree::AGG_ALL, b, 4), 2u);
+    EXPECT_EQ(b[1].start, max);
+    EXPECT_EQ(b[0].count, 1000u); // 全部点都低于 max
+    EXPECT_EQ(b[1].count, 0u);
+}
@@ -0,0 +1,125 @@
+// test/test_epoch_reclaim_gtest.cpp
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "EpochManager.h"
+
+namespace
+{
+    std::atomic<int> g_live{0};
+    struct Tracked
+    {
+        uint64_t a, b; // 不变式：b == a * 3
+        explicit Tracked(uint64_t x) : a(x), b(x * 3) { g_live.fetch_add(1); }
+        ~Tracked()
+        {
+            b = 0; // 释放后若仍被读到，不变式会被打破（ASan 下直接报错）
+            g_live.fetch_sub(1);
+        }
+    };
+}
+
+// 其他线程仍在临界区内时，退役对象不会被释放；临界区结束后宽限期过去即释放
+TEST(EpochReclaim, RetiredObjectOutlivesActiveReader)
+{
+    auto &em = EpochManager::instance();
+    em.synchronize();
+    const int base = g_live.load();
+
+    std::atomic<bool> entered{false}, leave{false};
+    std::thread reader([&]
+                       {
+                           EpochGuard g;
+                           entered.store(true);
+                           while (!leave.load())
+                               std::this_thread::yield(); });
+    while (!entered.load())
+        std::this_thread::yield();
+
+    em.retire(new Tracked(7));
+    for (int i = 0; i < 10; ++i)
+        em.retire(new Tracked(i)); // 触发若干次推进尝试
+    EXPECT_EQ(g_live.load(), base + 11); // 读者未退出：全部保留
+
+    leave.store(true);
+    reader.join();
+    em.synchronize();
+    EXPECT_EQ(g_live.load(), base);
+}
+
+// 嵌套临界区只在最外层登记与清除
+TEST(EpochReclaim, NestedGuards)
+{
+    auto &em = EpochManager::instance();
+    em.synchronize();
+    {
+        EpochGuard outer;
+        {
+            EpochGuard inner;
+        }
+        const uint64_t e = em.epoch();
+        em.retire(new Tracked(1));
+        em.retire(new Tracked(2));
+        EXPECT_LE(em.epoch(), e + 1); // 外层仍在临界区，纪元至多前进一步
+    }
+    em.synchronize();
+    EXPECT_EQ(em.pending(), 0u);
+}
+
+// 读者持续读取原子指针、写者不断替换并退役旧对象：读者从不读到已释放对象
+TEST(EpochReclaim, ConcurrentPublishAndRead)
+{
+    std::atomic<Tracked *> cur{new Tracked(0)};
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 3; ++t)
+        readers.emplace_back([&]
+                             {
+                                 while (!stop.load(std::memory_order_relaxed))
+                                 {
+                                     EpochGuard g;
+                                     const Tracked *p = cur.load(std::memory_order_seq_cst);
+                                     ASSERT_EQ(p->b, p->a * 3);
+                                 } });
+    for (uint64_t i = 1; i <= 20000; ++i)
+    {
+        Tracked *old = cur.exchange(new Tracked(i), std::memory_order_seq_cst);
+        EpochManager::instance().retire(old);
+    }
+    stop.store(true);
+    for (auto &th : readers)
+        th.join();
+    delete cur.load();
+    EpochManager::instance().synchronize();
+}
+
+// EpochPin：在临界区内取得的指针，离开临界区后由 Pin 继续保护；
+// Pin 移交给其他线程析构后，宽限期过去即释放
+TEST(EpochReclaim, PinOutlivesGuardAndMovesAcrossThreads)
+{
+    auto &em = EpochManager::instance();
+    em.synchronize();
+    const int base = g_live.load();
+
+    std::atomic<Tracked *> cur{new Tracked(5)};
+    Tracked *held = nullptr;
+    EpochPin pin;
+    {
+        EpochGuard g;
+        held = cur.load(std::memory_order_seq_cst);
+        EpochPin inner; // 沿用临界区的纪元
+        pin = std::move(inner);
+    }
+    em.retire(cur.exchange(nullptr, std::memory_order_seq_cst));
+    for (int i = 0; i < 10; ++i)
+        em.retire(new Tracked(i));
+    EXPECT_EQ(held->b, held->a * 3); // 仍未释放
+    EXPECT_EQ(g_live.load(), base + 11);
+
+    std::thread other([p = std::move(pin)]() mutable
+                      { p.reset(); });
+    other.join();
+    em.synchronize();
+    EXPECT_EQ(g_live.load(), base);
+}
@@ -0,0 +1,142 @@
+// test/test_filtered_scan_gtest.cpp
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "DataBlock.h"
+#include "Simd.h"
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+// 过滤内核与逐项判断一致，且不写出超过 n 个位置
+TEST(FilteredScan, KernelMatchesScalar)
+{
+    std::mt19937_64 rng(51);
+    for (int it = 0; it < 5000; ++it)
+    {
+        const size_t n = rng() % 100;
+        std::vector<Key> k(n);
+        std::vector<Value> v(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            k[i] = rng();
+            v[i] = it % 3 == 0 ? rng() : rng() % 100;
+        }
+        Value lo = it % 3 == 0 ? rng() : rng() % 100, hi = it % 3 == 0 ? rng() : rng() % 100;
+        if (lo > hi)
+            std::swap(lo, hi);
+        std::vector<Key> ok(n + 1, 7);
+        std::vector<Value> ov(n + 1, 7);
+        const size_t hits = simd_filter_range(k.data(), v.data(), n, lo, hi, ok.data(), ov.data());
+        size_t e = 0;
+        for (size_t i = 0; i < n; ++i)
+            if (v[i] >= lo && v[i] <= hi)
+            {
+                ASSERT_EQ(ok[e], k[i]);
+                ASSERT_EQ(ov[e], v[i]);
+                ++e;
+            }
+        ASSERT_EQ(hits, e);
+        ASSERT_EQ(ok[n], 7u);
+        ASSERT_EQ(ov[n], 7u);
+    }
+}
+
+TEST(FilteredScan, BlockValueStatistics)
+{
+    std::vector<KVPair> kv;
+    for (Key k = 0; k < 100; ++k)
+        kv.push_back({k, 1000 + (k * 37) % 91});
+    DataBlock b;
+    b.build_from_sorted(kv.data(), kv.size());
+    EXPECT_EQ(b.value_min(), 1000u);
+    EXPECT_EQ(b.value_max(), 1090u);
+    DataBlock empty;
+    EXPECT_GT(empty.value_min(), empty.value_max());
+}
+
+template <class Tree>
+static void check_filtered(SearchLayerKind kind)
+{
+    SBTreeOptions opts;
+    opts.search_layer = kind;
+    opts.disorder_window = 20000;
+    Tree t(opts);
+    std::mt19937_64 rng(53);
+    const Key N = 400000;
+    // 值随 key 缓慢变化（多数块可整块跳过），夹杂少量尖峰
+    for (Key k = 0; k < N; ++k)
+        t.insert(k, k / 1000 + (rng() % 5000 == 0 ? 100000 : 0));
+    t.flush();
+    for (Key k = N - 15001; k < N; k += 2) // 写时复制并入（同 key）
+        t.insert(k, 5);
+    for (Key k = 1001; k < 300000; k += 997) // 溢出区
+        t.insert(k, 500);
+    t.flush();
+    t.flush_index();
+    ASSERT_GT(t.overflow_size(), 0u);
+
+    struct Pred
+    {
+        Value lo, hi;
+    };
+    for (Pred p : {Pred{500, 500}, Pred{100000, std::numeric_limits<Value>::max()}, Pred{0, 10},
+                   Pred{0, std::numeric_limits<Value>::max()}, Pred{390, 395}, Pred{2000, 3000}})
+    {
+        for (int it = 0; it < 3; ++it)
+        {
+            const Key l = it == 0 ? 0 : rng() % N, r = it == 0 ? N : l + rng() % 150000;
+            std::vector<Key> wk;
+            std::vector<Value> wv;
+            auto cur = t.open_range_cursor(l, r);
+            KVPair kv;
+            while (cur.next(&kv))
+                if (kv.value >= p.lo && kv.value <= p.hi)
+                {
+                    wk.push_back(kv.key);
+                    wv.push_back(kv.value);
+                }
+
+            std::vector<Key> gk{42};
+            std::vector<Value> gv{42};
+            EXPECT_EQ(t.scan_filtered(l, r, p.lo, p.hi, gk, gv), wk.size());
+            ASSERT_EQ(gk.size(), wk.size() + 1);
+            ASSERT_EQ(gv.size(), wv.size() + 1);
+            for (size_t i = 0; i < wk.size(); ++i)
+            {
+                ASSERT_EQ(gk[i + 1], wk[i]) << "lo=" << p.lo << " l=" << l << " i=" << i;
+                ASSERT_EQ(gv[i + 1], wv[i]) << "lo=" << p.lo << " l=" << l << " i=" << i;
+            }
+
+            // 小缓冲：多次调用拼起来相同
+            for (size_t cap : {size_t(1), size_t(7), size_t(300)})
+            {
+                std::vector<Key> ck;
+                std::vector<Value> cv;
+                std::vector<Key> bk(cap);
+                std::vector<Value> bv(cap);
+                auto c2 = t.open_range_cursor(l, r);
+                size_t got;
+                while ((got = c2.next_filtered(p.lo, p.hi, bk.data(), bv.data(), cap)) > 0)
+                {
+                    ASSERT_LE(got, cap);
+                    ck.insert(ck.end(), bk.begin(), bk.begin() + got);
+                    cv.insert(cv.end(), bv.begin(), bv.begin() + got);
+                }
+                ASSERT_EQ(ck, wk) << "cap=" << cap;
+                ASSERT_EQ(cv, wv) << "cap=" << cap;
+            }
+        }
+    }
+    std::vector<Key> k;
+    std::vector<Value> v;
+    EXPECT_EQ(t.scan_filtered(5, 4, 0, 10, k, v), 0u);
+    EXPECT_EQ(t.scan_filtered(0, N, 10, 9, k, v), 0u);
+    EXPECT_TRUE(k.empty() && v.empty());
+}
+
+TEST(FilteredScan, MatchesNaiveFilter)
+{
+    check_filtered<SBTree>(SearchLayerKind::BTREE);
+    check_filtered<SBTree>(SearchLayerKind::LEARNED);
+    check_filtered<SingleWriterSBTree>(SearchLayerKind::BTREE);
+}
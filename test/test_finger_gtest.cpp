@@ -0,0 +1,142 @@
+// test/test_finger_gtest.cpp
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "SearchLayer.h"
+#include "LearnedSearchLayer.h"
+#include "DataBlock.h"
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+static DataBlock *make_block_with_one(Key k)
+{
+    KVPair kv{k, static_cast<Value>(k * 10)};
+    auto *b = new DataBlock();
+    b->build_from_sorted(&kv, 1);
+    return b;
+}
+
+// 任意提示（有效、越界、键大于 k、远跳）下结果都与完整下降相同
+template <class Layer>
+static void check_near(Layer &layer)
+{
+    std::vector<DataBlock *> owned;
+    std::vector<DataBlock *> run;
+    for (Key i = 0; i < 30000; ++i)
+    {
+        owned.push_back(make_block_with_one(i * 100 + (i % 3 == 0 ? 0 : 7)));
+        run.push_back(owned.back());
+    }
+    layer.append_run(run);
+
+    std::mt19937_64 rng(5);
+    for (int it = 0; it < 50000; ++it)
+    {
+        const Key k = rng() % 3100000;
+        size_t hint = (it % 5 == 0) ? static_cast<size_t>(-1) : rng() % 31000;
+        DataBlock *got = layer.find_candidate_near(k, &hint);
+        ASSERT_EQ(got, layer.find_candidate(k)) << "k=" << k;
+        if (got)
+            ASSERT_EQ(owned[hint], got);
+        else
+            ASSERT_EQ(hint, static_cast<size_t>(-1));
+    }
+    for (auto *b : owned)
+        delete b;
+}
+
+TEST(Finger, NearSearchMatchesFullDescent)
+{
+    SearchLayer sl(16);
+    check_near(sl);
+    LearnedSearchLayer ls(8);
+    check_near(ls);
+}
+
+// 单调递增的点查几乎都沿链前进；远跳、回退与随机顺序结果仍与 lookup 一致
+template <class Tree>
+static void check_finger(SearchLayerKind kind)
+{
+    SBTreeOptions opts;
+    opts.search_layer = kind;
+    Tree t(opts);
+    const Key N = 400000;
+    for (Key k = 0; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    t.flush_index();
+
+    auto f = t.finger();
+    for (Key k = 0; k < N; ++k)
+    {
+        Value v = 0, w = 0;
+        const bool hit = f.lookup(k, &v);
+        ASSERT_EQ(hit, t.lookup(k, &w)) << "k=" << k;
+        if (hit)
+        {
+            ASSERT_EQ(v, w);
+        }
+    }
+    EXPECT_LE(f.fallbacks(), 2u); // 仅首次定位
+
+    std::mt19937_64 rng(9);
+    for (int it = 0; it < 20000; ++it)
+    {
+        const Key k = rng() % (N + 100);
+        Value v = 0;
+        ASSERT_EQ(f.lookup(k, &v), k < N && k % 2 == 0) << "k=" << k;
+    }
+
+    // 缓存块被写时复制替换后放弃它，能查到新并入的迟到点
+    Value v = 0;
+    ASSERT_TRUE(f.lookup(1000, &v));
+    for (Key k = 901; k < 1200; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    t.flush_index();
+    for (Key k = 900; k < 1200; ++k)
+    {
+        ASSERT_TRUE(f.lookup(k, &v)) << "k=" << k;
+        ASSERT_EQ(v, k * 10);
+    }
+}
+
+TEST(Finger, SequentialLookupsFollowTheChain)
+{
+    check_finger<SBTree>(SearchLayerKind::BTREE);
+    check_finger<SBTree>(SearchLayerKind::LEARNED);
+    check_finger<SingleWriterSBTree>(SearchLayerKind::BTREE);
+}
+
+// 未命中（叶层提示失效）后经尾部目录定位并沿链前进，提示不回绕为 0；
+// 随后的远跳仍与 lookup 一致，沿链部分不额外回退
+TEST(Finger, MissThenLookup)
+{
+    SBTree t;
+    const Key N = 200000;
+    for (Key k = 1000; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    t.flush_index();
+
+    auto f = t.finger();
+    Value v = 0;
+    EXPECT_FALSE(f.lookup(5, &v)); // 低于全部数据：提示置为无效
+    const uint64_t base = f.fallbacks();
+    for (Key k = N - 2000; k < N; k += 2) // 最近的块：尾部目录定位后沿链前进
+    {
+        ASSERT_TRUE(f.lookup(k, &v)) << "k=" << k;
+        ASSERT_EQ(v, k * 10);
+    }
+    EXPECT_LE(f.fallbacks(), base + 1);
+    for (Key k : {Key(1000), Key(N / 2), Key(1001), Key(3), Key(N - 2), Key(N + 7)})
+    {
+        Value w = 0;
+        const bool hit = f.lookup(k, &v);
+        ASSERT_EQ(hit, t.lookup(k, &w)) << "k=" << k;
+        if (hit)
+        {
+            ASSERT_EQ(v, w);
+        }
+    }
+}
@@ -0,0 +1,269 @@
+// test/test_fresh_reads_gtest.cpp
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "PerThreadDataBlock.h"
+#include "SBTree.h"
+
+static std::vector<KVPair> collect(const SBTree &t, Key l, Key r)
+{
+    std::vector<KVPair> out;
+    t.open_range_cursor(l, r).next_batch(out, ~size_t(0));
+    return out;
+}
+
+// PTB 的新鲜读视图：有序时二分，出现逆序写入后改为顺序过滤
+TEST(FreshReads, PerThreadBlockView)
+{
+    PerThreadDataBlock p;
+    for (Key k = 10; k < 200; k += 10)
+        ASSERT_TRUE(p.Insert(k, k * 10));
+    std::vector<KVPair> out;
+    p.CopyRange(35, 90, out);
+    ASSERT_EQ(out.size(), 6u);
+    EXPECT_EQ(out.front().key, 40u);
+    EXPECT_EQ(out.back().key, 90u);
+    Value v = 0;
+    EXPECT_TRUE(p.Find(150, &v));
+    EXPECT_EQ(v, 1500u);
+    EXPECT_FALSE(p.Find(155, &v));
+
+    ASSERT_TRUE(p.Insert(5, 50)); // 逆序
+    EXPECT_EQ(p.GetNumEntries(), 20u);
+    EXPECT_TRUE(p.Find(5, &v));
+    EXPECT_EQ(v, 50u);
+    out.clear();
+    p.CopyRange(0, 20, out);
+    ASSERT_EQ(out.size(), 3u);
+    EXPECT_EQ(out[2].key, 5u);
+}
+
+// 数据层、溢出区与未发布的段内条目：lookup 与游标（含 seek/步长）读到全部，
+// 结果与不开启时 flush 之后一致；未开启时段内条目不可见
+TEST(FreshReads, SeesUnpublishedEntries)
+{
+    for (bool fresh : {false, true})
+    {
+        SBTreeOptions opts;
+        opts.fresh_reads = fresh;
+        opts.disorder_window = 1000;
+        SBTree t(opts);
+        const Key N = 50000;
+        std::vector<KVPair> truth;
+        for (Key k = 0; k < N; k += 2)
+        {
+            t.insert(k, k * 10);
+            truth.push_back({k, k * 10});
+        }
+        t.flush();
+        for (Key k = 1; k < N - 2000; k += 97) // 溢出区
+        {
+            t.insert(k, k * 10);
+            truth.push_back({k, k * 10});
+        }
+        for (Key k = N; k < N + 900; ++k) // 留在活跃段（不足一个 PTB）
+        {
+            t.insert(k, k * 10);
+            truth.push_back({k, k * 10});
+        }
+        t.insert(N + 899, 7); // 段内同 key
+        truth.push_back({N + 899, 7});
+        t.insert(N - 2, 8); // 段内与数据层同 key（水位之上，仍走追加路径）
+        std::stable_sort(truth.begin(), truth.end(), [](const KVPair &a, const KVPair &b)
+                         { return a.key < b.key; });
+
+        Value v = 0;
+        EXPECT_EQ(t.lookup(N + 500, &v), fresh);
+        if (fresh)
+        {
+            EXPECT_EQ(v, (N + 500) * 10);
+        }
+        ASSERT_TRUE(t.lookup(N - 2, &v));
+        EXPECT_EQ(v, (N - 2) * 10); // 同 key 时已发布数据优先
+        EXPECT_FALSE(t.lookup(N + 5000, &v));
+
+        const auto all = collect(t, 0, N + 10000);
+        if (!fresh)
+        {
+            EXPECT_EQ(all.back().key, N - 2);
+            continue;
+        }
+        // N - 2 另有一条在段内，排在已发布的那条之后
+        std::vector<KVPair> expect = truth;
+        expect.insert(std::upper_bound(expect.begin(), expect.end(), KVPair{N - 2, 0},
+                                       [](const KVPair &a, const KVPair &b)
+                                       { return a.key < b.key; }),
+                      KVPair{N - 2, 8});
+        ASSERT_EQ(all.size(), expect.size());
+        for (size_t i = 0; i < all.size(); ++i)
+        {
+            ASSERT_EQ(all[i].key, expect[i].key) << "i=" << i;
+            ASSERT_EQ(all[i].value, expect[i].value) << "i=" << i;
+        }
+
+        // 区间起点落在段内、跨越数据层与段的区间
+        for (Key l : {Key(0), Key(N - 300), Key(N + 100), Key(N + 899)})
+            for (Key r : {Key(N - 1), Key(N + 450), Key(N + 2000)})
+            {
+                if (l > r)
+                    continue;
+                const auto got = collect(t, l, r);
+                std::vector<KVPair> sub;
+                for (const auto &e : expect)
+                    if (e.key >= l && e.key <= r)
+                        sub.push_back(e);
+                ASSERT_EQ(got.size(), sub.size()) << "l=" << l << " r=" << r;
+                for (size_t i = 0; i < got.size(); ++i)
+                    ASSERT_EQ(got[i].key, sub[i].key) << "l=" << l << " r=" << r;
+            }
+
+        auto cur = t.open_range_cursor(N - 10, N + 2000);
+        KVPair kv;
+        ASSERT_TRUE(cur.seek(N + 700));
+        ASSERT_TRUE(cur.next(&kv));
+        EXPECT_EQ(kv.key, N + 700);
+        std::vector<KVPair> strided;
+        EXPECT_EQ(t.scan_stride(N, N + 2000, 100, strided), 9u);
+        EXPECT_EQ(strided.back().key, N + 800);
+
+        // flush 之后读到的内容不变
+        t.flush();
+        const auto after = collect(t, 0, N + 10000);
+        ASSERT_EQ(after.size(), all.size());
+        for (size_t i = 0; i < after.size(); ++i)
+            ASSERT_EQ(after[i].key, all[i].key) << "i=" << i;
+    }
+}
+
+// 写入与段转换并发：读者读到写线程已返回的每一条（read-your-writes），
+// 游标结果严格递增、不重复也不遗漏已确认写入的前缀
+TEST(FreshReads, ConcurrentWithConversion)
+{
+    SBTreeOptions opts;
+    opts.fresh_reads = true;
+    opts.seal_max_entries = 300; // 频繁转换，反复经过发布窗口
+    SBTree t(opts);
+    const Key N = 200000;
+    std::atomic<Key> acked{0}; // [0, acked) 已写入返回
+    std::atomic<bool> stop{false};
+
+    std::thread writer([&]
+                       {
+                           for (Key k = 0; k < N; ++k)
+                           {
+                               t.insert(k, k * 3);
+                               acked.store(k + 1, std::memory_order_release);
+                           }
+                           stop.store(true); });
+
+    std::atomic<size_t> failures{0}, rounds{0};
+    auto reader = [&](int id)
+    {
+        while (!stop.load())
+        {
+            const Key a = acked.load(std::memory_order_acquire);
+            if (a == 0)
+                continue;
+            Value v = 0;
+            if (!t.lookup(a - 1, &v) || v != (a - 1) * 3)
+                ++failures;
+            const Key l = id == 0 ? (a > 3000 ? a - 3000 : 0) : 0;
+            auto cur = t.open_range_cursor(l, N);
+            KVPair kv;
+            Key expect = l;
+            while (cur.next(&kv))
+            {
+                if (kv.key != expect || kv.value != kv.key * 3)
+                {
+                    ++failures;
+                    break;
+                }
+                ++expect;
+            }
+            if (expect < a)
+                ++failures;
+            ++rounds;
+        }
+    };
+    std::thread r0(reader, 0), r1(reader, 1);
+    writer.join();
+    r0.join();
+    r1.join();
+    EXPECT_EQ(failures.load(), 0u);
+    EXPECT_GT(rounds.load(), 0u);
+    t.flush();
+    EXPECT_EQ(t.count(0, N), N);
+}
+
+// 游标打开后段才发布：数据层只读到快照水位之前，发布的条目不会与快照 run 重复
+TEST(FreshReads, PublishDuringIteration)
+{
+    SBTreeOptions opts;
+    opts.fresh_reads = true;
+    SBTree t(opts);
+    const Key N = 20000;
+    for (Key k = 0; k < N; ++k)
+        t.insert(k, k);
+    t.flush();
+    for (Key k = N; k < N + 500; ++k) // 留在活跃段
+        t.insert(k, k);
+
+    auto cur = t.open_range_cursor(0, N + 1000);
+    std::vector<KVPair> got;
+    cur.next_batch(got, N / 2);
+    t.flush();
+    for (Key k = N + 500; k < N + 800; ++k) // 打开之后的写入
+        t.insert(k, k);
+    t.flush();
+    cur.next_batch(got, ~size_t(0));
+    ASSERT_EQ(got.size(), N + 500);
+    for (Key k = 0; k < N + 500; ++k)
+        ASSERT_EQ(got[k].key, k);
+}
+
+// 段内条目落到水位之下（其后另有 run 发布）：游标跳过数据层中这些 key、改由
+// 快照 run 提供；游标中途段才以迟到点并入数据层，结果仍不重复、不遗漏，
+// 同 key 时已发布数据在前
+TEST(FreshReads, SegmentEntriesBelowWatermark)
+{
+    SBTreeOptions opts;
+    opts.fresh_reads = true;
+    SBTree t(opts);
+    for (Key k = 0; k < 20000; k += 2)
+        t.insert(k, k);
+    t.flush();
+    std::vector<KVPair> truth;
+    for (Key k = 0; k < 40000; k += 2)
+        truth.push_back({k, k});
+    for (Key k = 30001; k < 30200; k += 2) // 留在活跃段
+    {
+        t.insert(k, k);
+        truth.push_back({k, k});
+    }
+    t.insert(30000, 7); // 与随后装载的 run 同 key
+    std::vector<KVPair> run;
+    for (Key k = 20000; k < 40000; k += 2)
+        run.push_back({k, k});
+    t.bulk_load(run.data(), run.size()); // 水位越过段内条目
+    std::stable_sort(truth.begin(), truth.end(), [](const KVPair &a, const KVPair &b)
+                     { return a.key < b.key; });
+    truth.insert(std::upper_bound(truth.begin(), truth.end(), KVPair{30000, 0},
+                                  [](const KVPair &a, const KVPair &b)
+                                  { return a.key < b.key; }),
+                 KVPair{30000, 7});
+
+    auto cur = t.open_range_cursor(0, 50000);
+    std::vector<KVPair> got;
+    cur.next_batch(got, 14000);
+    t.flush(); // 段内条目以写时复制并入数据层
+    cur.next_batch(got, ~size_t(0));
+    ASSERT_EQ(got.size(), truth.size());
+    for (size_t i = 0; i < got.size(); ++i)
+    {
+        ASSERT_EQ(got[i].key, truth[i].key) << "i=" << i;
+        ASSERT_EQ(got[i].value, truth[i].value) << "i=" << i;
+    }
+    EXPECT_EQ(collect(t, 0, 50000).size(), truth.size());
+}
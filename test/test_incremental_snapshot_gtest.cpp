@@ -0,0 +1,105 @@
+// test/test_incremental_snapshot_gtest.cpp
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "ChunkedArray.h"
+#include "SearchLayer.h"
+#include "DataBlock.h"
+#include "KVPair.h"
+
+struct Ent
+{
+    Key min_key;
+    size_t tag;
+};
+
+// 分块数组：跨块追加、块内连续视图、写时复制替换不影响旧块内容
+TEST(IncrementalSnapshot, ChunkedArrayAppendAndReplace)
+{
+    using Arr = ChunkedArray<Ent>;
+    Arr a;
+    const size_t N = Arr::kChunk * 3 + 17;
+    for (size_t i = 0; i < N; ++i)
+        a.push_back(Ent{i * 2, i});
+    ASSERT_EQ(a.size(), N);
+    for (size_t i = 0; i < N; ++i)
+        ASSERT_EQ(a[i].tag, i);
+
+    EXPECT_NE(a.contiguous(0, Arr::kChunk), nullptr);
+    EXPECT_EQ(a.contiguous(Arr::kChunk - 1, Arr::kChunk + 1), nullptr);
+    EXPECT_EQ(a.contiguous(Arr::kChunk + 5, Arr::kChunk + 6)->tag, Arr::kChunk + 5);
+
+    const size_t i = Arr::kChunk + 3;
+    Arr::Chunk old = a.replace(i, Ent{i * 2, 999999});
+    EXPECT_EQ(old[3].tag, i);          // 旧块保持原值（留给旧读者）
+    EXPECT_EQ(a[i].tag, 999999u);      // 新块可见
+    EXPECT_EQ(a[i + 1].tag, i + 1);    // 同块其他元素已复制
+    a.push_back(Ent{N * 2, N});        // 替换后继续追加
+    EXPECT_EQ(a.back().tag, N);
+}
+
+static DataBlock *make_block_with_one(Key k)
+{
+    KVPair kv{k, static_cast<Value>(k * 10)};
+    auto *b = new DataBlock();
+    b->build_from_sorted(&kv, 1);
+    return b;
+}
+
+// 读者与索引写者并发：追加跨越多个块与多次晋升，并穿插叶子替换；
+// 读者任何时刻得到的候选都满足 floor 语义（ASan 下可检出旧块被过早释放）
+TEST(IncrementalSnapshot, ConcurrentReadersDuringAppendAndReplace)
+{
+    const size_t F = 8;
+    const size_t N = SearchLayer::KeyArray::kChunk * 4;
+    SearchLayer sl(F);
+    std::vector<DataBlock *> owned, leaves; // leaves[i]：第 i 个叶子当前指向的块
+    owned.reserve(N * 2);
+
+    std::atomic<size_t> published{0};
+    std::atomic<bool> done{false};
+    std::thread reader([&]
+                       {
+                           size_t probe = 0;
+                           while (!done.load(std::memory_order_acquire))
+                           {
+                               const size_t n = published.load(std::memory_order_acquire);
+                               if (n == 0)
+                                   continue;
+                               const Key k = static_cast<Key>((probe++ % n) * 100 + 50);
+                               DataBlock *c = sl.find_candidate(k);
+                               ASSERT_NE(c, nullptr);
+                               ASSERT_LE(c->min_key(), k);
+                           } });
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        DataBlock *b = make_block_with_one(static_cast<Key>(i * 100));
+        owned.push_back(b);
+        leaves.push_back(b);
+        sl.append_run({b});
+        published.store(i + 1, std::memory_order_release);
+        if (i % 7 == 3)
+        {
+            // 用同键新块替换较早的叶子（模拟迟到点写时复制）
+            const size_t j = i / 2;
+            DataBlock *repl = make_block_with_one(static_cast<Key>(j * 100));
+            owned.push_back(repl);
+            ASSERT_TRUE(sl.replace_leaf(leaves[j], repl));
+            if (i % 2)
+                sl.publish(); // 其余的随下一次 append_run 发布
+            leaves[j] = repl;
+        }
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        DataBlock *c = sl.find_candidate(static_cast<Key>(i * 100 + 1));
+        ASSERT_EQ(c, leaves[i]);
+    }
+    for (auto *b : owned)
+        delete b;
+}
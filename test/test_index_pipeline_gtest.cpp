@@ -0,0 +1,122 @@
+// test/test_index_pipeline_gtest.cpp
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "MpscQueue.h"
+#include "SBTree.h"
+
+// 多生产者并发入队：消费者取到全部元素，且每个生产者内部保持 FIFO
+TEST(IndexPipeline, MpscQueuePreservesPerProducerOrder)
+{
+    MpscQueue<std::pair<int, int>> q;
+    const int P = 4, M = 20000;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < P; ++p)
+        producers.emplace_back([&, p]
+                               {
+                                   for (int i = 0; i < M; ++i)
+                                       q.push({p, i});
+                               });
+
+    std::vector<int> next(P, 0);
+    int got = 0;
+    std::pair<int, int> e;
+    while (got < P * M)
+    {
+        if (!q.try_pop(e))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ASSERT_EQ(e.second, next[e.first]) << "producer " << e.first;
+        ++next[e.first];
+        ++got;
+    }
+    for (auto &t : producers)
+        t.join();
+    EXPECT_TRUE(q.empty());
+    EXPECT_FALSE(q.try_pop(e));
+}
+
+// 并发写入 + 迟到点：合并应用后统计与逐批一致，数据完整
+#include <set>
+#include <mutex>
+extern std::atomic<unsigned long> g_app[1<<18], g_colN[1<<20], g_colC[1<<20];
+extern std::mutex g_dbg_mu; extern std::set<unsigned long> g_dbg_late, g_dbg_split, g_dbg_merged;
+TEST(IndexPipeline, CoalescedApplyKeepsStatsAndData)
+{
+    for (auto &x : g_app) x = 0; 
+    g_dbg_late.clear(); g_dbg_split.clear(); g_dbg_merged.clear();
+    SBTree t;
+    const int T = 4;
+    const Key per = 50000;
+    std::vector<std::thread> ws;
+    for (int w = 0; w < T; ++w)
+        ws.emplace_back([&, w]
+                        {
+                            for (Key i = 0; i < per; ++i)
+                                t.insert(i * T + w, (i * T + w) * 10);
+                        });
+    for (auto &th : ws)
+        th.join();
+    t.flush();
+    t.flush_index();
+
+    const Key N = per * T;
+    EXPECT_EQ(t.index_batches_applied(), t.index_batches_enqueued());
+    EXPECT_EQ(t.index_items_applied(), t.index_items_enqueued());
+    EXPECT_GE(t.index_apply_rounds(), 1u);
+    EXPECT_TRUE(t.verify_data_layer(N));
+    {
+        size_t miss = 0;
+        for (Key k = 0; k < N; ++k) { Value v; if (!t.lookup(k, &v)) { if (miss++ < 5) fprintf(stderr, "DBG missing %lu late=%d split=%d merged=%d app=%lu colN=%lu colC=%lu\n", (unsigned long)k, (int)g_dbg_late.count(k), (int)g_dbg_split.count(k), (int)g_dbg_merged.count(k), g_app[k].load(), g_colN[g_app[k].load() & ((1u<<20)-1)].load(), g_colC[g_app[k].load() & ((1u<<20)-1)].load()); } }
+        fprintf(stderr, "DBG overflow %zu miss %zu\n", t.overflow_size(), miss);
+    }
+    for (Key k = 0; k < N; k += 101)
+    {
+        Value v = 0;
+        ASSERT_TRUE(t.lookup(k, &v)) << k;
+        ASSERT_EQ(v, k * 10);
+    }
+}
+
+// 写线程与 flush_index 调用者并发（不启用定时唤醒）：入队的唤醒只会交给后台线程，
+// flush_index 与析构都能返回
+TEST(IndexPipeline, FlushIndexWithConcurrentInserters)
+{
+    for (int round = 0; round < 5; ++round)
+    {
+        SBTreeOptions opts;
+        opts.seal_max_entries = 300; // 频繁转换、频繁入队
+        SBTree t(opts);
+        const int W = 3, F = 3;
+        const Key per = 20000;
+        std::atomic<int> writing{W};
+        std::atomic<size_t> flushes{0};
+        std::vector<std::thread> ws, fs;
+        for (int w = 0; w < W; ++w)
+            ws.emplace_back([&, w]
+                            {
+                                for (Key i = 0; i < per; ++i)
+                                    t.insert(i * W + w, (i * W + w) * 10);
+                                --writing; });
+        for (int f = 0; f < F; ++f)
+            fs.emplace_back([&]
+                            {
+                                while (writing.load() > 0)
+                                {
+                                    t.flush_index();
+                                    ++flushes;
+                                } });
+        for (auto &th : ws)
+            th.join();
+        for (auto &th : fs)
+            th.join();
+        t.flush();
+        t.flush_index();
+        EXPECT_GT(flushes.load(), 0u);
+        EXPECT_EQ(t.index_batches_applied(), t.index_batches_enqueued());
+        EXPECT_TRUE(t.verify_data_layer(per * W));
+    }
+}
@@ -0,0 +1,163 @@
+// test/test_learned_search_layer_gtest.cpp
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+#include "LearnedSearchLayer.h"
+#include "SearchLayer.h"
+#include "DataBlock.h"
+#include "SBTree.h"
+
+static DataBlock *make_block_with_one(Key k)
+{
+    KVPair kv{k, static_cast<Value>(k * 10)};
+    auto *b = new DataBlock();
+    b->build_from_sorted(&kv, 1);
+    return b;
+}
+
+// 近似线性（带抖动）、突变间隔与长串重复键：候选恰为 floor；规则键只需少数几段
+TEST(LearnedSearchLayer, CandidateIsExactFloor)
+{
+    std::mt19937_64 rng(11);
+    for (size_t eps : {0u, 4u, 32u})
+    {
+        LearnedSearchLayer ls(eps);
+        std::vector<DataBlock *> owned;
+        std::vector<Key> mins;
+        std::vector<DataBlock *> run;
+        Key k = 1700000000000ull;
+        for (size_t i = 0; i < 20000; ++i)
+        {
+            if (i % 5000 == 2500)
+                k += 10000000; // 时间断档
+            else if (i % 3000 < 100)
+                k += 0; // 一串重复 min_key
+            else
+                k += 1000 + rng() % 50;
+            owned.push_back(make_block_with_one(k));
+            mins.push_back(k);
+            run.push_back(owned.back());
+            if (run.size() == 23)
+            {
+                ls.append_run(run);
+                run.clear();
+            }
+        }
+        ls.append_run(run);
+        ASSERT_EQ(ls.leaf_size(), mins.size());
+        if (eps >= 4) // eps=0 时抖动使几乎每个叶子自成一段，只检验正确性
+        {
+            EXPECT_LT(ls.segments(), mins.size() / 10) << "eps=" << eps;
+        }
+
+        EXPECT_EQ(ls.find_candidate(mins.front() - 1), nullptr);
+        std::vector<Key> probes(mins.begin(), mins.end());
+        for (size_t i = 0; i < 20000; ++i)
+            probes.push_back(mins.front() + rng() % (mins.back() - mins.front() + 5000));
+        for (Key q : probes)
+        {
+            const size_t pos = std::upper_bound(mins.begin(), mins.end(), q) - mins.begin();
+            ASSERT_EQ(ls.find_candidate(q), owned[pos - 1]) << "eps=" << eps << " q=" << q;
+        }
+        for (auto *b : owned)
+            delete b;
+    }
+}
+
+// 完全等距的键退化为单段
+TEST(LearnedSearchLayer, RegularKeysNeedOneSegment)
+{
+    LearnedSearchLayer ls(8);
+    std::vector<DataBlock *> owned;
+    for (Key k = 0; k < 5000; ++k)
+    {
+        owned.push_back(make_block_with_one(k * 250));
+        ls.append_run({owned.back()});
+    }
+    EXPECT_EQ(ls.segments(), 1u);
+    EXPECT_EQ(ls.levels_snapshot(), 2u);
+    for (Key k = 0; k < 5000; ++k)
+        ASSERT_EQ(ls.find_candidate(k * 250 + 100), owned[k]);
+    for (auto *b : owned)
+        delete b;
+}
+
+// 读者与追加/替换并发（ASan 下可检出快照或旧叶块被过早释放）
+TEST(LearnedSearchLayer, ConcurrentReadersDuringAppendAndReplace)
+{
+    const size_t N = SearchLayer::KeyArray::kChunk * 3;
+    LearnedSearchLayer ls(16);
+    std::vector<DataBlock *> owned, leaves;
+    std::atomic<size_t> published{0};
+    std::atomic<bool> done{false};
+    std::thread reader([&]
+                       {
+                           size_t probe = 0;
+                           while (!done.load(std::memory_order_acquire))
+                           {
+                               const size_t n = published.load(std::memory_order_acquire);
+                               if (n == 0)
+                                   continue;
+                               const Key k = static_cast<Key>((probe++ % n) * 100 + 50);
+                               DataBlock *c = ls.find_candidate(k);
+                               ASSERT_NE(c, nullptr);
+                               ASSERT_LE(c->min_key(), k);
+                           } });
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        DataBlock *b = make_block_with_one(static_cast<Key>(i * 100 + (i % 7) * 10));
+        owned.push_back(b);
+        leaves.push_back(b);
+        ls.append_run({b});
+        published.store(i + 1, std::memory_order_release);
+        if (i % 5 == 2)
+        {
+            const size_t j = i / 2;
+            DataBlock *repl = make_block_with_one(leaves[j]->min_key());
+            owned.push_back(repl);
+            ASSERT_TRUE(ls.replace_leaf(leaves[j], repl));
+            if (i % 2)
+                ls.publish(); // 其余的随下一次 append_run 发布
+            leaves[j] = repl;
+        }
+    }
+    done.store(true, std::memory_order_release);
+    reader.join();
+
+    for (size_t i = 0; i < N; ++i)
+        ASSERT_EQ(ls.find_candidate(leaves[i]->min_key()), leaves[i]);
+    for (auto *b : owned)
+        delete b;
+}
+
+// 在 SBTree 上选用学习型搜索层：点查、扫描与迟到点合并结果不变
+TEST(LearnedSearchLayer, SelectableOnSBTree)
+{
+    SBTreeOptions opts;
+    opts.search_layer = SearchLayerKind::LEARNED;
+    opts.tail_directory_blocks = 0; // 让查询全部经过搜索层
+    SBTree t(opts);
+    const Key N = 200000;
+    for (Key k = 0; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    for (Key k = 1; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    t.flush_index();
+
+    EXPECT_EQ(t.index_levels(), 2u);
+    for (Key k = 0; k < N; k += 13)
+    {
+        Value v = 0;
+        ASSERT_TRUE(t.lookup(k, &v)) << k;
+        ASSERT_EQ(v, k * 10);
+    }
+    std::vector<Value> vals;
+    EXPECT_EQ(t.scan(12345, 23456, vals), 23456u - 12345u + 1);
+    EXPECT_TRUE(t.verify_data_layer(N));
+}
@@ -0,0 +1,150 @@
+// test/test_lookup_batch_gtest.cpp
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "SearchLayer.h"
+#include "LearnedSearchLayer.h"
+#include "DataBlock.h"
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+// 批量定位与逐个 find_candidate 一致：升序（近邻共享）、乱序、重复与越界 key
+template <class Layer>
+static void check_find_candidates(Layer &layer)
+{
+    std::vector<DataBlock *> run;
+    for (Key i = 0; i < 20000; ++i)
+    {
+        KVPair kv{100 + i * 50 + (i % 7), i};
+        auto *b = new DataBlock();
+        b->build_from_sorted(&kv, 1);
+        run.push_back(b);
+    }
+    layer.append_run(run);
+
+    std::mt19937_64 rng(21);
+    std::vector<Key> keys;
+    for (Key k = 0; k < 30000; k += 1 + rng() % 40) // 升序、常落在同一或相邻叶子
+        keys.push_back(k);
+    for (int i = 0; i < 3000; ++i) // 乱序、远跳
+        keys.push_back(rng() % 1100000);
+    keys.push_back(50); // 小于全部叶子
+    keys.push_back(keys[5]);
+    for (Key k = 900000; k > 899000; k -= 3) // 降序
+        keys.push_back(k);
+
+    std::vector<DataBlock *> got(keys.size());
+    layer.find_candidates(keys.data(), keys.size(), got.data());
+    for (size_t i = 0; i < keys.size(); ++i)
+        ASSERT_EQ(got[i], layer.find_candidate(keys[i])) << "i=" << i << " k=" << keys[i];
+
+    for (auto *b : run)
+        delete b;
+}
+
+TEST(LookupBatch, FindCandidatesMatchesSingle)
+{
+    SearchLayer sl(16);
+    check_find_candidates(sl);
+    SearchLayer sl64(64);
+    check_find_candidates(sl64);
+    LearnedSearchLayer ls(8);
+    check_find_candidates(ls);
+    SearchLayer empty(16);
+    Key k = 5;
+    DataBlock *out = reinterpret_cast<DataBlock *>(1);
+    empty.find_candidates(&k, 1, &out);
+    EXPECT_EQ(out, nullptr);
+}
+
+// 整树：与逐个 lookup 一致（含迟到点拆分、溢出区、尾部目录中尚未索引的块与未命中）
+template <class Tree>
+static void check_lookup_batch(SearchLayerKind kind)
+{
+    SBTreeOptions opts;
+    opts.search_layer = kind;
+    opts.disorder_window = 20000;
+    Tree t(opts);
+    const Key N = 400000;
+    for (Key k = 0; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    for (Key k = N - 15001; k < N; k += 2)
+        t.insert(k, k * 10 + 1);
+    for (Key k = 1001; k < 200000; k += 1000)
+        t.insert(k, k * 10 + 2);
+    t.flush();
+    t.flush_index();
+    for (Key k = N; k < N + 30000; ++k) // 仅在链与尾部目录上
+        t.insert(k, k * 10 + 3);
+    t.flush();
+
+    std::mt19937_64 rng(8);
+    for (size_t batch : {size_t(1), size_t(7), size_t(100), size_t(5000)})
+    {
+        std::vector<Key> keys(batch);
+        for (auto &k : keys)
+            k = rng() % (N + 40000);
+        if (batch == 5000)
+            std::sort(keys.begin(), keys.begin() + 2500); // 前半升序
+        std::vector<Value> vals(batch, 7);
+        std::unique_ptr<bool[]> found(new bool[batch]);
+        const size_t hits = t.lookup_batch(keys.data(), batch, vals.data(), found.get());
+        size_t expect_hits = 0;
+        for (size_t i = 0; i < batch; ++i)
+        {
+            Value v = 7;
+            const bool hit = t.lookup(keys[i], &v);
+            ASSERT_EQ(found[i], hit) << "k=" << keys[i];
+            ASSERT_EQ(vals[i], v) << "k=" << keys[i];
+            expect_hits += hit;
+        }
+        EXPECT_EQ(hits, expect_hits);
+        EXPECT_EQ(t.lookup_batch(keys.data(), batch, vals.data(), nullptr), expect_hits);
+    }
+    EXPECT_EQ(t.lookup_batch(nullptr, 0, nullptr, nullptr), 0u);
+}
+
+TEST(LookupBatch, MatchesSingleLookups)
+{
+    check_lookup_batch<SBTree>(SearchLayerKind::BTREE);
+    check_lookup_batch<SBTree>(SearchLayerKind::LEARNED);
+    check_lookup_batch<SingleWriterSBTree>(SearchLayerKind::BTREE);
+}
+
+// 启用新鲜读：活跃段内尚未发布的条目同样可见，结果与逐个 lookup 一致
+TEST(LookupBatch, SeesUnpublishedWithFreshReads)
+{
+    SBTreeOptions opts;
+    opts.fresh_reads = true;
+    SBTree t(opts);
+    const Key N = 20000;
+    for (Key k = 0; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    for (Key k = N; k < N + 500; ++k) // 留在活跃段
+        t.insert(k, k * 10 + 1);
+
+    std::vector<Key> keys;
+    for (Key k = N - 300; k < N + 600; k += 3)
+        keys.push_back(k);
+    std::vector<Value> vals(keys.size(), 7);
+    std::unique_ptr<bool[]> found(new bool[keys.size()]);
+    const size_t hits = t.lookup_batch(keys.data(), keys.size(), vals.data(), found.get());
+    size_t expect_hits = 0;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        const Key k = keys[i];
+        const bool present = k < N ? k % 2 == 0 : k < N + 500;
+        ASSERT_EQ(found[i], present) << "k=" << k;
+        if (present)
+        {
+            ASSERT_EQ(vals[i], k < N ? k * 10 : k * 10 + 1) << "k=" << k;
+        }
+        Value v = 7;
+        ASSERT_EQ(t.lookup(k, &v), present) << "k=" << k;
+        expect_hits += present;
+    }
+    EXPECT_EQ(hits, expect_hits);
+}
@@ -0,0 +1,78 @@
+// test/test_node_search_gtest.cpp
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "Simd.h"
+#include "SearchLayer.h"
+#include "DataBlock.h"
+#include "KVPair.h"
+
+// SIMD 计数与标量一致：含最高位为 1 的键（检验无符号比较）、重复键与任意长度
+TEST(NodeSearch, CountLeMatchesScalar)
+{
+    std::mt19937_64 rng(3);
+    alignas(64) Key keys[64];
+    for (int round = 0; round < 200; ++round)
+    {
+        for (auto &x : keys)
+            x = (round % 2) ? rng() : (rng() % 16) | (Key(rng() % 2) << 63);
+        std::sort(std::begin(keys), std::end(keys));
+        const Key probes[] = {0, 1, keys[0], keys[31], keys[63], keys[63] + 1, Key(1) << 63,
+                              ~Key(0), rng()};
+        for (Key k : probes)
+        {
+            for (size_t n = 0; n <= 64; ++n)
+            {
+                size_t want = 0;
+                for (size_t i = 0; i < n; ++i)
+                    want += keys[i] <= k;
+                ASSERT_EQ(simd_count_le(keys, n, k), want) << "n=" << n << " k=" << k;
+            }
+            const size_t all = std::upper_bound(std::begin(keys), std::end(keys), k) - keys;
+            ASSERT_EQ(simd_count_le_fixed<64>(keys, k), all);
+            ASSERT_EQ(simd_count_le_fixed<8>(keys, k),
+                      size_t(std::upper_bound(keys, keys + 8, k) - keys));
+        }
+    }
+}
+
+// 各扇出（含走通用路径的 128）在满树上的 floor 结果与 upper_bound 一致，含重复 min_key
+TEST(NodeSearch, FindCandidateMatchesFloorForEachFanout)
+{
+    for (size_t F : {8u, 16u, 32u, 64u, 128u})
+    {
+        SearchLayer sl(F);
+        const size_t N = (F <= 16) ? F * F * F : F * F; // 全部晋升，无未覆盖尾部
+        std::vector<DataBlock *> owned;
+        std::vector<Key> mins;
+        std::vector<DataBlock *> run;
+        for (size_t i = 0; i < N; ++i)
+        {
+            const Key k = static_cast<Key>((i / 3) * 10 + 100); // 每 3 个叶子同键
+            KVPair kv{k, k};
+            auto *b = new DataBlock();
+            b->build_from_sorted(&kv, 1);
+            owned.push_back(b);
+            mins.push_back(k);
+            run.push_back(b);
+            if (run.size() == 37 || i + 1 == N)
+            {
+                sl.append_run(run);
+                run.clear();
+            }
+        }
+        ASSERT_EQ(sl.fanout(), F);
+        ASSERT_GE(sl.levels(), 3u);
+
+        EXPECT_EQ(sl.find_candidate(99), nullptr);
+        for (Key k = 95; k <= mins.back() + 20; k += 5)
+        {
+            const size_t pos = std::upper_bound(mins.begin(), mins.end(), k) - mins.begin();
+            DataBlock *want = pos == 0 ? nullptr : owned[pos - 1];
+            ASSERT_EQ(sl.find_candidate(k), want) << "F=" << F << " k=" << k;
+        }
+        for (auto *b : owned)
+            delete b;
+    }
+}
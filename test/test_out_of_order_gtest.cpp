@@ -0,0 +1,247 @@
+// test/test_out_of_order_gtest.cpp
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+#include "EpochManager.h"
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+// 用游标取出 [l, r] 内全部条目
+static std::vector<KVPair> collect(const SBTree &t, Key l, Key r)
+{
+    std::vector<KVPair> out;
+    auto cur = t.open_range_cursor(l, r);
+    KVPair kv;
+    while (cur.next(&kv))
+        out.push_back(kv);
+    return out;
+}
+
+// 窗口内迟到点：flush 后以写时复制并入数据层，点查/扫描可见且整体有序
+TEST(OutOfOrder, LatePointsMergeIntoDataLayer)
+{
+    SBTree t;
+    const Key N = 20000;
+    for (Key k = 1000; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    // 补齐缺口（含低于表头最小 key 的点）
+    for (Key k = 1001; k < N; k += 2)
+        t.insert(k, k * 10);
+    for (Key k = 0; k < 1000; ++k)
+        t.insert(k, k * 10);
+    t.flush();
+    t.flush_index();
+
+    EXPECT_EQ(t.overflow_size(), 0u);
+    for (Key k = 0; k < N; k += 37)
+    {
+        Value v = 0;
+        ASSERT_TRUE(t.lookup(k, &v)) << k;
+        EXPECT_EQ(v, k * 10);
+    }
+    auto all = collect(t, 0, N);
+    ASSERT_EQ(all.size(), N);
+    for (Key k = 0; k < N; ++k)
+        ASSERT_EQ(all[k].key, k);
+    EXPECT_TRUE(t.verify_data_layer(N));
+
+    std::vector<Value> vals;
+    EXPECT_EQ(t.scan(500, 1500, vals), 1001u);
+}
+
+// 超出窗口的迟到点进入溢出区，查询时与数据层归并
+TEST(OutOfOrder, PointsBeyondWindowGoToOverflow)
+{
+    SBTreeOptions opts;
+    opts.disorder_window = 100;
+    SBTree t(opts);
+    const Key N = 10000;
+    for (Key k = 0; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    for (Key k = 1; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    t.flush_index();
+
+    EXPECT_GT(t.overflow_size(), 0u);
+    for (Key k = 1; k < N; k += 2)
+    {
+        Value v = 0;
+        ASSERT_TRUE(t.lookup(k, &v)) << k;
+        EXPECT_EQ(v, k * 10);
+    }
+    auto part = collect(t, 4001, 4100);
+    ASSERT_EQ(part.size(), 100u);
+    for (size_t i = 0; i < part.size(); ++i)
+        EXPECT_EQ(part[i].key, 4001 + i);
+
+    std::vector<Value> vals;
+    EXPECT_EQ(t.scan(0, N - 1, vals), N);
+}
+
+// 多写线程交错写入（各自单调，彼此乱序）：所有点最终可见且扫描有序
+TEST(OutOfOrder, InterleavedWritersScanSorted)
+{
+    SBTree t;
+    const size_t T = 4, per = 30000;
+    std::vector<std::thread> ths;
+    for (size_t w = 0; w < T; ++w)
+        ths.emplace_back([&, w]
+                         {
+                             std::mt19937 rng(w);
+                             for (size_t i = 0; i < per; ++i)
+                             {
+                                 Key k = i * T + w;
+                                 t.insert(k, k * 10);
+                                 if (rng() % 4096 == 0)
+                                     std::this_thread::yield();
+                             } });
+    for (auto &th : ths)
+        th.join();
+    t.flush();
+    t.flush_index();
+
+    auto all = collect(t, 0, T * per);
+    ASSERT_EQ(all.size(), T * per);
+    for (size_t i = 0; i < all.size(); ++i)
+        ASSERT_EQ(all[i].key, i);
+    for (Key k = 0; k < T * per; k += 997)
+    {
+        Value v = 0;
+        ASSERT_TRUE(t.lookup(k, &v)) << k;
+        EXPECT_EQ(v, k * 10);
+    }
+}
+
+// 同一个满块反复并入迟到点：块按容量装满，溢出部分与拆分出的后继块一并重排，
+// 该叶子名下的块数保持为 ceil(条目数 / 容量)，不会每次拆出一个小块
+TEST(OutOfOrder, RepeatedLateMergesKeepBlocksFull)
+{
+    const size_t cap = DataBlock::capacity();
+    SBTree t;
+    std::vector<KVPair> base;
+    for (Key k = 0; k < 10 * cap; ++k)
+        base.push_back({k * 4, k});
+    t.bulk_load(base.data(), base.size());
+    t.flush_index();
+
+    const Key lo = 3 * cap * 4, hi = 4 * cap * 4 - 1; // 第 4 个块的 key 区间
+    const size_t late = cap + 50;
+    for (size_t i = 0; i < late; ++i)
+    {
+        t.insert(lo + (i % cap) * 4 + 1 + i / cap, i); // 奇数 key，与已有 key 不重
+        t.flush();
+    }
+    t.flush_index();
+
+    std::vector<size_t> sizes;
+    t.scan_spans(lo, hi, [&](const SBTree::Span &s)
+                 { sizes.push_back(s.n); });
+    EXPECT_EQ(sizes.size(), (2 * cap + 50 + cap - 1) / cap);
+    EXPECT_LE(std::count_if(sizes.begin(), sizes.end(), [&](size_t n)
+                            { return n < cap; }),
+              1);
+    EXPECT_EQ(t.count(0, ~Key(0)), 10 * cap + late);
+    const auto all = collect(t, 0, ~Key(0));
+    ASSERT_EQ(all.size(), 10 * cap + late);
+    for (size_t i = 1; i < all.size(); ++i)
+        ASSERT_LT(all[i - 1].key, all[i].key);
+    Value v = 0;
+    ASSERT_TRUE(t.lookup(lo + 1 + 1, &v)); // i == cap 那一条
+    EXPECT_EQ(v, cap);
+}
+
+// 被替换的块在游标存续期间保持可读（游标读到打开时的内容），游标关闭后交给
+// EpochManager 回收
+TEST(OutOfOrder, ReplacedBlocksReclaimedAfterReaders)
+{
+    auto &em = EpochManager::instance();
+    SBTree t;
+    const Key N = 20000;
+    for (Key k = 0; k < N; k += 2)
+        t.insert(k, k);
+    t.flush();
+    t.flush_index();
+
+    {
+        auto cur = t.open_range_cursor(0, N);
+        KVPair kv;
+        ASSERT_TRUE(cur.next(&kv));
+        for (Key k = 1; k < N - 2; k += 2) // 全部低于水位：替换全部块
+            t.insert(k, k);
+        t.flush();
+        t.flush_index();
+        EXPECT_GE(em.pending(), N / 2 / DataBlock::capacity()); // 游标仍持有旧块
+
+        Key expect = 2;
+        while (cur.next(&kv))
+        {
+            ASSERT_EQ(kv.key, expect);
+            expect += 2;
+        }
+        EXPECT_EQ(expect, N);
+    }
+    em.synchronize();
+    EXPECT_EQ(em.pending(), 0u);
+    EXPECT_EQ(t.count(0, N), N - 1);
+}
+
+// 水位远超当前写入（全部写入都是迟到点、不再有转换）：侧缓冲达到上限即自行并入，
+// 不必等 flush；侧缓冲始终不超过上限
+template <class Tree>
+static void check_late_drain_by_size()
+{
+    SBTreeOptions opts;
+    opts.late_max_entries = 1000;
+    Tree t(opts);
+    const Key N = 100000;
+    for (Key k = 0; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    t.insert(N * 100, 1); // 水位远在前方
+    t.flush();
+    for (Key k = 1; k < 10000; k += 2) // 5000 个迟到点
+        t.insert(k, k * 10);
+
+    Value v = 0;
+    size_t seen = 0;
+    for (Key k = 1; k < 10000; k += 2)
+        seen += t.lookup(k, &v);
+    EXPECT_GT(seen, 5000u - opts.late_max_entries);
+    ASSERT_TRUE(t.lookup(3999, &v));
+    EXPECT_EQ(v, 39990u);
+    t.flush();
+    for (Key k = 1; k < 10000; k += 2)
+        ASSERT_TRUE(t.lookup(k, &v)) << k;
+    EXPECT_EQ(t.overflow_size(), 0u);
+}
+
+TEST(OutOfOrder, LateBufferDrainsBySize)
+{
+    check_late_drain_by_size<SBTree>();
+    check_late_drain_by_size<SingleWriterSBTree>();
+}
+
+// 启用 seal_max_age 时，侧缓冲中的点同样在该时限量级内可见
+TEST(OutOfOrder, LateBufferDrainsByAge)
+{
+    SBTreeOptions opts;
+    opts.seal_max_age = std::chrono::milliseconds(20);
+    SBTree t(opts);
+    for (Key k = 0; k < 10000; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    t.insert(501, 5010);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    Value v = 0;
+    while (!t.lookup(501, &v) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(t.lookup(501, &v));
+    EXPECT_EQ(v, 5010u);
+}
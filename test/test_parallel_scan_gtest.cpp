@@ -0,0 +1,165 @@
+// test/test_parallel_scan_gtest.cpp
+#include <gtest/gtest.h>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+template <class Tree>
+static std::vector<KVPair> collect_serial(const Tree &t, Key l, Key r)
+{
+    std::vector<KVPair> out;
+    t.open_range_cursor(l, r).next_batch(out, ~size_t(0));
+    return out;
+}
+
+// 分区首尾相接覆盖 [l, r]；各线程数下按分区序号拼接的结果与串行游标一致
+template <class Tree>
+static void check_parallel_scan(SearchLayerKind kind)
+{
+    SBTreeOptions opts;
+    opts.search_layer = kind;
+    opts.disorder_window = 20000;
+    Tree t(opts);
+    const Key N = 600000;
+    for (Key k = 0; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    for (Key k = N - 15001; k < N; k += 2) // 写时复制并入
+        t.insert(k, k * 10);
+    for (Key k = 1001; k < 300000; k += 1000) // 溢出区
+        t.insert(k, k * 10);
+    t.flush();
+    t.flush_index();
+    ASSERT_GT(t.overflow_size(), 0u);
+
+    std::mt19937_64 rng(11);
+    for (int it = 0; it < 12; ++it)
+    {
+        const Key l = it == 0 ? 0 : rng() % N;
+        const Key r = it == 0 ? std::numeric_limits<Key>::max() : l + rng() % 200000;
+        const auto truth = collect_serial(t, l, r);
+
+        const auto parts = t.scan_partitions(l, r, 16);
+        ASSERT_FALSE(parts.empty());
+        ASSERT_LE(parts.size(), 16u);
+        EXPECT_EQ(parts.front().lo, l);
+        EXPECT_EQ(parts.back().hi, r);
+        for (size_t p = 0; p < parts.size(); ++p)
+        {
+            ASSERT_LE(parts[p].lo, parts[p].hi);
+            if (p > 0)
+            {
+                ASSERT_EQ(parts[p].lo, parts[p - 1].hi + 1);
+            }
+        }
+        if (it == 0)
+        {
+            EXPECT_GT(parts.size(), 1u);
+        }
+
+        for (size_t threads : {size_t(1), size_t(3), size_t(8)})
+        {
+            std::mutex mu;
+            std::vector<std::vector<KVPair>> by_part;
+            const size_t n = t.parallel_scan(l, r, [&](size_t p, const SBTree::Span &s)
+                                             {
+                                                 std::lock_guard<std::mutex> g(mu);
+                                                 if (by_part.size() <= p)
+                                                     by_part.resize(p + 1);
+                                                 for (size_t i = 0; i < s.n; ++i)
+                                                     by_part[p].push_back({s.keys[i], s.values[i]});
+                                             },
+                                             threads);
+            ASSERT_EQ(n, truth.size()) << "l=" << l << " threads=" << threads;
+            std::vector<KVPair> merged;
+            for (auto &v : by_part)
+                merged.insert(merged.end(), v.begin(), v.end());
+            ASSERT_EQ(merged.size(), truth.size());
+            for (size_t i = 0; i < truth.size(); ++i)
+            {
+                ASSERT_EQ(merged[i].key, truth[i].key) << "l=" << l << " i=" << i;
+                ASSERT_EQ(merged[i].value, truth[i].value) << "l=" << l << " i=" << i;
+            }
+        }
+
+        Value sum = 0;
+        for (auto &kv : truth)
+            sum += kv.value;
+        const Value got = t.parallel_reduce(
+            l, r, Value(0),
+            [](Value acc, const SBTree::Span &s)
+            {
+                for (size_t i = 0; i < s.n; ++i)
+                    acc += s.values[i];
+                return acc;
+            },
+            [](Value a, Value b)
+            { return a + b; },
+            4);
+        EXPECT_EQ(got, sum) << "l=" << l;
+    }
+}
+
+TEST(ParallelScan, MatchesSerialCursor)
+{
+    check_parallel_scan<SBTree>(SearchLayerKind::BTREE);
+    check_parallel_scan<SBTree>(SearchLayerKind::LEARNED);
+    check_parallel_scan<SingleWriterSBTree>(SearchLayerKind::BTREE);
+}
+
+// 合并顺序按 key：不可交换的 combine（拼接首尾 key）仍得到升序结果
+TEST(ParallelScan, ReduceCombinesInKeyOrder)
+{
+    SBTree t;
+    std::vector<KVPair> data;
+    for (Key k = 0; k < 500000; ++k)
+        data.push_back({k, k});
+    t.bulk_load(data.data(), data.size());
+
+    using Acc = std::vector<Key>;
+    const Acc firsts = t.parallel_reduce(
+        10, 400000, Acc{},
+        [](Acc acc, const SBTree::Span &s)
+        {
+            acc.push_back(s.keys[0]);
+            return acc;
+        },
+        [](Acc a, const Acc &b)
+        {
+            a.insert(a.end(), b.begin(), b.end());
+            return a;
+        },
+        4);
+    ASSERT_FALSE(firsts.empty());
+    EXPECT_EQ(firsts.front(), 10u);
+    for (size_t i = 1; i < firsts.size(); ++i)
+        ASSERT_LT(firsts[i - 1], firsts[i]);
+}
+
+// 空区间与访问函数抛出的异常
+TEST(ParallelScan, EmptyRangeAndExceptions)
+{
+    SBTree t;
+    for (Key k = 0; k < 200000; ++k)
+        t.insert(k, k);
+    t.flush();
+    t.flush_index();
+
+    EXPECT_TRUE(t.scan_partitions(5, 4, 8).empty());
+    EXPECT_EQ(t.parallel_scan(5, 4, [](size_t, const SBTree::Span &) {}, 4), 0u);
+    EXPECT_EQ(t.parallel_reduce(5, 4, 7, [](int a, const SBTree::Span &)
+                                { return a; },
+                                [](int a, int b)
+                                { return a + b; }),
+              7);
+    EXPECT_THROW(t.parallel_scan(0, 199999, [](size_t p, const SBTree::Span &)
+                                 {
+                                     if (p == 2)
+                                         throw std::runtime_error("stop");
+                                 },
+                                 4),
+                 std::runtime_error);
+}
@@ -0,0 +1,146 @@
+// test/test_rank_select_gtest.cpp
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "PrefixCounts.h"
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+// 前缀和/按名次定位与朴素累加一致（含多层、未晋升尾部与增量更新）
+TEST(PrefixCounts, PrefixAndSelectMatchNaive)
+{
+    std::mt19937_64 rng(3);
+    PrefixCounts pc(8);
+    std::vector<uint64_t> cnt;
+    std::vector<PrefixCounts::CountArray::Chunk> garbage;
+
+    auto check = [&](size_t n)
+    {
+        std::vector<uint64_t> pre(n + 1, 0);
+        for (size_t i = 0; i < n; ++i)
+            pre[i + 1] = pre[i] + cnt[i];
+        for (size_t i = 0; i <= n; ++i)
+            ASSERT_EQ(pc.prefix(i), pre[i]) << "n=" << n << " i=" << i;
+        for (uint64_t r = 0; r < pre[n] + 3; r += 1 + rng() % 7)
+        {
+            uint64_t rem = 0;
+            const size_t leaf = pc.select(n, r, &rem);
+            if (r >= pre[n])
+            {
+                ASSERT_EQ(leaf, n - 1);
+                ASSERT_EQ(rem, r - pre[n - 1]);
+                continue;
+            }
+            const size_t expect = std::upper_bound(pre.begin(), pre.end(), r) - pre.begin() - 1;
+            ASSERT_EQ(leaf, expect) << "n=" << n << " r=" << r;
+            ASSERT_EQ(rem, r - pre[expect]);
+        }
+    };
+
+    uint64_t rem = 0;
+    EXPECT_EQ(pc.select(0, 0, &rem), PrefixCounts::npos);
+    for (size_t n = 1; n <= 700; ++n)
+    {
+        cnt.push_back(1 + rng() % 250);
+        pc.push_back(cnt.back());
+        if (n % 7 == 0)
+        {
+            const size_t i = rng() % n;
+            const uint64_t d = 1 + rng() % 40;
+            cnt[i] += d;
+            pc.add(i, d, garbage);
+        }
+        if (n < 80 || n % 61 == 0 || n == 512 || n == 700)
+            check(n);
+    }
+}
+
+// 带乱序合并（块拆分）与溢出区的树：rank/count/select/分页与排序真值一致
+template <class Tree>
+static void check_rank_select(SearchLayerKind kind)
+{
+    SBTreeOptions opts;
+    opts.search_layer = kind;
+    opts.disorder_window = 20000; // 更早的迟到点进入溢出区
+    Tree t(opts);
+    std::vector<Key> truth;
+    const Key N = 600000;
+    for (Key k = 0; k < N; k += 2)
+    {
+        t.insert(k, k * 10);
+        truth.push_back(k);
+    }
+    t.flush();
+    // 窗口内迟到点：写时复制并入，满块拆分出后继块
+    for (Key k = N - 15001; k < N; k += 2)
+    {
+        t.insert(k, k * 10);
+        truth.push_back(k);
+    }
+    t.flush();
+    // 再次并入同一区间：替换目标包括上次拆分出的后继块
+    for (Key k = N - 15001; k < N; k += 4)
+    {
+        t.insert(k, k * 10 + 1);
+        truth.push_back(k);
+    }
+    // 超出窗口：进入溢出区
+    for (Key k = 1001; k < 300000; k += 1000)
+    {
+        t.insert(k, k * 10);
+        truth.push_back(k);
+    }
+    t.flush();
+    t.flush_index();
+    ASSERT_GT(t.overflow_size(), 0u);
+    std::sort(truth.begin(), truth.end());
+
+    auto rank = [&](Key k)
+    { return static_cast<size_t>(std::lower_bound(truth.begin(), truth.end(), k) - truth.begin()); };
+    EXPECT_EQ(t.count(0, std::numeric_limits<Key>::max()), truth.size());
+    EXPECT_EQ(t.count(5, 4), 0u);
+    for (Key k = 0; k < N + 10; k += 997)
+        ASSERT_EQ(t.rank(k), rank(k)) << "k=" << k;
+    for (Key k = N - 16000; k < N; k += 37)
+    {
+        ASSERT_EQ(t.rank(k), rank(k)) << "k=" << k;
+        ASSERT_EQ(t.count(k, k + 500), rank(k + 501) - rank(k)) << "k=" << k;
+    }
+
+    for (size_t i = 0; i < truth.size(); i += 613)
+    {
+        KVPair kv{};
+        ASSERT_TRUE(t.select(i, &kv)) << "i=" << i;
+        ASSERT_EQ(kv.key, truth[i]) << "i=" << i;
+    }
+    KVPair kv{};
+    ASSERT_TRUE(t.select(truth.size() - 1, &kv));
+    EXPECT_EQ(kv.key, truth.back());
+    EXPECT_FALSE(t.select(truth.size(), &kv));
+
+    // 分页：按页取出的结果拼起来等于区间内的完整序列
+    for (Key l : {Key(0), Key(500), Key(N - 16000)})
+    {
+        const Key r = l + 40000;
+        std::vector<KVPair> all;
+        t.open_range_cursor(l, r).next_batch(all, ~size_t(0));
+        const size_t page = 1000;
+        for (size_t off = 0; off < all.size() + page; off += page)
+        {
+            std::vector<KVPair> got;
+            t.open_range_cursor(l, r, off).next_batch(got, page);
+            const size_t expect = off < all.size() ? std::min(page, all.size() - off) : 0;
+            ASSERT_EQ(got.size(), expect) << "l=" << l << " off=" << off;
+            for (size_t j = 0; j < got.size(); ++j)
+                ASSERT_EQ(got[j].key, all[off + j].key) << "l=" << l << " off=" << off;
+        }
+    }
+}
+
+TEST(RankSelect, MatchesSortedTruth)
+{
+    check_rank_select<SBTree>(SearchLayerKind::BTREE);
+    check_rank_select<SBTree>(SearchLayerKind::LEARNED);
+    check_rank_select<SingleWriterSBTree>(SearchLayerKind::BTREE);
+}
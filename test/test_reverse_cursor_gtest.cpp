@@ -0,0 +1,160 @@
+// test/test_reverse_cursor_gtest.cpp
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+// 正向游标结果逆序即真值（同 key 的条目顺序同样相反）
+template <class Tree>
+static std::vector<KVPair> collect_reversed(const Tree &t, Key l, Key r)
+{
+    std::vector<KVPair> out;
+    t.open_range_cursor(l, r).next_batch(out, ~size_t(0));
+    std::reverse(out.begin(), out.end());
+    return out;
+}
+
+static void expect_same(const std::vector<KVPair> &a, const std::vector<KVPair> &b, Key l, Key r)
+{
+    ASSERT_EQ(a.size(), b.size()) << "l=" << l << " r=" << r;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        ASSERT_EQ(a[i].key, b[i].key) << "l=" << l << " r=" << r << " i=" << i;
+        ASSERT_EQ(a[i].value, b[i].value) << "l=" << l << " r=" << r << " i=" << i;
+    }
+}
+
+template <class Tree>
+static void check_reverse(const Tree &t, Key l, Key r)
+{
+    const auto truth = collect_reversed(t, l, r);
+
+    std::vector<KVPair> via_next;
+    auto c1 = t.open_reverse_cursor(l, r);
+    KVPair kv;
+    while (c1.next(&kv))
+        via_next.push_back(kv);
+    expect_same(via_next, truth, l, r);
+
+    std::vector<KVPair> via_span;
+    auto c2 = t.open_reverse_cursor(l, r);
+    SBTree::Span sp;
+    while (c2.next_span(&sp))
+    {
+        ASSERT_GT(sp.n, 0u);
+        for (size_t i = sp.n; i-- > 0;)
+            via_span.push_back({sp.keys[i], sp.values[i]});
+    }
+    expect_same(via_span, truth, l, r);
+
+    std::vector<KVPair> via_batch;
+    auto c3 = t.open_reverse_cursor(l, r);
+    while (c3.next_batch(via_batch, 97) > 0)
+    {
+    }
+    expect_same(via_batch, truth, l, r);
+}
+
+// 写时复制拆分出的后继块、溢出区交错（含与数据层同 key）：与正向游标逆序一致
+template <class Tree>
+static void check_matches_forward(SearchLayerKind kind)
+{
+    SBTreeOptions opts;
+    opts.search_layer = kind;
+    opts.disorder_window = 20000;
+    Tree t(opts);
+    const Key N = 400000;
+    for (Key k = 0; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    for (Key k = N - 15001; k < N; k += 2) // 写时复制并入，满块拆分
+        t.insert(k, k * 10);
+    for (Key k = 1001; k < 300000; k += 1000) // 溢出区
+        t.insert(k, k * 10);
+    for (Key k = 5000; k < 300000; k += 3000) // 溢出区中与数据层同 key
+        t.insert(k, k * 10 + 1);
+    t.flush();
+    t.flush_index();
+    ASSERT_GT(t.overflow_size(), 0u);
+
+    std::mt19937_64 rng(21);
+    check_reverse(t, 0, std::numeric_limits<Key>::max());
+    check_reverse(t, 99000, 100000);
+    check_reverse(t, 100000, 100000);
+    check_reverse(t, 100000, 101000);
+    check_reverse(t, N + 10, N + 100);
+    for (int it = 0; it < 60; ++it)
+    {
+        const Key l = rng() % (N + 1000);
+        const Key r = l + rng() % (it % 3 == 0 ? 200 : 30000);
+        check_reverse(t, l, r);
+    }
+    EXPECT_FALSE(t.open_reverse_cursor(5, 4).next(nullptr));
+}
+
+TEST(ReverseCursor, MatchesReversedForwardCursor)
+{
+    check_matches_forward<SBTree>(SearchLayerKind::BTREE);
+    check_matches_forward<SBTree>(SearchLayerKind::LEARNED);
+    check_matches_forward<SingleWriterSBTree>(SearchLayerKind::BTREE);
+}
+
+// 尾部目录禁用/命中、索引尚未追上时，逆序遍历仍覆盖整条链
+TEST(ReverseCursor, WorksWithTailDirectoryAndLaggingIndex)
+{
+    for (size_t tail : {size_t(0), size_t(64)})
+    {
+        SBTreeOptions opts;
+        opts.tail_directory_blocks = tail;
+        SBTree t(opts);
+        const Key N = 300000;
+        for (Key k = 0; k < N; ++k)
+            t.insert(k, k * 10);
+        t.flush(); // 不等待索引：新块可能仍只在链上（及尾部目录中）
+        for (Key r : {N - 1, N - 3000, N / 2, Key(10)})
+        {
+            std::vector<KVPair> got;
+            auto cur = t.open_reverse_cursor(0, r);
+            while (cur.next_batch(got, 1000) > 0)
+            {
+            }
+            ASSERT_EQ(got.size(), r + 1) << "tail=" << tail << " r=" << r;
+            for (size_t i = 0; i < got.size(); ++i)
+                ASSERT_EQ(got[i].key, r - i) << "tail=" << tail << " r=" << r;
+        }
+    }
+}
+
+// latest_n：不超过 r 的最新 n 条，按升序追加
+TEST(ReverseCursor, LatestN)
+{
+    SBTree t;
+    std::vector<KVPair> data;
+    for (Key k = 10; k < 200000; k += 2)
+        data.push_back({k, k * 10});
+    t.bulk_load(data.data(), data.size());
+
+    std::vector<KVPair> out{{1, 1}}; // 追加，不覆盖已有内容
+    EXPECT_EQ(t.latest_n(150001, 100, out), 100u);
+    ASSERT_EQ(out.size(), 101u);
+    for (size_t i = 1; i <= 100; ++i)
+    {
+        EXPECT_EQ(out[i].key, 150000 - 2 * (100 - i));
+        EXPECT_EQ(out[i].value, out[i].key * 10);
+    }
+
+    out.clear();
+    EXPECT_EQ(t.latest_n(std::numeric_limits<Key>::max(), 3, out), 3u);
+    EXPECT_EQ(out.front().key, 199994u);
+    EXPECT_EQ(out.back().key, 199998u);
+
+    out.clear();
+    EXPECT_EQ(t.latest_n(15, 100, out), 3u); // 10, 12, 14
+    EXPECT_EQ(out.front().key, 10u);
+    out.clear();
+    EXPECT_EQ(t.latest_n(9, 100, out), 0u);
+    EXPECT_EQ(t.latest_n(150000, 0, out), 0u);
+    EXPECT_TRUE(out.empty());
+}
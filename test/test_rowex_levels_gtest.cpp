@@ -23,7 +23,11 @@ TEST(RowexLevels, NonBlockingDuringConcurrentInsert)
             if (lv < prev) ok_monotonic.store(false, std::memory_order_relaxed);
             prev = lv;
             last_lv.store(lv, std::memory_order_relaxed);
-        } });
+        }
+        // 写线程已 flush_index，再补读一次，避免读线程被饿死时留下陈旧读数
+        size_t lv = t.index_levels();
+        if (lv < prev) ok_monotonic.store(false, std::memory_order_relaxed);
+        last_lv.store(lv, std::memory_order_relaxed); });
 
     // 写线程：持续插入，制造多个 run / 可能的层级晋升
     std::thread writer([&]
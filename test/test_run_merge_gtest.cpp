@@ -0,0 +1,90 @@
+// test/test_run_merge_gtest.cpp
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "RunMerge.h"
+#include "KVPair.h"
+
+// 败者树：多路（含空 run、重复 key、非 2 的幂路数）归并结果有序且不丢不重
+TEST(RunMerge, LoserTreeMergesSortedRuns)
+{
+    std::mt19937_64 rng(42);
+    for (size_t k : {1u, 2u, 3u, 7u, 64u, 100u})
+    {
+        std::vector<std::vector<KVPair>> runs(k);
+        size_t total = 0;
+        for (size_t r = 0; r < k; ++r)
+        {
+            size_t n = (r % 5 == 4) ? 0 : rng() % 300;
+            for (size_t i = 0; i < n; ++i)
+                runs[r].push_back({rng() % 1000, r});
+            std::sort(runs[r].begin(), runs[r].end(),
+                      [](const KVPair &a, const KVPair &b)
+                      { return a.key < b.key; });
+            total += n;
+        }
+        std::vector<KVRun> views;
+        for (auto &r : runs)
+            views.push_back({r.data(), r.size()});
+
+        LoserTree lt(views);
+        std::vector<KVPair> got;
+        while (!lt.empty())
+        {
+            got.push_back(lt.top());
+            lt.pop();
+        }
+        ASSERT_EQ(got.size(), total) << "k=" << k;
+        for (size_t i = 1; i < got.size(); ++i)
+        {
+            ASSERT_LE(got[i - 1].key, got[i].key);
+            // key 相同时按 run 下标稳定输出
+            if (got[i - 1].key == got[i].key)
+            {
+                ASSERT_LE(got[i - 1].value, got[i].value);
+            }
+        }
+    }
+}
+
+// LSD 基数排序：与 std::stable_sort 结果一致（含高位全同、全部相同等跳趟情形）
+TEST(RunMerge, RadixSortMatchesStableSort)
+{
+    std::mt19937_64 rng(7);
+    auto check = [](std::vector<KVPair> in)
+    {
+        std::vector<KVPair> out(in.size()), tmp(in.size());
+        radix_sort_by_key(in.data(), in.size(), out.data(), tmp.data());
+        std::stable_sort(in.begin(), in.end(),
+                         [](const KVPair &a, const KVPair &b)
+                         { return a.key < b.key; });
+        for (size_t i = 0; i < in.size(); ++i)
+        {
+            ASSERT_EQ(out[i].key, in[i].key);
+            ASSERT_EQ(out[i].value, in[i].value);
+        }
+    };
+
+    std::vector<KVPair> v;
+    for (size_t i = 0; i < 5000; ++i)
+        v.push_back({rng(), i});
+    check(v); // 全 64 位随机
+
+    v.clear();
+    for (size_t i = 0; i < 5000; ++i)
+        v.push_back({1700000000000ull + rng() % 100000, i});
+    check(v); // 高位全同（时间戳形态）
+
+    v.clear();
+    for (size_t i = 0; i < 1023; ++i)
+        v.push_back({1023 - i, i});
+    check(v); // 逆序
+
+    v.assign(100, KVPair{5, 0});
+    for (size_t i = 0; i < v.size(); ++i)
+        v[i].value = i;
+    check(v); // 全部相同：所有趟次跳过
+
+    check({}); // 空输入
+}
@@ -0,0 +1,72 @@
+// test/test_seal_policy_gtest.cpp
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "SBTree.h"
+
+// 条目数阈值：段内累计到阈值即转换，无需 flush 即可被查询看到
+TEST(SealPolicy, EntryThresholdSealsEarly)
+{
+    SBTreeOptions opts;
+    opts.seal_max_entries = 100;
+    SBTree t(opts);
+    for (Key k = 0; k < 1000; ++k)
+        t.insert(k, k * 10);
+    t.flush_index();
+
+    for (Key k = 0; k < 1000; ++k)
+    {
+        Value v = 0;
+        ASSERT_TRUE(t.lookup(k, &v)) << k;
+        EXPECT_EQ(v, k * 10);
+    }
+}
+
+// 字节阈值：多个线程各占一个 PTB，段内 PTB 总字节达到阈值即封印
+TEST(SealPolicy, ByteThresholdBoundsSegmentFootprint)
+{
+    SBTreeOptions opts;
+    opts.seal_max_bytes = 2 * sizeof(PerThreadDataBlock);
+    SBTree t(opts);
+    const size_t T = 4, per = 50;
+    std::vector<std::thread> ths;
+    for (size_t w = 0; w < T; ++w)
+        ths.emplace_back([&, w]
+                         {
+                             for (size_t i = 0; i < per; ++i)
+                             {
+                                 Key k = 1000000 * (w + 1) + i;
+                                 t.insert(k, k);
+                             } });
+    for (auto &th : ths)
+        th.join();
+    t.flush();
+    t.flush_index();
+
+    std::vector<Value> out;
+    EXPECT_EQ(t.scan(0, 10000000, out), T * per);
+}
+
+// 时间阈值：低写入速率下，数据在 seal_max_age 量级的时间内变得可见
+TEST(SealPolicy, AgeThresholdBoundsVisibilityDelay)
+{
+    SBTreeOptions opts;
+    opts.seal_max_age = std::chrono::milliseconds(20);
+    SBTree t(opts);
+    for (Key k = 0; k < 10; ++k)
+        t.insert(k, k * 10);
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    Value v = 0;
+    while (!t.lookup(9, &v) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_TRUE(t.lookup(9, &v));
+    EXPECT_EQ(v, 90u);
+
+    // 之后的写入同样在时限内可见
+    t.insert(10, 100);
+    while (!t.lookup(10, &v) && std::chrono::steady_clock::now() < deadline)
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_TRUE(t.lookup(10, &v));
+}
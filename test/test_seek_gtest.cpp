@@ -0,0 +1,198 @@
+// test/test_seek_gtest.cpp
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+// 逐元素 next() 的结果作为真值
+template <class Tree>
+static std::vector<KVPair> collect_next(const Tree &t, Key l, Key r)
+{
+    std::vector<KVPair> out;
+    auto cur = t.open_range_cursor(l, r);
+    KVPair kv;
+    while (cur.next(&kv))
+        out.push_back(kv);
+    return out;
+}
+
+// 第一个 key >= k 的真值下标（不早于 from）
+static size_t lower_from(const std::vector<KVPair> &v, size_t from, Key k)
+{
+    return std::lower_bound(v.begin() + from, v.end(), k,
+                            [](const KVPair &a, Key x)
+                            { return a.key < x; }) -
+           v.begin();
+}
+
+// 带写时复制并入、溢出区（含同 key）与未建索引尾部的树：任意递增 seek 序列
+// 与 next 交替，结果都与真值一致；k 不超过当前位置时不动
+template <class Tree>
+static void check_seek(SearchLayerKind kind)
+{
+    SBTreeOptions opts;
+    opts.search_layer = kind;
+    opts.disorder_window = 20000;
+    Tree t(opts);
+    const Key N = 400000;
+    for (Key k = 0; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    for (Key k = N - 15001; k < N; k += 2) // 写时复制并入，满块拆分
+        t.insert(k, k * 10);
+    for (Key k = 1001; k < 300000; k += 997) // 溢出区：与数据层交错
+        t.insert(k, k * 10);
+    for (Key k = 2000; k < 300000; k += 1999) // 溢出区中与数据层同 key
+        t.insert(k, k * 10 + 1);
+    t.flush();
+    t.flush_index();
+    for (Key k = N; k < N + 30000; k += 3) // 只在尾部（索引滞后）
+        t.insert(k, k * 10);
+    t.flush();
+    ASSERT_GT(t.overflow_size(), 0u);
+
+    std::mt19937_64 rng(61);
+    for (int it = 0; it < 30; ++it)
+    {
+        const Key l = rng() % (N + 20000), r = l + rng() % 200000;
+        const auto truth = collect_next(t, l, r);
+        auto cur = t.open_range_cursor(l, r);
+        size_t pos = 0;
+        Key k = l;
+        while (true)
+        {
+            // 跨度从块内到远跨多个叶子不等；偶尔回退（不应移动）
+            const int mode = rng() % 4;
+            const Key gap = mode == 0 ? rng() % 50 : mode == 1 ? rng() % 5000 : mode == 2 ? rng() % 60000 : 0;
+            k = mode == 3 ? (k > 100 ? k - 100 : 0) : k + gap;
+            const bool more = cur.seek(k);
+            if (truth.empty() || (pos < truth.size() && truth[pos].key >= k))
+                ; // 不动
+            else
+                pos = lower_from(truth, pos, k);
+            ASSERT_EQ(more, pos < truth.size()) << "l=" << l << " k=" << k;
+            if (!more)
+                break;
+            const size_t steps = rng() % 3;
+            for (size_t s = 0; s < steps && pos < truth.size(); ++s, ++pos)
+            {
+                KVPair kv;
+                ASSERT_TRUE(cur.next(&kv));
+                ASSERT_EQ(kv.key, truth[pos].key) << "l=" << l << " k=" << k;
+                ASSERT_EQ(kv.value, truth[pos].value) << "l=" << l << " k=" << k;
+            }
+        }
+        KVPair kv;
+        EXPECT_FALSE(cur.next(&kv));
+        EXPECT_FALSE(cur.seek(r + 1));
+    }
+}
+
+TEST(Seek, MatchesElementCursor)
+{
+    check_seek<SBTree>(SearchLayerKind::BTREE);
+    check_seek<SBTree>(SearchLayerKind::LEARNED);
+    check_seek<SingleWriterSBTree>(SearchLayerKind::BTREE);
+}
+
+// 用 seek 做两路归并连接（交集），与逐元素归并一致
+TEST(Seek, MergeJoin)
+{
+    SBTree a, b;
+    const Key N = 300000;
+    for (Key k = 0; k < N; k += 3)
+        a.insert(k, k);
+    for (Key k = 0; k < N; k += 1000) // 稀疏一侧
+        b.insert(k + (k / 1000) % 7, k);
+    a.flush();
+    b.flush();
+    a.flush_index();
+    b.flush_index();
+
+    std::vector<Key> expect;
+    for (Key k = 0; k < N; k += 1000)
+        if ((k + (k / 1000) % 7) % 3 == 0 && k + (k / 1000) % 7 < N)
+            expect.push_back(k + (k / 1000) % 7);
+    ASSERT_FALSE(expect.empty());
+
+    std::vector<Key> got;
+    auto ca = a.open_range_cursor(0, N);
+    auto cb = b.open_range_cursor(0, N);
+    KVPair x, y;
+    bool ha = ca.next(&x), hb = cb.next(&y);
+    while (ha && hb)
+    {
+        if (x.key == y.key)
+        {
+            got.push_back(x.key);
+            ha = ca.next(&x);
+            hb = cb.next(&y);
+        }
+        else if (x.key < y.key)
+            ha = ca.seek(y.key) && ca.next(&x);
+        else
+            hb = cb.seek(x.key) && cb.next(&y);
+    }
+    EXPECT_EQ(got, expect);
+}
+
+// 步长采样：每个非空窗口 [l + i*w, l + (i+1)*w) 的首个条目，空窗口跳过
+TEST(Seek, StrideMatchesNaive)
+{
+    SBTreeOptions opts;
+    opts.disorder_window = 1000;
+    SBTree t(opts);
+    std::mt19937_64 rng(67);
+    const Key N = 300000;
+    for (Key k = 0; k < N; k += 1 + rng() % 40) // 不等间隔，含大片空窗口
+    {
+        t.insert(k, k * 10);
+        if (rng() % 2000 == 0)
+            k += 20000;
+    }
+    t.flush();
+    for (Key k = 5; k < N - 5000; k += 4999) // 溢出区
+        t.insert(k, k * 10 + 1);
+    t.flush();
+    t.flush_index();
+    ASSERT_GT(t.overflow_size(), 0u);
+
+    for (int it = 0; it < 40; ++it)
+    {
+        const Key l = rng() % N, r = l + rng() % 100000;
+        const Key w = 1 + rng() % (it % 2 ? 50 : 5000);
+        const auto all = collect_next(t, l, r);
+        std::vector<KVPair> expect;
+        Key last_win = std::numeric_limits<Key>::max();
+        for (const auto &kv : all)
+            if ((kv.key - l) / w != last_win)
+            {
+                last_win = (kv.key - l) / w;
+                expect.push_back(kv);
+            }
+
+        std::vector<KVPair> got;
+        EXPECT_EQ(t.scan_stride(l, r, w, got), expect.size());
+        ASSERT_EQ(got.size(), expect.size()) << "l=" << l << " w=" << w;
+        for (size_t i = 0; i < got.size(); ++i)
+        {
+            ASSERT_EQ(got[i].key, expect[i].key) << "l=" << l << " w=" << w << " i=" << i;
+            ASSERT_EQ(got[i].value, expect[i].value) << "l=" << l << " w=" << w << " i=" << i;
+        }
+    }
+
+    // 区间贴近 Key 上界时末窗口不溢出
+    SBTree u;
+    const Key top = std::numeric_limits<Key>::max();
+    for (Key k = top - 100; k < top; ++k)
+        u.insert(k, 1);
+    u.insert(top, 2);
+    u.flush();
+    std::vector<KVPair> got;
+    EXPECT_EQ(u.scan_stride(top - 100, top, 30, got), 4u);
+    EXPECT_EQ(got.back().key, top - 10);
+    got.clear();
+    EXPECT_EQ(u.scan_stride(0, 5, 0, got), 0u);
+}
@@ -0,0 +1,88 @@
+// test/test_single_writer_gtest.cpp
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "SingleWriterSBTree.h"
+
+// 单写版本：顺序写入后数据层完整有序，点查/扫描与多写版本一致
+TEST(SingleWriter, SequentialInsertMatchesMultiWriter)
+{
+    const size_t N = 50000;
+    SingleWriterSBTree t;
+    for (size_t i = 0; i < N; ++i)
+        t.insert(i, i * 10);
+    t.flush();
+    t.flush_index();
+
+    EXPECT_TRUE(t.verify_data_layer(N));
+    for (Key k = 0; k < N; k += 101)
+    {
+        Value v = 0;
+        ASSERT_TRUE(t.lookup(k, &v)) << k;
+        EXPECT_EQ(v, k * 10);
+    }
+    std::vector<Value> out;
+    EXPECT_EQ(t.scan(1000, 1999, out), 1000u);
+}
+
+// 迟到点与乱序窗口：与多写版本共用同一套处理
+TEST(SingleWriter, LatePointsAreMerged)
+{
+    SingleWriterSBTree t;
+    for (Key k = 0; k < 10000; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    for (Key k = 1; k < 10000; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    t.flush_index();
+    EXPECT_TRUE(t.verify_data_layer(10000));
+}
+
+// 写线程持续写入时，读线程只看到已发布的 run，且结果始终有序、无缺口
+TEST(SingleWriter, ConcurrentReadersSeePublishedPrefix)
+{
+    SingleWriterSBTree t;
+    const Key N = 200000;
+    std::atomic<bool> done{false};
+    std::thread reader([&]
+                       {
+                           while (!done.load())
+                           {
+                               std::vector<KVPair> got;
+                               auto cur = t.open_range_cursor(0, N);
+                               KVPair kv;
+                               while (cur.next(&kv))
+                                   got.push_back(kv);
+                               for (size_t i = 0; i < got.size(); ++i)
+                                   ASSERT_EQ(got[i].key, i);
+                           } });
+    for (Key k = 0; k < N; ++k)
+        t.insert(k, k * 10);
+    t.flush();
+    done.store(true);
+    reader.join();
+    t.flush_index();
+    EXPECT_TRUE(t.verify_data_layer(N));
+}
+
+// 时间阈值：写线程在下一次 insert 时响应索引线程的定时请求
+TEST(SingleWriter, AgeThresholdSealsOnNextInsert)
+{
+    SBTreeOptions opts;
+    opts.seal_max_age = std::chrono::milliseconds(10);
+    SingleWriterSBTree t(opts);
+    t.insert(0, 0);
+    Value v = 0;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    Key k = 1;
+    while (!t.lookup(0, &v) && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        t.insert(k, k * 10);
+        ++k;
+    }
+    EXPECT_TRUE(t.lookup(0, &v));
+}
@@ -0,0 +1,120 @@
+// test/test_span_scan_gtest.cpp
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+#include "SBTree.h"
+
+// 逐元素 next() 的结果作为真值
+static std::vector<KVPair> collect_next(const SBTree &t, Key l, Key r)
+{
+    std::vector<KVPair> out;
+    auto cur = t.open_range_cursor(l, r);
+    KVPair kv;
+    while (cur.next(&kv))
+        out.push_back(kv);
+    return out;
+}
+
+static void expect_same(const std::vector<KVPair> &a, const std::vector<KVPair> &b, Key l)
+{
+    ASSERT_EQ(a.size(), b.size()) << "l=" << l;
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        ASSERT_EQ(a[i].key, b[i].key) << "l=" << l << " i=" << i;
+        ASSERT_EQ(a[i].value, b[i].value) << "l=" << l << " i=" << i;
+    }
+}
+
+// 段、缓冲批量复制与 KVPair 批量接口都与逐元素游标一致（含溢出区交错与同 key）
+TEST(SpanScan, MatchesElementCursor)
+{
+    SBTreeOptions opts;
+    opts.disorder_window = 1000;
+    SBTree t(opts);
+    const Key N = 200000;
+    for (Key k = 0; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    for (Key k = 1; k < N - 5000; k += 50) // 溢出区：与数据层交错
+        t.insert(k, k * 10);
+    for (Key k = 100; k < N - 5000; k += 300) // 溢出区中与数据层同 key
+        t.insert(k, k * 10 + 1);
+    t.flush();
+    t.flush_index();
+    ASSERT_GT(t.overflow_size(), 0u);
+
+    std::mt19937_64 rng(4);
+    for (int it = 0; it < 40; ++it)
+    {
+        const Key l = rng() % N, r = l + rng() % 30000;
+        const auto truth = collect_next(t, l, r);
+
+        std::vector<KVPair> via_span;
+        auto cur = t.open_range_cursor(l, r);
+        SBTree::Span sp;
+        while (cur.next_span(&sp))
+        {
+            ASSERT_GT(sp.n, 0u);
+            for (size_t i = 0; i < sp.n; ++i)
+                via_span.push_back({sp.keys[i], sp.values[i]});
+        }
+        expect_same(via_span, truth, l);
+
+        std::vector<KVPair> via_visitor;
+        const size_t n = t.scan_spans(l, r, [&](const SBTree::Span &s)
+                                      {
+                                          for (size_t i = 0; i < s.n; ++i)
+                                              via_visitor.push_back({s.keys[i], s.values[i]});
+                                      });
+        EXPECT_EQ(n, truth.size());
+        expect_same(via_visitor, truth, l);
+
+        std::vector<KVPair> via_buf;
+        Key kb[7];
+        Value vb[7];
+        auto c2 = t.open_range_cursor(l, r);
+        size_t got;
+        while ((got = c2.next_batch(kb, vb, 7)) > 0)
+            for (size_t i = 0; i < got; ++i)
+                via_buf.push_back({kb[i], vb[i]});
+        expect_same(via_buf, truth, l);
+
+        std::vector<KVPair> via_vec;
+        auto c3 = t.open_range_cursor(l, r);
+        while (c3.next_batch(via_vec, 333) > 0)
+        {
+        }
+        expect_same(via_vec, truth, l);
+
+        std::vector<Value> vals;
+        EXPECT_EQ(t.scan(l, r, vals), truth.size());
+        for (size_t i = 0; i < vals.size(); ++i)
+            ASSERT_EQ(vals[i], truth[i].value);
+    }
+}
+
+// 无溢出区时每段即一个块内的连续区间（零拷贝指向块内数组），两端按区间裁剪
+TEST(SpanScan, OneSpanPerBlockWithoutOverflow)
+{
+    SBTree t;
+    const Key N = 100000;
+    std::vector<KVPair> data;
+    for (Key k = 0; k < N; ++k)
+        data.push_back({k, k * 10});
+    t.bulk_load(data.data(), data.size()); // 块均为满块，段数可精确预期
+
+    const Key l = 1234, r = 77777;
+    size_t spans = 0, total = 0;
+    Key expect = l;
+    t.scan_spans(l, r, [&](const SBTree::Span &s)
+                 {
+                     ++spans;
+                     for (size_t i = 0; i < s.n; ++i)
+                         ASSERT_EQ(s.keys[i], expect++);
+                     total += s.n;
+                 });
+    EXPECT_EQ(total, r - l + 1);
+    const size_t cap = DataBlock::capacity();
+    EXPECT_EQ(spans, r / cap - l / cap + 1);
+    EXPECT_EQ(t.scan_spans(5, 4, [](const SBTree::Span &) {}), 0u);
+}
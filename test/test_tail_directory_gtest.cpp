@@ -0,0 +1,112 @@
+// test/test_tail_directory_gtest.cpp
+#include <gtest/gtest.h>
+#include <vector>
+#include "TailDirectory.h"
+#include "DataBlock.h"
+#include "SBTree.h"
+#include "SingleWriterSBTree.h"
+
+static DataBlock *make_block_with_one(Key k)
+{
+    KVPair kv{k, static_cast<Value>(k * 10)};
+    auto *b = new DataBlock();
+    b->build_from_sorted(&kv, 1);
+    return b;
+}
+
+// 目录只保留最新 K 块；首块之前的 key 返回 nullptr；替换后指向新块
+TEST(TailDirectory, KeepsNewestBlocksAndFollowsReplacement)
+{
+    TailDirectory dir(4);
+    std::vector<DataBlock *> owned;
+    EXPECT_EQ(dir.find(100), nullptr); // 尚未发布
+
+    std::vector<DataBlock *> run;
+    for (Key k = 100; k <= 600; k += 100)
+    {
+        owned.push_back(make_block_with_one(k));
+        run.push_back(owned.back());
+    }
+    for (size_t i = 1; i < run.size(); ++i)
+        run[i - 1]->set_next(run[i]);
+    dir.on_append(run);
+    dir.publish();
+
+    // 保留 300..600
+    EXPECT_EQ(dir.find(250), nullptr);
+    EXPECT_EQ(dir.find(300), owned[2]);
+    EXPECT_EQ(dir.find(450), owned[3]);
+    EXPECT_EQ(dir.find(99999), owned[5]);
+
+    // 400 被拆成两块 400/450 取代
+    DataBlock *a = make_block_with_one(400), *b = make_block_with_one(450);
+    owned.push_back(a);
+    owned.push_back(b);
+    a->set_next(b);
+    b->set_next(owned[4]);
+    dir.on_replace(owned[3], a, b);
+    dir.publish();
+    EXPECT_EQ(dir.find(420), a);
+    EXPECT_EQ(dir.find(460), b);
+    EXPECT_EQ(dir.find(300), nullptr); // 目录仍只保留 4 块：400,450,500,600
+
+    TailDirectory off(0);
+    off.on_append(run);
+    off.publish();
+    EXPECT_EQ(off.find(600), nullptr);
+
+    for (auto *p : owned)
+        delete p;
+}
+
+// 不等待索引：最近转换的块经目录即可查到（含写时复制并入的迟到点）
+template <class Tree>
+static void check_recent_reads(size_t tail_blocks)
+{
+    SBTreeOptions opts;
+    opts.tail_directory_blocks = tail_blocks;
+    Tree t(opts);
+    const Key N = 100000;
+    for (Key k = 0; k < N; k += 2)
+        t.insert(k, k * 10);
+    t.flush();
+    for (Key k = N - 2001; k < N; k += 2) // 最近区间内的迟到点
+        t.insert(k, k * 10);
+    t.flush();
+    if (tail_blocks == 0)
+        t.flush_index(); // 无目录时最近数据要等索引线程追加/替换后才能经搜索层定位
+
+    for (Key k = N - 4000; k < N; ++k)
+    {
+        const bool present = (k % 2 == 0) || k >= N - 2001;
+        Value v = 0;
+        ASSERT_EQ(t.lookup(k, &v), present) << "k=" << k;
+        if (present)
+        {
+            ASSERT_EQ(v, k * 10);
+        }
+    }
+    auto cur = t.open_range_cursor(N - 2001, N);
+    KVPair kv;
+    Key expect = N - 2001;
+    while (cur.next(&kv))
+    {
+        ASSERT_EQ(kv.key, expect);
+        ++expect;
+    }
+    EXPECT_EQ(expect, N);
+
+    t.flush_index();
+    for (Key k = 0; k < N - 2001; k += 97)
+    {
+        Value v = 0;
+        ASSERT_EQ(t.lookup(k, &v), k % 2 == 0) << "k=" << k;
+    }
+}
+
+TEST(TailDirectory, RecentReadsWithoutWaitingForIndex)
+{
+    check_recent_reads<SBTree>(64);
+    check_recent_reads<SBTree>(0);
+    check_recent_reads<SingleWriterSBTree>(64);
+}
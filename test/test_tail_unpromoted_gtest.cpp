@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <vector>
 #include "SearchLayer.h"
 #include "DataBlock.h"
@@ -72,3 +73,32 @@ TEST(SearchLayerTailUnpromoted, CandidateWorks)
     for (auto *p : owned)
         delete p; // 清理
 }
+
+// 任意叶子数（各层都可能带未晋升尾部）：候选恰为 floor，与 upper_bound 一致
+TEST(SearchLayerTailUnpromoted, CandidateIsExactFloorAtEverySize)
+{
+    for (std::size_t F : {4u, 8u}) // 4 走通用内核，8 走定长内核
+    {
+        SearchLayer sl(F);
+        std::vector<DataBlock *> owned;
+        std::vector<Key> mins;
+
+        for (std::size_t n = 1; n <= 300; ++n)
+        {
+            owned.push_back(make_block_with_one(static_cast<Key>(n * 10)));
+            mins.push_back(static_cast<Key>(n * 10));
+            sl.append_run({owned.back()});
+
+            for (Key k = 5; k <= mins.back() + 10; k += 5)
+            {
+                const std::size_t pos = std::upper_bound(mins.begin(), mins.end(), k) - mins.begin();
+                DataBlock *want = pos == 0 ? nullptr : owned[pos - 1];
+                ASSERT_EQ(sl.find_candidate(k), want) << "F=" << F << " n=" << n << " k=" << k;
+            }
+        }
+        ASSERT_GE(sl.levels(), 3u);
+
+        for (auto *p : owned)
+            delete p;
+    }
+}